@@ -0,0 +1,185 @@
+/* Deterministic bulk key generation.
+ * The entropy of key number i is a leaf of a two-level SHAKE256 tree over
+ * the master seed: a node per key type, then a leaf per index, so any key
+ * can be regenerated on its own and the slabs come out the same whatever
+ * the number of threads of c/parallel that fill them. */
+
+#include "keygen.h"
+#include "../dilithium/sign.h"
+#include "../fips202/fips202.h"
+#include "../kyber/kyber_sets.h"
+#include "../parallel/parallel.h"
+#include "../randombytes/rng.h"
+#include "../round5/api.h"
+
+#define PQGO_KEYGEN_GRAIN 4 /* keys per task */
+#define PQGO_KEYGEN_MAXENTROPY 48
+
+typedef struct {
+    int alg, rng_backend;
+    int failed; /* set by any range whose keypair generation failed */
+    keccak_state node; /* SHAKE256 with the key type node absorbed */
+    unsigned char *pks, *sks;
+    unsigned long long first;
+} pqgo_keygen_job;
+
+static const unsigned char pqgo_keygen_cstm[] = "PQGo bulk keygen";
+
+static size_t pqgo_keygen_entlen (int alg) {
+    return alg == PQGO_KEYGEN_DILITHIUM ? SEEDBYTES : PQGO_KEYGEN_MAXENTROPY;
+}
+
+/* node = cSHAKE256 (alg || seed, S = "PQGo bulk keygen"), absorbed into a
+ * SHAKE256 midstate to which each leaf appends its index */
+static void pqgo_keygen_node (keccak_state *state, int alg, const unsigned char seed[PQGO_KEYGEN_SEEDBYTES]) {
+    unsigned char node[32], a = alg;
+    keccak_state t;
+
+    cshake256_inc_init (&t, NULL, 0, pqgo_keygen_cstm, sizeof pqgo_keygen_cstm - 1);
+    shake256_inc_absorb (&t, &a, 1);
+    shake256_inc_absorb (&t, seed, PQGO_KEYGEN_SEEDBYTES);
+    cshake256_inc_finalize (&t);
+    shake256_inc_squeeze (node, sizeof node, &t);
+
+    shake256_inc_init (state);
+    shake256_inc_absorb (state, node, sizeof node);
+}
+
+/* leaf = SHAKE256 (node || index as 8 bytes little-endian) */
+static void pqgo_keygen_leaf (unsigned char *ent, size_t entlen, const keccak_state *node, unsigned long long index) {
+    unsigned char ib[8];
+    keccak_state state;
+    int i;
+
+    for (i = 0; i < 8; i++) ib[i] = index >> 8 * i;
+    keccak_inc_clone (&state, node);
+    shake256_inc_absorb (&state, ib, 8);
+    shake256_inc_finalize (&state);
+    shake256_inc_squeeze (ent, entlen, &state);
+}
+
+/*************************************************
+ * Name:        pqgo_keygen_entropy
+ *
+ * Description: Entropy from which pqgo_keygen_bulk generates key number
+ *              index; KeyGen on it gives the same keypair.
+ *
+ * Arguments:   - unsigned char *ent:       pointer to output
+ *              - size_t entlen:            bytes of entropy of the key type
+ *              - int alg:                  PQGO_KEYGEN_* key type
+ *              - const unsigned char *seed: master seed
+ *              - unsigned long long index: key number
+ **************************************************/
+void pqgo_keygen_entropy (unsigned char *ent,
+                          size_t entlen,
+                          int alg,
+                          const unsigned char seed[PQGO_KEYGEN_SEEDBYTES],
+                          unsigned long long index) {
+    keccak_state node;
+
+    pqgo_keygen_node (&node, alg, seed);
+    pqgo_keygen_leaf (ent, entlen, &node, index);
+}
+
+/* volatile stores so that the wipe of a buffer going out of scope stays */
+static void pqgo_keygen_wipe (unsigned char *x, size_t n) {
+    volatile unsigned char *p = x;
+    size_t i;
+
+    for (i = 0; i < n; i++) p[i] = 0;
+}
+
+static void pqgo_keygen_range (void *arg, size_t begin, size_t end) {
+    pqgo_keygen_job *job = arg;
+    unsigned char ent[PQGO_KEYGEN_MAXENTROPY];
+    rng_ctx rng;
+    size_t i;
+    int ret;
+
+    for (i = begin; i < end; i++) {
+        pqgo_keygen_leaf (ent, pqgo_keygen_entlen (job->alg), &job->node, job->first + i);
+
+        switch (job->alg) {
+        case PQGO_KEYGEN_DILITHIUM:
+            ret = dilithium_sign_keypair (job->pks + i * DILITHIUM_PUBLICKEYBYTES,
+                                          job->sks + i * DILITHIUM_SECRETKEYBYTES, ent);
+            break;
+        case PQGO_KEYGEN_KYBER512:
+            ret = rng_init (&rng, job->rng_backend, ent, NULL);
+            if (ret == 0)
+                ret = kyber512_kem_keypair_rng (job->pks + i * KYBER512_PUBLICKEYBYTES,
+                                                job->sks + i * KYBER512_SECRETKEYBYTES, &rng);
+            break;
+        case PQGO_KEYGEN_KYBER:
+            ret = rng_init (&rng, job->rng_backend, ent, NULL);
+            if (ret == 0)
+                ret = kyber768_kem_keypair_rng (job->pks + i * KYBER768_PUBLICKEYBYTES,
+                                                job->sks + i * KYBER768_SECRETKEYBYTES, &rng);
+            break;
+        case PQGO_KEYGEN_KYBER1024:
+            ret = rng_init (&rng, job->rng_backend, ent, NULL);
+            if (ret == 0)
+                ret = kyber1024_kem_keypair_rng (job->pks + i * KYBER1024_PUBLICKEYBYTES,
+                                                 job->sks + i * KYBER1024_SECRETKEYBYTES, &rng);
+            break;
+        case PQGO_KEYGEN_ROUND5:
+            ret = rng_init (&rng, job->rng_backend, ent, NULL);
+            if (ret == 0)
+                ret = round5_kem_keypair_rng ((char *)job->pks + i * ROUND5_PUBLICKEYBYTES,
+                                              (char *)job->sks + i * ROUND5_SECRETKEYBYTES, &rng);
+            break;
+        default:
+            ret = -1;
+        }
+        rng_wipe (&rng);
+
+        /* ranges run concurrently; any failure fails the whole call */
+        if (ret != 0) {
+            __atomic_store_n (&job->failed, 1, __ATOMIC_RELAXED);
+            break;
+        }
+    }
+    pqgo_keygen_wipe (ent, sizeof ent);
+}
+
+/*************************************************
+ * Name:        pqgo_keygen_bulk
+ *
+ * Description: Generates keypairs first, ..., first + count - 1 of the
+ *              tree of seed on the thread pool, packed back to back.
+ *
+ * Arguments:   - int alg:                  PQGO_KEYGEN_* key type
+ *              - int rng_backend:          RNG_* expanding the entropy of
+ *                                          KEM keys; ignored for Dilithium
+ *              - unsigned char *pks:       output slab of count public keys
+ *              - unsigned char *sks:       output slab of count secret keys
+ *              - const unsigned char *seed: master seed
+ *              - unsigned long long first: number of the first key
+ *              - size_t count:             number of keys
+ *
+ * Returns 0 on success, -1 for an unknown key type or RNG backend or if
+ * generating any of the keypairs failed
+ **************************************************/
+int pqgo_keygen_bulk (int alg,
+                      int rng_backend,
+                      unsigned char *pks,
+                      unsigned char *sks,
+                      const unsigned char seed[PQGO_KEYGEN_SEEDBYTES],
+                      unsigned long long first,
+                      size_t count) {
+    pqgo_keygen_job job;
+
+    if (alg < PQGO_KEYGEN_DILITHIUM || alg > PQGO_KEYGEN_KYBER1024) return -1;
+    if (rng_backend != RNG_SHAKE256 && rng_backend != RNG_AES256_CTR_DRBG) return -1;
+
+    job.alg = alg;
+    job.rng_backend = rng_backend;
+    job.pks = pks;
+    job.sks = sks;
+    job.first = first;
+    job.failed = 0;
+    pqgo_keygen_node (&job.node, alg, seed);
+
+    pqgo_parallel_for (count, PQGO_KEYGEN_GRAIN, pqgo_keygen_range, &job);
+    return job.failed ? -1 : 0;
+}
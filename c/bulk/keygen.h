@@ -0,0 +1,29 @@
+#ifndef BULK_KEYGEN_H
+#define BULK_KEYGEN_H
+
+#include <stddef.h>
+
+/* Key types of pqgo_keygen_bulk */
+#define PQGO_KEYGEN_DILITHIUM 0
+#define PQGO_KEYGEN_KYBER 1
+#define PQGO_KEYGEN_ROUND5 2
+#define PQGO_KEYGEN_KYBER512 3
+#define PQGO_KEYGEN_KYBER1024 4
+
+#define PQGO_KEYGEN_SEEDBYTES 32
+
+void pqgo_keygen_entropy (unsigned char *ent,
+                          size_t entlen,
+                          int alg,
+                          const unsigned char seed[PQGO_KEYGEN_SEEDBYTES],
+                          unsigned long long index);
+
+int pqgo_keygen_bulk (int alg,
+                      int rng_backend,
+                      unsigned char *pks,
+                      unsigned char *sks,
+                      const unsigned char seed[PQGO_KEYGEN_SEEDBYTES],
+                      unsigned long long first,
+                      size_t count);
+
+#endif
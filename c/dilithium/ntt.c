@@ -76,7 +76,7 @@ static const uint32_t zetas_inv[N] = {
 };
 
 /*************************************************
- * Name:        ntt
+ * Name:        ntt_ref
  *
  * Description: Forward NTT, in-place. No modular reduction is performed after
  *              additions or subtractions. Hence output coefficients can be up
@@ -85,7 +85,7 @@ static const uint32_t zetas_inv[N] = {
  *
  * Arguments:   - uint32_t p[N]: input/output coefficient array
  **************************************************/
-void ntt (uint32_t p[N]) {
+void ntt_ref (uint32_t p[N]) {
     unsigned int len, start, j, k;
     uint32_t zeta, t;
 
@@ -103,7 +103,7 @@ void ntt (uint32_t p[N]) {
 }
 
 /*************************************************
- * Name:        invntt_frominvmont
+ * Name:        invntt_frominvmont_ref
  *
  * Description: Inverse NTT and multiplication by Montgomery factor 2^32.
  *              In-place. No modular reductions after additions or
@@ -112,7 +112,7 @@ void ntt (uint32_t p[N]) {
  *
  * Arguments:   - uint32_t p[N]: input/output coefficient array
  **************************************************/
-void invntt_frominvmont (uint32_t p[N]) {
+void invntt_frominvmont_ref (uint32_t p[N]) {
     unsigned int start, len, j, k;
     uint32_t t, zeta;
     const uint32_t f = (((uint64_t)MONT * MONT % Q) * (Q - 1) % Q) * ((Q - 1) >> 8) % Q;
@@ -134,3 +134,128 @@ void invntt_frominvmont (uint32_t p[N]) {
         p[j] = montgomery_reduce ((uint64_t)f * p[j]);
     }
 }
+
+#if defined(__x86_64__)
+
+#include <immintrin.h>
+
+/*************************************************
+ * Name:        ntt_montmul_avx2
+ *
+ * Description: Eight-way montgomery_reduce ((uint64_t)zeta * b), computed
+ *              on the even and odd 32-bit lanes separately with full
+ *              64-bit products, so results match the scalar code exactly.
+ *
+ * Arguments:   - __m256i z: zeta broadcast to all eight lanes
+ *              - __m256i b: eight coefficients
+ *
+ * Returns the eight reduced products.
+ **************************************************/
+static inline __attribute__ ((target ("avx2"), always_inline)) __m256i
+ntt_montmul_avx2 (__m256i z, __m256i b) {
+    const __m256i qinv = _mm256_set1_epi32 ((int)QINV);
+    const __m256i q = _mm256_set1_epi32 (Q);
+    __m256i lo, hi, t;
+
+    lo = _mm256_mul_epu32 (z, b);
+    hi = _mm256_mul_epu32 (z, _mm256_srli_epi64 (b, 32));
+
+    t = _mm256_mul_epu32 (_mm256_mul_epu32 (lo, qinv), q);
+    lo = _mm256_srli_epi64 (_mm256_add_epi64 (lo, t), 32);
+    t = _mm256_mul_epu32 (_mm256_mul_epu32 (hi, qinv), q);
+    hi = _mm256_add_epi64 (hi, t);
+
+    return _mm256_blend_epi32 (lo, hi, 0xAA);
+}
+
+/*************************************************
+ * Name:        ntt_avx2
+ *
+ * Description: Same as ntt_ref; levels with len >= 8 are done eight
+ *              coefficients at a time, the last three levels are scalar.
+ *
+ * Arguments:   - uint32_t p[N]: input/output coefficient array
+ **************************************************/
+__attribute__ ((target ("avx2"))) void ntt_avx2 (uint32_t p[N]) {
+    unsigned int len, start, j, k;
+    uint32_t zeta, t;
+    const __m256i q2 = _mm256_set1_epi32 (2 * Q);
+    __m256i z, a, b;
+
+    k = 1;
+    for (len = 128; len >= 8; len >>= 1) {
+        for (start = 0; start < N; start = j + len) {
+            z = _mm256_set1_epi32 (zetas[k++]);
+            for (j = start; j < start + len; j += 8) {
+                a = _mm256_loadu_si256 ((const __m256i *)&p[j]);
+                b = _mm256_loadu_si256 ((const __m256i *)&p[j + len]);
+                b = ntt_montmul_avx2 (z, b);
+                _mm256_storeu_si256 ((__m256i *)&p[j + len],
+                                     _mm256_sub_epi32 (_mm256_add_epi32 (a, q2), b));
+                _mm256_storeu_si256 ((__m256i *)&p[j], _mm256_add_epi32 (a, b));
+            }
+        }
+    }
+
+    for (; len > 0; len >>= 1) {
+        for (start = 0; start < N; start = j + len) {
+            zeta = zetas[k++];
+            for (j = start; j < start + len; ++j) {
+                t = montgomery_reduce ((uint64_t)zeta * p[j + len]);
+                p[j + len] = p[j] + 2 * Q - t;
+                p[j] = p[j] + t;
+            }
+        }
+    }
+}
+
+/*************************************************
+ * Name:        invntt_frominvmont_avx2
+ *
+ * Description: Same as invntt_frominvmont_ref; the first three levels are
+ *              scalar, the remaining ones and the final scaling are done
+ *              eight coefficients at a time.
+ *
+ * Arguments:   - uint32_t p[N]: input/output coefficient array
+ **************************************************/
+__attribute__ ((target ("avx2"))) void invntt_frominvmont_avx2 (uint32_t p[N]) {
+    unsigned int start, len, j, k;
+    uint32_t t, zeta;
+    const uint32_t f = (((uint64_t)MONT * MONT % Q) * (Q - 1) % Q) * ((Q - 1) >> 8) % Q;
+    const __m256i q256 = _mm256_set1_epi32 (256 * Q);
+    __m256i z, a, b;
+
+    k = 0;
+    for (len = 1; len < 8; len <<= 1) {
+        for (start = 0; start < N; start = j + len) {
+            zeta = zetas_inv[k++];
+            for (j = start; j < start + len; ++j) {
+                t = p[j];
+                p[j] = t + p[j + len];
+                p[j + len] = t + 256 * Q - p[j + len];
+                p[j + len] = montgomery_reduce ((uint64_t)zeta * p[j + len]);
+            }
+        }
+    }
+
+    for (; len < N; len <<= 1) {
+        for (start = 0; start < N; start = j + len) {
+            z = _mm256_set1_epi32 (zetas_inv[k++]);
+            for (j = start; j < start + len; j += 8) {
+                a = _mm256_loadu_si256 ((const __m256i *)&p[j]);
+                b = _mm256_loadu_si256 ((const __m256i *)&p[j + len]);
+                _mm256_storeu_si256 ((__m256i *)&p[j], _mm256_add_epi32 (a, b));
+                b = _mm256_sub_epi32 (_mm256_add_epi32 (a, q256), b);
+                _mm256_storeu_si256 ((__m256i *)&p[j + len], ntt_montmul_avx2 (z, b));
+            }
+        }
+    }
+
+    z = _mm256_set1_epi32 (f);
+    for (j = 0; j < N; j += 8) {
+        a = _mm256_loadu_si256 ((const __m256i *)&p[j]);
+        _mm256_storeu_si256 ((__m256i *)&p[j], ntt_montmul_avx2 (z, a));
+    }
+}
+
+#endif /* __x86_64__ */
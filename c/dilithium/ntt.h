@@ -7,4 +7,11 @@
 void ntt (uint32_t p[N]);
 void invntt_frominvmont (uint32_t p[N]);
 
+void ntt_ref (uint32_t p[N]);
+void invntt_frominvmont_ref (uint32_t p[N]);
+#if defined(__x86_64__)
+void ntt_avx2 (uint32_t p[N]);
+void invntt_frominvmont_avx2 (uint32_t p[N]);
+#endif
+
 #endif
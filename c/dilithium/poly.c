@@ -1,5 +1,6 @@
 #include "poly.h"
 #include "../fips202/fips202.h"
+#include "../fips202/keccakf1600.h"
 #include "ntt.h"
 #include "params.h"
 #include "reduce.h"
@@ -265,25 +266,38 @@ int poly_chknorm (const poly *a, uint32_t B) {
 /*************************************************
  * Name:        poly_uniform
  *
- * Description: Sample uniformly random polynomial using stream of random bytes.
- *              Assumes that enough random bytes are given (e.g.
- *              5*SHAKE128_RATE bytes).
+ * Description: Sample uniformly random polynomial by rejection sampling on
+ *              the SHAKE-128 output stream of a padded, not yet permuted
+ *              state. Candidates are read straight from the rate lanes,
+ *              eight per three lanes, and the state is permuted again only
+ *              while coefficients are missing.
  *
  * Arguments:   - poly *a: pointer to output polynomial
- *              - const unsigned char *buf: array of random bytes
+ *              - uint64_t *s: Keccak state, overwritten
  **************************************************/
-void poly_uniform (poly *a, const unsigned char *buf) {
-    unsigned int ctr, pos;
+void poly_uniform (poly *a, uint64_t *s) {
+    unsigned int ctr, i, j;
     uint32_t t;
+    uint64_t v[8];
 
-    ctr = pos = 0;
+    ctr = 0;
     while (ctr < N) {
-        t = buf[pos++];
-        t |= (uint32_t)buf[pos++] << 8;
-        t |= (uint32_t)buf[pos++] << 16;
-        t &= 0x7FFFFF;
-
-        if (t < Q) a->coeffs[ctr++] = t;
+        KeccakF1600_StatePermute (s);
+        for (i = 0; i < SHAKE128_RATE / 8 && ctr < N; i += 3) {
+            v[0] = s[i];
+            v[1] = s[i] >> 24;
+            v[2] = s[i] >> 48 | s[i + 1] << 16;
+            v[3] = s[i + 1] >> 8;
+            v[4] = s[i + 1] >> 32;
+            v[5] = s[i + 1] >> 56 | s[i + 2] << 8;
+            v[6] = s[i + 2] >> 16;
+            v[7] = s[i + 2] >> 40;
+
+            for (j = 0; j < 8 && ctr < N; ++j) {
+                t = v[j] & 0x7FFFFF;
+                if (t < Q) a->coeffs[ctr++] = t;
+            }
+        }
     }
 }
 
@@ -291,32 +305,30 @@ void poly_uniform (poly *a, const unsigned char *buf) {
  * Name:        rej_eta
  *
  * Description: Sample uniformly random coefficients in [-ETA, ETA] by
- *              performing rejection sampling using array of random bytes.
+ *              performing rejection sampling on the bytes of one lane.
  *
  * Arguments:   - uint32_t *a: pointer to output array (allocated)
  *              - unsigned int len: number of coefficients to be sampled
- *              - const unsigned char *buf: array of random bytes
- *              - unsigned int buflen: length of array of random bytes
+ *              - uint64_t w: lane of random bytes
  *
  * Returns number of sampled coefficients. Can be smaller than len if not enough
  * random bytes were given.
  **************************************************/
-static unsigned int
-rej_eta (uint32_t *a, unsigned int len, const unsigned char *buf, unsigned int buflen) {
+static unsigned int rej_eta (uint32_t *a, unsigned int len, uint64_t w) {
 #if ETA > 7
 #error "rej_eta() assumes ETA <= 7"
 #endif
     unsigned int ctr, pos;
     unsigned char t0, t1;
 
-    ctr = pos = 0;
-    while (ctr < len && pos < buflen) {
+    ctr = 0;
+    for (pos = 0; pos < 8 && ctr < len; ++pos, w >>= 8) {
 #if ETA <= 3
-        t0 = buf[pos] & 0x07;
-        t1 = buf[pos++] >> 5;
+        t0 = w & 0x07;
+        t1 = (w & 0xFF) >> 5;
 #else
-        t0 = buf[pos] & 0x0F;
-        t1 = buf[pos++] >> 4;
+        t0 = w & 0x0F;
+        t1 = (w & 0xFF) >> 4;
 #endif
 
         if (t0 <= 2 * ETA) a[ctr++] = Q + ETA - t0;
@@ -331,7 +343,8 @@ rej_eta (uint32_t *a, unsigned int len, const unsigned char *buf, unsigned int b
  *
  * Description: Sample polynomial with uniformly random coefficients
  *              in [-ETA,ETA] by performing rejection sampling using the
- *              output stream from SHAKE256(seed|nonce).
+ *              output stream from SHAKE256(seed|nonce), read lane by lane
+ *              from the state.
  *
  * Arguments:   - poly *a: pointer to output polynomial
  *              - const unsigned char seed[]: byte array with seed of length
@@ -341,65 +354,19 @@ rej_eta (uint32_t *a, unsigned int len, const unsigned char *buf, unsigned int b
 void poly_uniform_eta (poly *a, const unsigned char seed[SEEDBYTES], unsigned char nonce) {
     unsigned int i, ctr;
     unsigned char inbuf[SEEDBYTES + 1];
-    /* Probability that we need more than 2 blocks: < 2^{-84}
-       Probability that we need more than 3 blocks: < 2^{-352} */
-    unsigned char outbuf[2 * SHAKE256_RATE];
     uint64_t state[25];
 
     for (i = 0; i < SEEDBYTES; ++i) inbuf[i] = seed[i];
     inbuf[SEEDBYTES] = nonce;
 
     shake256_absorb (state, inbuf, SEEDBYTES + 1);
-    shake256_squeezeblocks (outbuf, 2, state);
 
-    ctr = rej_eta (a->coeffs, N, outbuf, 2 * SHAKE256_RATE);
-    if (ctr < N) {
-        shake256_squeezeblocks (outbuf, 1, state);
-        rej_eta (a->coeffs + ctr, N - ctr, outbuf, SHAKE256_RATE);
-    }
-}
-
-/*************************************************
- * Name:        rej_gamma1m1
- *
- * Description: Sample uniformly random coefficients
- *              in [-(GAMMA1 - 1), GAMMA1 - 1] by performing rejection sampling
- *              using array of random bytes.
- *
- * Arguments:   - uint32_t *a: pointer to output array (allocated)
- *              - unsigned int len: number of coefficients to be sampled
- *              - const unsigned char *buf: array of random bytes
- *              - unsigned int buflen: length of array of random bytes
- *
- * Returns number of sampled coefficients. Can be smaller than len if not enough
- * random bytes were given.
- **************************************************/
-static unsigned int
-rej_gamma1m1 (uint32_t *a, unsigned int len, const unsigned char *buf, unsigned int buflen) {
-#if GAMMA1 > (1 << 19)
-#error "rej_gamma1m1() assumes GAMMA1 - 1 fits in 19 bits"
-#endif
-    unsigned int ctr, pos;
-    uint32_t t0, t1;
-
-    ctr = pos = 0;
-    while (ctr < len && pos + 5 <= buflen) {
-        t0 = buf[pos];
-        t0 |= (uint32_t)buf[pos + 1] << 8;
-        t0 |= (uint32_t)buf[pos + 2] << 16;
-        t0 &= 0xFFFFF;
-
-        t1 = buf[pos + 2] >> 4;
-        t1 |= (uint32_t)buf[pos + 3] << 4;
-        t1 |= (uint32_t)buf[pos + 4] << 12;
-
-        pos += 5;
-
-        if (t0 <= 2 * GAMMA1 - 2) a[ctr++] = Q + GAMMA1 - 1 - t0;
-        if (t1 <= 2 * GAMMA1 - 2 && ctr < len) a[ctr++] = Q + GAMMA1 - 1 - t1;
+    ctr = 0;
+    while (ctr < N) {
+        KeccakF1600_StatePermute (state);
+        for (i = 0; i < SHAKE256_RATE / 8 && ctr < N; ++i)
+            ctr += rej_eta (a->coeffs + ctr, N - ctr, state[i]);
     }
-
-    return ctr;
 }
 
 /*************************************************
@@ -408,6 +375,9 @@ rej_gamma1m1 (uint32_t *a, unsigned int len, const unsigned char *buf, unsigned
  * Description: Sample polynomial with uniformly random coefficients
  *              in [-(GAMMA1 - 1), GAMMA1 - 1] by performing rejection
  *              sampling on output stream of SHAKE256(seed|nonce).
+ *              Candidates are 20-bit fields of the stream read lane by
+ *              lane; the bits of a field split between two lanes, also
+ *              across a block boundary, are carried in acc.
  *
  * Arguments:   - poly *a: pointer to output polynomial
  *              - const unsigned char seed[]: byte array with seed of length
@@ -415,26 +385,39 @@ rej_gamma1m1 (uint32_t *a, unsigned int len, const unsigned char *buf, unsigned
  *              - uint16_t nonce: 16-bit nonce
  **************************************************/
 void poly_uniform_gamma1m1 (poly *a, const unsigned char seed[SEEDBYTES + CRHBYTES], uint16_t nonce) {
-    unsigned int i, ctr;
+#if GAMMA1 > (1 << 19)
+#error "poly_uniform_gamma1m1() assumes GAMMA1 - 1 fits in 19 bits"
+#endif
+    unsigned int i, ctr, bits, left;
     unsigned char inbuf[SEEDBYTES + CRHBYTES + 2];
-    /* Probability that we need more than 5 blocks: < 2^{-81}
-       Probability that we need more than 6 blocks: < 2^{-467} */
-    unsigned char outbuf[5 * SHAKE256_RATE];
-    uint64_t state[25];
+    uint64_t state[25], w, acc;
+    uint32_t t;
 
     for (i = 0; i < SEEDBYTES + CRHBYTES; ++i) inbuf[i] = seed[i];
     inbuf[SEEDBYTES + CRHBYTES] = nonce & 0xFF;
     inbuf[SEEDBYTES + CRHBYTES + 1] = nonce >> 8;
 
     shake256_absorb (state, inbuf, SEEDBYTES + CRHBYTES + 2);
-    shake256_squeezeblocks (outbuf, 5, state);
-
-    ctr = rej_gamma1m1 (a->coeffs, N, outbuf, 5 * SHAKE256_RATE);
-    if (ctr < N) {
-        /* There are no bytes left in outbuf
-           since 5*SHAKE256_RATE is divisible by 5 */
-        shake256_squeezeblocks (outbuf, 1, state);
-        rej_gamma1m1 (a->coeffs + ctr, N - ctr, outbuf, SHAKE256_RATE);
+
+    ctr = bits = 0;
+    acc = 0;
+    while (ctr < N) {
+        KeccakF1600_StatePermute (state);
+        for (i = 0; i < SHAKE256_RATE / 8 && ctr < N; ++i) {
+            /* complete the field started in the previous lane */
+            w = state[i];
+            t = (acc | w << bits) & 0xFFFFF;
+            w >>= 20 - bits;
+            left = 44 + bits;
+            if (t <= 2 * GAMMA1 - 2) a->coeffs[ctr++] = Q + GAMMA1 - 1 - t;
+
+            for (; left >= 20 && ctr < N; left -= 20, w >>= 20) {
+                t = w & 0xFFFFF;
+                if (t <= 2 * GAMMA1 - 2) a->coeffs[ctr++] = Q + GAMMA1 - 1 - t;
+            }
+            acc = w;
+            bits = left;
+        }
     }
 }
 
@@ -28,7 +28,7 @@ unsigned int poly_make_hint (poly *h, const poly *a, const poly *b);
 void poly_use_hint (poly *a, const poly *b, const poly *h);
 
 int poly_chknorm (const poly *a, uint32_t B);
-void poly_uniform (poly *a, const unsigned char *buf);
+void poly_uniform (poly *a, uint64_t *s);
 void poly_uniform_eta (poly *a, const unsigned char seed[SEEDBYTES], unsigned char nonce);
 void poly_uniform_gamma1m1 (poly *a, const unsigned char seed[SEEDBYTES + CRHBYTES], uint16_t nonce);
 
@@ -1,9 +1,11 @@
 #include "sign.h"
 #include "../fips202/fips202.h"
+#include "../fips202/mbhash.h"
 #include "packing.h"
 #include "params.h"
 #include "poly.h"
 #include "polyvec.h"
+#include <stddef.h>
 #include <stdint.h>
 
 /*************************************************
@@ -18,20 +20,20 @@
  **************************************************/
 void expand_mat (polyvecl mat[K], const unsigned char rho[SEEDBYTES]) {
     unsigned int i, j;
-    unsigned char inbuf[SEEDBYTES + 1];
-    /* Don't change this to smaller values,
-     * sampling later assumes sufficient SHAKE output!
-     * Probability that we need more than 5 blocks: < 2^{-132}.
-     * Probability that we need more than 6 blocks: < 2^{-546}. */
-    unsigned char outbuf[5 * SHAKE128_RATE];
+    unsigned char nonce;
+    keccak_state seedstate, state;
 
-    for (i = 0; i < SEEDBYTES; ++i) inbuf[i] = rho[i];
+    /* rho is absorbed once; each entry continues from that midstate */
+    shake128_inc_init (&seedstate);
+    shake128_inc_absorb (&seedstate, rho, SEEDBYTES);
 
     for (i = 0; i < K; ++i) {
         for (j = 0; j < L; ++j) {
-            inbuf[SEEDBYTES] = i + (j << 4);
-            shake128 (outbuf, sizeof (outbuf), inbuf, SEEDBYTES + 1);
-            poly_uniform (mat[i].vec + j, outbuf);
+            nonce = i + (j << 4);
+            keccak_inc_clone (&state, &seedstate);
+            shake128_inc_absorb (&state, &nonce, 1);
+            shake128_inc_finalize (&state);
+            poly_uniform (mat[i].vec + j, state.s);
         }
     }
 }
@@ -149,6 +151,54 @@ int dilithium_sign_keypair_cgo (char *pk, char *sk, char *seed) {
                                    (unsigned char *)seed);
 }
 
+/*************************************************
+ * Name:        compute_mu
+ *
+ * Description: Computes mu = CRH(tr, msg). In DILITHIUM_MODE_PURE the
+ *              message is hashed in place with SHAKE256. In
+ *              DILITHIUM_MODE_TREE_PREHASH it is first reduced to a
+ *              ParallelHash256 digest on the thread pool, and mu is the
+ *              cSHAKE256 of tr || digest under a customization string
+ *              naming the mode, so that the two modes never share a mu.
+ *
+ * Arguments:   - unsigned char *mu: output of CRHBYTES bytes
+ *              - const unsigned char *tr: CRH(pk)
+ *              - const unsigned char *m: pointer to message
+ *              - unsigned long long mlen: length of message
+ *              - int mode: DILITHIUM_MODE_PURE or DILITHIUM_MODE_TREE_PREHASH
+ *
+ * Returns 0 on success, -1 for an unknown mode
+ **************************************************/
+static int compute_mu (unsigned char mu[CRHBYTES],
+                       const unsigned char tr[CRHBYTES],
+                       const unsigned char *m,
+                       unsigned long long mlen,
+                       int mode) {
+    static const unsigned char tree_cstm[] = "Dilithium tree prehash";
+    unsigned char ph[CRHBYTES];
+    keccak_state state;
+
+    switch (mode) {
+    case DILITHIUM_MODE_PURE:
+        shake256_inc_init (&state);
+        shake256_inc_absorb (&state, tr, CRHBYTES);
+        shake256_inc_absorb (&state, m, mlen);
+        shake256_inc_finalize (&state);
+        break;
+    case DILITHIUM_MODE_TREE_PREHASH:
+        parallelhash256 (ph, sizeof ph, m, mlen, DILITHIUM_PREHASH_BLOCKBYTES, NULL, 0);
+        cshake256_inc_init (&state, NULL, 0, tree_cstm, sizeof tree_cstm - 1);
+        shake256_inc_absorb (&state, tr, CRHBYTES);
+        shake256_inc_absorb (&state, ph, sizeof ph);
+        cshake256_inc_finalize (&state);
+        break;
+    default:
+        return -1;
+    }
+    shake256_inc_squeeze (mu, CRHBYTES, &state);
+    return 0;
+}
+
 /* TESERAKT */
 int dilithium_sign_cgo (char *sm, char *m, unsigned long long mlen, char *sk) {
     unsigned long long smlen;
@@ -157,6 +207,14 @@ int dilithium_sign_cgo (char *sm, char *m, unsigned long long mlen, char *sk) {
                            mlen, (const unsigned char *)sk);
 }
 
+/* TESERAKT */
+int dilithium_sign_mode_cgo (char *sm, char *m, unsigned long long mlen, char *sk, int mode) {
+    unsigned long long smlen;
+
+    return dilithium_sign_mode ((unsigned char *)sm, &smlen, (const unsigned char *)m,
+                                mlen, (const unsigned char *)sk, mode);
+}
+
 /*************************************************
  * Name:        dilithium_sign
  *
@@ -178,6 +236,27 @@ int dilithium_sign (unsigned char *sm,
                     const unsigned char *m,
                     unsigned long long mlen,
                     const unsigned char *sk) {
+    return dilithium_sign_mode (sm, smlen, m, mlen, sk, DILITHIUM_MODE_PURE);
+}
+
+/*************************************************
+ * Name:        dilithium_sign_mode
+ *
+ * Description: Compute signed message, binding the message as selected by
+ *              mode (see compute_mu). A signature only verifies under the
+ *              mode it was made with.
+ *
+ * Arguments:   as for dilithium_sign, and
+ *              - int mode: DILITHIUM_MODE_PURE or DILITHIUM_MODE_TREE_PREHASH
+ *
+ * Returns 0 (success) or -1 for an unknown mode
+ **************************************************/
+int dilithium_sign_mode (unsigned char *sm,
+                         unsigned long long *smlen,
+                         const unsigned char *m,
+                         unsigned long long mlen,
+                         const unsigned char *sk,
+                         int mode) {
     unsigned long long i, j;
     unsigned int n;
     unsigned char seedbuf[2 * SEEDBYTES + CRHBYTES]; // TODO: nonce in seedbuf (2x)
@@ -194,13 +273,8 @@ int dilithium_sign (unsigned char *sm,
     mu = seedbuf + 2 * SEEDBYTES;
     unpack_sk (rho, key, tr, &s1, &s2, &t0, sk);
 
-    /* Copy tr and message into the sm buffer,
-     * backwards since m and sm can be equal in SUPERCOP API */
-    for (i = 1; i <= mlen; ++i) sm[DILITHIUM_BYTES + mlen - i] = m[mlen - i];
-    for (i = 0; i < CRHBYTES; ++i) sm[DILITHIUM_BYTES - CRHBYTES + i] = tr[i];
-
     /* Compute CRH(tr, msg) */
-    shake256 (mu, CRHBYTES, sm + DILITHIUM_BYTES - CRHBYTES, CRHBYTES + mlen);
+    if (compute_mu (mu, tr, m, mlen, mode)) return -1;
 
     /* Expand matrix and transform vectors */
     expand_mat (mat, rho);
@@ -266,6 +340,10 @@ rej:
     n = polyveck_make_hint (&h, &wcs2, &tmp);
     if (n > OMEGA) goto rej;
 
+    /* Copy message behind the signature,
+     * backwards since m and sm can be equal in SUPERCOP API */
+    for (i = 1; i <= mlen; ++i) sm[DILITHIUM_BYTES + mlen - i] = m[mlen - i];
+
     /* Write signature */
     pack_sig (sm, &z, &h, &c);
 
@@ -281,6 +359,14 @@ int dilithium_sign_open_cgo (char *m, char *sm, unsigned long long smlen, char *
                                 smlen, (const unsigned char *)pk);
 }
 
+/* TESERAKT */
+int dilithium_sign_open_mode_cgo (char *m, char *sm, unsigned long long smlen, char *pk, int mode) {
+
+    unsigned long long mlen;
+    return dilithium_sign_open_mode ((unsigned char *)m, &mlen, (const unsigned char *)sm,
+                                     smlen, (const unsigned char *)pk, mode);
+}
+
 /*************************************************
  * Name:        dilithium_sign_open
  *
@@ -300,8 +386,28 @@ int dilithium_sign_open (unsigned char *m,
                          const unsigned char *sm,
                          unsigned long long smlen,
                          const unsigned char *pk) {
+    return dilithium_sign_open_mode (m, mlen, sm, smlen, pk, DILITHIUM_MODE_PURE);
+}
+
+/*************************************************
+ * Name:        dilithium_sign_open_mode
+ *
+ * Description: Verify signed message made by dilithium_sign_mode.
+ *
+ * Arguments:   as for dilithium_sign_open, and
+ *              - int mode: DILITHIUM_MODE_PURE or DILITHIUM_MODE_TREE_PREHASH
+ *
+ * Returns 0 if signed message could be verified correctly and -1 otherwise
+ **************************************************/
+int dilithium_sign_open_mode (unsigned char *m,
+                              unsigned long long *mlen,
+                              const unsigned char *sm,
+                              unsigned long long smlen,
+                              const unsigned char *pk,
+                              int mode) {
     unsigned long long i;
     unsigned char rho[SEEDBYTES];
+    unsigned char tr[CRHBYTES];
     unsigned char mu[CRHBYTES];
     poly c, chat, cp;
     polyvecl mat[K], z;
@@ -315,13 +421,9 @@ int dilithium_sign_open (unsigned char *m,
     if (unpack_sig (&z, &h, &c, sm)) goto badsig;
     if (polyvecl_chknorm (&z, GAMMA1 - BETA)) goto badsig;
 
-    /* Compute CRH(CRH(rho, t1), msg) using m as "playground" buffer */
-    if (sm != m)
-        for (i = 0; i < *mlen; ++i)
-            m[DILITHIUM_BYTES + i] = sm[DILITHIUM_BYTES + i];
-
-    shake256 (m + DILITHIUM_BYTES - CRHBYTES, CRHBYTES, pk, DILITHIUM_PUBLICKEYBYTES);
-    shake256 (mu, CRHBYTES, m + DILITHIUM_BYTES - CRHBYTES, CRHBYTES + *mlen);
+    /* Compute CRH(CRH(rho, t1), msg) */
+    mbhash_shake256 (tr, CRHBYTES, pk, DILITHIUM_PUBLICKEYBYTES);
+    if (compute_mu (mu, tr, sm + DILITHIUM_BYTES, *mlen, mode)) goto badsig;
 
     /* Matrix-vector multiplication; compute Az - c2^dt1 */
     expand_mat (mat, rho);
@@ -4,6 +4,14 @@
 #include "poly.h"
 #include "polyvec.h"
 
+/* How mu binds the message: SHAKE256 over the message itself, or over its
+ * ParallelHash256 digest (tree prehash, for very large messages) */
+#define DILITHIUM_MODE_PURE 0
+#define DILITHIUM_MODE_TREE_PREHASH 1
+
+/* ParallelHash256 block size used by the tree prehash mode */
+#define DILITHIUM_PREHASH_BLOCKBYTES 8192
+
 void expand_mat (polyvecl mat[K], const unsigned char rho[SEEDBYTES]);
 void challenge (poly *c, const unsigned char mu[CRHBYTES], const polyveck *w1);
 
@@ -17,10 +25,27 @@ int dilithium_sign (unsigned char *sm,
                     unsigned long long len,
                     const unsigned char *sk);
 
+int dilithium_sign_mode (unsigned char *sm,
+                         unsigned long long *smlen,
+                         const unsigned char *msg,
+                         unsigned long long len,
+                         const unsigned char *sk,
+                         int mode);
+
 int dilithium_sign_cgo (char *sm, char *m, unsigned long long mlen, char *sk);
+int dilithium_sign_mode_cgo (char *sm, char *m, unsigned long long mlen, char *sk, int mode);
 
 int dilithium_sign_open (unsigned char *m,
                          unsigned long long *mlen,
                          const unsigned char *sm,
                          unsigned long long smlen,
                          const unsigned char *pk);
+int dilithium_sign_open_mode (unsigned char *m,
+                              unsigned long long *mlen,
+                              const unsigned char *sm,
+                              unsigned long long smlen,
+                              const unsigned char *pk,
+                              int mode);
+
+int dilithium_sign_open_cgo (char *m, char *sm, unsigned long long smlen, char *pk);
+int dilithium_sign_open_mode_cgo (char *m, char *sm, unsigned long long smlen, char *pk, int mode);
@@ -0,0 +1,224 @@
+/* Runtime selection of the arithmetic and hashing kernels.
+ * The public entry points at the bottom of this file forward through
+ * pqgo_dispatch, which is filled once at startup by pqgo_dispatch_init
+ * from the features of the CPU we run on. Setting the environment variable
+ * PQGO_BACKEND to "ref", "opt", "avx2" or "avx512" caps the selection. */
+
+#include "dispatch.h"
+#include "../dilithium/ntt.h"
+#include "../fips202/keccakf1600.h"
+#include "../kyber/kyber_compress.h"
+#include "../kyber/kyber_ntt.h"
+#include "../round5/ringmul.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const pqgo_dispatch_table pqgo_dispatch_ref = {
+    "ref",
+    KeccakF1600_StatePermute_ref,
+    KeccakF1600_StateXORBytes_ref,
+    KeccakF1600_StateExtractBytes_ref,
+    KeccakF1600x4_StatePermute_ref,
+    KeccakF1600x8_StatePermute_ref,
+    kyber_ntt_ref,
+    kyber_invntt_ref,
+    kyber_compress11_ref,
+    kyber_decompress11_ref,
+    kyber_compress3_ref,
+    kyber_decompress3_ref,
+    ntt_ref,
+    invntt_frominvmont_ref,
+    ringmul_q_ref,
+    ringmul_p_ref,
+    aes256_setkey_ref,
+    aes256_ecb_ref,
+};
+
+pqgo_dispatch_table pqgo_dispatch = {
+    "ref",
+    KeccakF1600_StatePermute_ref,
+    KeccakF1600_StateXORBytes_ref,
+    KeccakF1600_StateExtractBytes_ref,
+    KeccakF1600x4_StatePermute_ref,
+    KeccakF1600x8_StatePermute_ref,
+    kyber_ntt_ref,
+    kyber_invntt_ref,
+    kyber_compress11_ref,
+    kyber_decompress11_ref,
+    kyber_compress3_ref,
+    kyber_decompress3_ref,
+    ntt_ref,
+    invntt_frominvmont_ref,
+    ringmul_q_ref,
+    ringmul_p_ref,
+    aes256_setkey_ref,
+    aes256_ecb_ref,
+};
+
+/*************************************************
+ * Name:        pqgo_dispatch_select
+ *
+ * Description: Switches pqgo_dispatch to the kernels of the given backend
+ *              level. Not thread-safe: only call it while no other
+ *              function of the library is running.
+ *
+ * Arguments:   - int level: one of PQGO_BACKEND_REF, _OPT, _AVX2, _AVX512
+ *
+ * Returns 0 on success, -1 if the CPU lacks the required features
+ * (pqgo_dispatch is then left unchanged).
+ **************************************************/
+int pqgo_dispatch_select (int level) {
+    pqgo_dispatch_table t = pqgo_dispatch_ref;
+
+    if (level < PQGO_BACKEND_REF || level > PQGO_BACKEND_AVX512) return -1;
+
+    if (level >= PQGO_BACKEND_OPT) {
+        t.name = "opt";
+        t.keccakf1600_permute = KeccakF1600_StatePermute_opt;
+        t.keccakf1600_xorbytes = KeccakF1600_StateXORBytes_opt;
+        t.keccakf1600_extractbytes = KeccakF1600_StateExtractBytes_opt;
+        t.kyber_ntt = kyber_ntt_opt;
+        t.kyber_invntt = kyber_invntt_opt;
+    }
+
+#if defined(__x86_64__)
+    __builtin_cpu_init ();
+
+    if (level >= PQGO_BACKEND_AVX2) {
+        if (!__builtin_cpu_supports ("avx2")) return -1;
+        t.name = "avx2";
+        t.keccakf1600x4_permute = KeccakF1600x4_StatePermute_avx2;
+        t.kyber_ntt = kyber_ntt_avx2;
+        t.kyber_invntt = kyber_invntt_avx2;
+        t.kyber_compress11 = kyber_compress11_avx2;
+        t.kyber_decompress11 = kyber_decompress11_avx2;
+        t.kyber_compress3 = kyber_compress3_avx2;
+        t.kyber_decompress3 = kyber_decompress3_avx2;
+        t.dilithium_ntt = ntt_avx2;
+        t.dilithium_invntt_frominvmont = invntt_frominvmont_avx2;
+#ifndef CM_CACHE
+        t.ringmul_q = ringmul_q_avx2;
+        t.ringmul_p = ringmul_p_avx2;
+#endif
+        if (__builtin_cpu_supports ("aes")) {
+            t.aes256_setkey = aes256_setkey_aesni;
+            t.aes256_ecb = aes256_ecb_aesni;
+        }
+    }
+
+    if (level >= PQGO_BACKEND_AVX512) {
+        if (!__builtin_cpu_supports ("avx512f")) return -1;
+        t.name = "avx512";
+        t.keccakf1600x8_permute = KeccakF1600x8_StatePermute_avx512;
+    }
+#else
+    if (level > PQGO_BACKEND_OPT) return -1;
+#endif
+
+    pqgo_dispatch = t;
+    return 0;
+}
+
+/*************************************************
+ * Name:        pqgo_dispatch_init
+ *
+ * Description: Selects the best backend supported by the CPU, capped by
+ *              the PQGO_BACKEND environment variable if set.
+ **************************************************/
+void pqgo_dispatch_init (void) {
+    const char *env = getenv ("PQGO_BACKEND");
+    int level = PQGO_BACKEND_AVX512;
+
+    if (env != NULL) {
+        if (strcmp (env, "ref") == 0)
+            level = PQGO_BACKEND_REF;
+        else if (strcmp (env, "opt") == 0)
+            level = PQGO_BACKEND_OPT;
+        else if (strcmp (env, "avx2") == 0)
+            level = PQGO_BACKEND_AVX2;
+    }
+
+    while (pqgo_dispatch_select (level) != 0) level--;
+}
+
+const char *pqgo_dispatch_backend (void) {
+    return pqgo_dispatch.name;
+}
+
+void KeccakF1600_StatePermute (uint64_t *state) {
+    pqgo_dispatch.keccakf1600_permute (state);
+}
+
+void KeccakF1600_StateXORBytes (uint64_t *state,
+                                const unsigned char *data,
+                                unsigned int offset,
+                                unsigned int length) {
+    pqgo_dispatch.keccakf1600_xorbytes (state, data, offset, length);
+}
+
+void KeccakF1600_StateExtractBytes (uint64_t *state,
+                                    unsigned char *data,
+                                    unsigned int offset,
+                                    unsigned int length) {
+    pqgo_dispatch.keccakf1600_extractbytes (state, data, offset, length);
+}
+
+void KeccakF1600x4_StatePermute (uint64_t *state) {
+    pqgo_dispatch.keccakf1600x4_permute (state);
+}
+
+void KeccakF1600x8_StatePermute (uint64_t *state) {
+    pqgo_dispatch.keccakf1600x8_permute (state);
+}
+
+void kyber_ntt (uint16_t *poly) {
+    pqgo_dispatch.kyber_ntt (poly);
+}
+
+void kyber_invntt (uint16_t *poly) {
+    pqgo_dispatch.kyber_invntt (poly);
+}
+
+void kyber_compress11 (unsigned char *r, const uint16_t *a) {
+    pqgo_dispatch.kyber_compress11 (r, a);
+}
+
+void kyber_decompress11 (uint16_t *r, const unsigned char *a) {
+    pqgo_dispatch.kyber_decompress11 (r, a);
+}
+
+void kyber_compress3 (unsigned char *r, const uint16_t *a) {
+    pqgo_dispatch.kyber_compress3 (r, a);
+}
+
+void kyber_decompress3 (uint16_t *r, const unsigned char *a) {
+    pqgo_dispatch.kyber_decompress3 (r, a);
+}
+
+void ntt (uint32_t p[N]) {
+    pqgo_dispatch.dilithium_ntt (p);
+}
+
+void invntt_frominvmont (uint32_t p[N]) {
+    pqgo_dispatch.dilithium_invntt_frominvmont (p);
+}
+
+void ringmul_q (modq_t d[PARAMS_ND + PARAMS_MUL_PAD],
+                const modq_t a[PARAMS_ND],
+                const uint16_t idx[PARAMS_H / 2][2]) {
+    pqgo_dispatch.ringmul_q (d, a, idx);
+}
+
+void ringmul_p (modp_t d[PARAMS_MU + PARAMS_MUL_PAD],
+                const modp_t a[PARAMS_ND],
+                const uint16_t idx[PARAMS_H / 2][2]) {
+    pqgo_dispatch.ringmul_p (d, a, idx);
+}
+
+void aes256_setkey (aes256_ctx *ctx, const uint8_t key[32]) {
+    pqgo_dispatch.aes256_setkey (ctx, key);
+}
+
+void aes256_ecb (const aes256_ctx *ctx, uint8_t *out, const uint8_t *in, size_t nblocks) {
+    pqgo_dispatch.aes256_ecb (ctx, out, in, nblocks);
+}
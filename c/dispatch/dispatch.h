@@ -0,0 +1,50 @@
+#ifndef DISPATCH_H
+#define DISPATCH_H
+
+#include <stdint.h>
+
+#include "../randombytes/aes256.h"
+#include "../round5/params.h"
+
+/* Backend levels, in increasing order of required CPU features */
+#define PQGO_BACKEND_REF 0
+#define PQGO_BACKEND_OPT 1 /* tuned portable C */
+#define PQGO_BACKEND_AVX2 2
+#define PQGO_BACKEND_AVX512 3
+
+/* Kernel table; every entry is valid at any time. It statically points to
+ * the reference code and is switched once by pqgo_dispatch_init */
+typedef struct {
+    const char *name;
+    void (*keccakf1600_permute) (uint64_t *state);
+    void (*keccakf1600_xorbytes) (uint64_t *state,
+                                  const unsigned char *data,
+                                  unsigned int offset,
+                                  unsigned int length);
+    void (*keccakf1600_extractbytes) (uint64_t *state,
+                                      unsigned char *data,
+                                      unsigned int offset,
+                                      unsigned int length);
+    void (*keccakf1600x4_permute) (uint64_t *state);
+    void (*keccakf1600x8_permute) (uint64_t *state);
+    void (*kyber_ntt) (uint16_t *poly);
+    void (*kyber_invntt) (uint16_t *poly);
+    void (*kyber_compress11) (unsigned char *r, const uint16_t *a);
+    void (*kyber_decompress11) (uint16_t *r, const unsigned char *a);
+    void (*kyber_compress3) (unsigned char *r, const uint16_t *a);
+    void (*kyber_decompress3) (uint16_t *r, const unsigned char *a);
+    void (*dilithium_ntt) (uint32_t *p);
+    void (*dilithium_invntt_frominvmont) (uint32_t *p);
+    void (*ringmul_q) (modq_t *d, const modq_t *a, const uint16_t idx[][2]);
+    void (*ringmul_p) (modp_t *d, const modp_t *a, const uint16_t idx[][2]);
+    void (*aes256_setkey) (aes256_ctx *ctx, const uint8_t key[32]);
+    void (*aes256_ecb) (const aes256_ctx *ctx, uint8_t *out, const uint8_t *in, size_t nblocks);
+} pqgo_dispatch_table;
+
+extern pqgo_dispatch_table pqgo_dispatch;
+
+int pqgo_dispatch_select (int level);
+void pqgo_dispatch_init (void);
+const char *pqgo_dispatch_backend (void);
+
+#endif
@@ -282,6 +282,231 @@ void sha3_512 (unsigned char *output, const unsigned char *input, unsigned long
     for (i = 0; i < 64; i++) output[i] = t[i];
 }
 
+/********** Incremental API ***********/
+
+/*************************************************
+ * Name:        keccak_inc_init
+ *
+ * Description: Initializes an incremental Keccak context (zero state).
+ *
+ * Arguments:   - keccak_state *state: pointer to (uninitialized) context
+ **************************************************/
+static void keccak_inc_init (keccak_state *state) {
+    unsigned int i;
+
+    for (i = 0; i < 25; i++) state->s[i] = 0;
+    state->pos = 0;
+}
+
+/*************************************************
+ * Name:        keccak_inc_absorb
+ *
+ * Description: Absorb step of the incremental Keccak API;
+ *              can be called any number of times with inputs of any length.
+ *              Full blocks are XORed into the state directly from the input.
+ *
+ * Arguments:   - keccak_state *state:     pointer to in/output context
+ *              - unsigned int r:          rate in bytes (e.g., 168 for SHAKE128)
+ *              - const unsigned char *m:  pointer to input to be absorbed
+ *              - unsigned long long mlen: length of input in bytes
+ **************************************************/
+static void keccak_inc_absorb (keccak_state *state,
+                               unsigned int r,
+                               const unsigned char *m,
+                               unsigned long long mlen) {
+    unsigned int i;
+
+    if (state->pos + mlen < r) {
+        for (i = state->pos; i < state->pos + mlen; i++)
+            state->s[i / 8] ^= (uint64_t)*m++ << 8 * (i % 8);
+        state->pos += mlen;
+        return;
+    }
+
+    /* Complete a partially filled block */
+    if (state->pos) {
+        for (i = state->pos; i < r; i++) state->s[i / 8] ^= (uint64_t)*m++ << 8 * (i % 8);
+        mlen -= r - state->pos;
+        KeccakF1600_StatePermute (state->s);
+    }
+
+    while (mlen >= r) {
+        KeccakF1600_StateXORBytes (state->s, m, 0, r);
+        KeccakF1600_StatePermute (state->s);
+        mlen -= r;
+        m += r;
+    }
+
+    for (i = 0; i < mlen; i++) state->s[i / 8] ^= (uint64_t)m[i] << 8 * (i % 8);
+    state->pos = mlen;
+}
+
+/*************************************************
+ * Name:        keccak_inc_finalize
+ *
+ * Description: Appends the domain-separation byte and the final padding bit;
+ *              switches the context to squeezing.
+ *
+ * Arguments:   - keccak_state *state: pointer to in/output context
+ *              - unsigned int r:      rate in bytes
+ *              - unsigned char p:     domain-separation byte
+ **************************************************/
+static void keccak_inc_finalize (keccak_state *state, unsigned int r, unsigned char p) {
+    state->s[state->pos / 8] ^= (uint64_t)p << 8 * (state->pos % 8);
+    state->s[(r - 1) / 8] ^= 1ULL << 63;
+    state->pos = r;
+}
+
+/*************************************************
+ * Name:        keccak_inc_squeeze
+ *
+ * Description: Squeeze step of the incremental Keccak API; produces any
+ *              number of bytes and can be called repeatedly.
+ *
+ * Arguments:   - unsigned char *h:          pointer to output
+ *              - unsigned long long outlen: number of bytes to be squeezed
+ *              - keccak_state *state:       pointer to in/output context
+ *              - unsigned int r:            rate in bytes
+ **************************************************/
+static void keccak_inc_squeeze (unsigned char *h,
+                                unsigned long long outlen,
+                                keccak_state *state,
+                                unsigned int r) {
+    unsigned int i;
+
+    while (outlen > 0) {
+        if (state->pos == r) {
+            KeccakF1600_StatePermute (state->s);
+            state->pos = 0;
+            if (outlen >= r) { /* whole block, word-wise */
+                KeccakF1600_StateExtractBytes (state->s, h, 0, r);
+                h += r;
+                outlen -= r;
+                state->pos = r;
+                continue;
+            }
+        }
+        for (i = state->pos; i < r && outlen > 0; i++, outlen--)
+            *h++ = state->s[i / 8] >> 8 * (i % 8);
+        state->pos = i;
+    }
+}
+
+/*************************************************
+ * Name:        keccak_inc_clone
+ *
+ * Description: Copies an incremental context. Used to keep a midstate:
+ *              absorb a prefix shared by many inputs once, then clone the
+ *              context and absorb only the suffix for each of them. Every
+ *              full rate block of the prefix is a permutation saved per
+ *              clone; shorter prefixes only save the copying and absorbing.
+ *              Works for any of the SHAKE and SHA3 incremental contexts,
+ *              in absorbing or squeezing state.
+ *
+ * Arguments:   - keccak_state *dst:       pointer to output context
+ *              - const keccak_state *src: pointer to context to be copied
+ **************************************************/
+void keccak_inc_clone (keccak_state *dst, const keccak_state *src) {
+    *dst = *src;
+}
+
+void shake128_inc_init (keccak_state *state) { keccak_inc_init (state); }
+
+void shake128_inc_absorb (keccak_state *state, const unsigned char *input, unsigned long long inlen) {
+    keccak_inc_absorb (state, SHAKE128_RATE, input, inlen);
+}
+
+void shake128_inc_finalize (keccak_state *state) {
+    keccak_inc_finalize (state, SHAKE128_RATE, 0x1F);
+}
+
+void shake128_inc_squeeze (unsigned char *output, unsigned long long outlen, keccak_state *state) {
+    keccak_inc_squeeze (output, outlen, state, SHAKE128_RATE);
+}
+
+void shake256_inc_init (keccak_state *state) { keccak_inc_init (state); }
+
+void shake256_inc_absorb (keccak_state *state, const unsigned char *input, unsigned long long inlen) {
+    keccak_inc_absorb (state, SHAKE256_RATE, input, inlen);
+}
+
+void shake256_inc_finalize (keccak_state *state) {
+    keccak_inc_finalize (state, SHAKE256_RATE, 0x1F);
+}
+
+void shake256_inc_squeeze (unsigned char *output, unsigned long long outlen, keccak_state *state) {
+    keccak_inc_squeeze (output, outlen, state, SHAKE256_RATE);
+}
+
+/* left_encode of NIST SP 800-185; returns the encoded length */
+static unsigned int keccak_left_encode (unsigned char *buf, unsigned long long x) {
+    unsigned int i, n = 1;
+
+    while (n < 8 && (x >> 8 * n)) n++;
+    buf[0] = n;
+    for (i = 1; i <= n; i++) buf[i] = x >> 8 * (n - i);
+    return n + 1;
+}
+
+/*************************************************
+ * Name:        cshake256_inc_init
+ *
+ * Description: Initializes an incremental cSHAKE256 context with function
+ *              name N and customization string S (NIST SP 800-185).
+ *              Continue with shake256_inc_absorb, cshake256_inc_finalize
+ *              and shake256_inc_squeeze. N and S must not both be empty.
+ *
+ * Arguments:   - keccak_state *state:     pointer to (uninitialized) context
+ *              - const unsigned char *n:  function name
+ *              - unsigned long long nlen: length of n in bytes
+ *              - const unsigned char *c:  customization string
+ *              - unsigned long long clen: length of c in bytes
+ **************************************************/
+void cshake256_inc_init (keccak_state *state,
+                         const unsigned char *n,
+                         unsigned long long nlen,
+                         const unsigned char *c,
+                         unsigned long long clen) {
+    static const unsigned char zeros[SHAKE256_RATE] = { 0 };
+    unsigned char buf[9];
+
+    keccak_inc_init (state);
+
+    /* bytepad (encode_string (N) || encode_string (S), rate) */
+    keccak_inc_absorb (state, SHAKE256_RATE, buf, keccak_left_encode (buf, SHAKE256_RATE));
+    keccak_inc_absorb (state, SHAKE256_RATE, buf, keccak_left_encode (buf, 8 * nlen));
+    keccak_inc_absorb (state, SHAKE256_RATE, n, nlen);
+    keccak_inc_absorb (state, SHAKE256_RATE, buf, keccak_left_encode (buf, 8 * clen));
+    keccak_inc_absorb (state, SHAKE256_RATE, c, clen);
+    if (state->pos) keccak_inc_absorb (state, SHAKE256_RATE, zeros, SHAKE256_RATE - state->pos);
+}
+
+void cshake256_inc_finalize (keccak_state *state) {
+    keccak_inc_finalize (state, SHAKE256_RATE, 0x04);
+}
+
+void sha3_256_inc_init (keccak_state *state) { keccak_inc_init (state); }
+
+void sha3_256_inc_absorb (keccak_state *state, const unsigned char *input, unsigned long long inlen) {
+    keccak_inc_absorb (state, SHA3_256_RATE, input, inlen);
+}
+
+void sha3_256_inc_finalize (unsigned char *output, keccak_state *state) {
+    keccak_inc_finalize (state, SHA3_256_RATE, 0x06);
+    keccak_inc_squeeze (output, 32, state, SHA3_256_RATE);
+}
+
+void sha3_512_inc_init (keccak_state *state) { keccak_inc_init (state); }
+
+void sha3_512_inc_absorb (keccak_state *state, const unsigned char *input, unsigned long long inlen) {
+    keccak_inc_absorb (state, SHA3_512_RATE, input, inlen);
+}
+
+void sha3_512_inc_finalize (unsigned char *output, keccak_state *state) {
+    keccak_inc_finalize (state, SHA3_512_RATE, 0x06);
+    keccak_inc_squeeze (output, 64, state, SHA3_512_RATE);
+}
+
 /********** cSHAKE256 ***********/
 
 void cshake256_simple_absorb (uint64_t s[25],
@@ -8,6 +8,12 @@
 #define SHA3_256_RATE 136
 #define SHA3_512_RATE 72
 
+/* Incremental Keccak context; pos is the byte offset within the current block */
+typedef struct {
+    uint64_t s[25];
+    unsigned int pos;
+} keccak_state;
+
 void shake128_absorb (uint64_t *s, const unsigned char *input, unsigned int inputByteLen);
 void shake128_squeezeblocks (unsigned char *output, unsigned long long nblocks, uint64_t *s);
 void shake128 (unsigned char *output,
@@ -45,4 +51,127 @@ void cshake256_simple (unsigned char *output,
 void sha3_256 (unsigned char *output, const unsigned char *input, unsigned long long inlen);
 void sha3_512 (unsigned char *output, const unsigned char *input, unsigned long long inlen);
 
+/* Midstate: absorb a common prefix once, clone the context per suffix */
+void keccak_inc_clone (keccak_state *dst, const keccak_state *src);
+
+void shake128_inc_init (keccak_state *state);
+void shake128_inc_absorb (keccak_state *state, const unsigned char *input, unsigned long long inlen);
+void shake128_inc_finalize (keccak_state *state);
+void shake128_inc_squeeze (unsigned char *output, unsigned long long outlen, keccak_state *state);
+
+void shake256_inc_init (keccak_state *state);
+void shake256_inc_absorb (keccak_state *state, const unsigned char *input, unsigned long long inlen);
+void shake256_inc_finalize (keccak_state *state);
+void shake256_inc_squeeze (unsigned char *output, unsigned long long outlen, keccak_state *state);
+
+/* cSHAKE256 with arbitrary N and S; absorb and squeeze as for shake256_inc */
+void cshake256_inc_init (keccak_state *state,
+                         const unsigned char *n,
+                         unsigned long long nlen,
+                         const unsigned char *c,
+                         unsigned long long clen);
+void cshake256_inc_finalize (keccak_state *state);
+
+void sha3_256_inc_init (keccak_state *state);
+void sha3_256_inc_absorb (keccak_state *state, const unsigned char *input, unsigned long long inlen);
+void sha3_256_inc_finalize (unsigned char *output, keccak_state *state);
+
+void sha3_512_inc_init (keccak_state *state);
+void sha3_512_inc_absorb (keccak_state *state, const unsigned char *input, unsigned long long inlen);
+void sha3_512_inc_finalize (unsigned char *output, keccak_state *state);
+
+/* ParallelHash256 (SP 800-185) on the thread pool of c/parallel */
+void parallelhash256 (unsigned char *out,
+                      unsigned long long outlen,
+                      const unsigned char *in,
+                      unsigned long long inlen,
+                      unsigned long long blocklen,
+                      const unsigned char *cstm,
+                      unsigned long long cstmlen);
+
+/* Four independent instances of equal input length per call;
+ * the state is 4 * 25 interleaved words (see KeccakF1600x4_StatePermute) */
+void shake128x4_absorb (uint64_t *s,
+                        const unsigned char *in0,
+                        const unsigned char *in1,
+                        const unsigned char *in2,
+                        const unsigned char *in3,
+                        unsigned int inlen);
+void shake128x4_squeezeblocks (unsigned char *out0,
+                               unsigned char *out1,
+                               unsigned char *out2,
+                               unsigned char *out3,
+                               unsigned long long nblocks,
+                               uint64_t *s);
+void shake128x4 (unsigned char *out0,
+                 unsigned char *out1,
+                 unsigned char *out2,
+                 unsigned char *out3,
+                 unsigned long long outlen,
+                 const unsigned char *in0,
+                 const unsigned char *in1,
+                 const unsigned char *in2,
+                 const unsigned char *in3,
+                 unsigned long long inlen);
+
+void shake256x4_absorb (uint64_t *s,
+                        const unsigned char *in0,
+                        const unsigned char *in1,
+                        const unsigned char *in2,
+                        const unsigned char *in3,
+                        unsigned int inlen);
+void shake256x4_squeezeblocks (unsigned char *out0,
+                               unsigned char *out1,
+                               unsigned char *out2,
+                               unsigned char *out3,
+                               unsigned long long nblocks,
+                               uint64_t *s);
+void shake256x4 (unsigned char *out0,
+                 unsigned char *out1,
+                 unsigned char *out2,
+                 unsigned char *out3,
+                 unsigned long long outlen,
+                 const unsigned char *in0,
+                 const unsigned char *in1,
+                 const unsigned char *in2,
+                 const unsigned char *in3,
+                 unsigned long long inlen);
+
+/* SHA3 on four independent inputs of equal length; the outputs may
+ * overlap the inputs */
+void sha3_256x4 (unsigned char *out0,
+                 unsigned char *out1,
+                 unsigned char *out2,
+                 unsigned char *out3,
+                 const unsigned char *in0,
+                 const unsigned char *in1,
+                 const unsigned char *in2,
+                 const unsigned char *in3,
+                 unsigned long long inlen);
+void sha3_512x4 (unsigned char *out0,
+                 unsigned char *out1,
+                 unsigned char *out2,
+                 unsigned char *out3,
+                 const unsigned char *in0,
+                 const unsigned char *in1,
+                 const unsigned char *in2,
+                 const unsigned char *in3,
+                 unsigned long long inlen);
+
+/* Eight independent instances of equal input length per call;
+ * the state is 8 * 25 interleaved words (see KeccakF1600x8_StatePermute) */
+void shake128x8_absorb (uint64_t *s, const unsigned char *in[8], unsigned int inlen);
+void shake128x8_squeezeblocks (unsigned char *out[8], unsigned long long nblocks, uint64_t *s);
+void shake128x8 (unsigned char *out[8],
+                 unsigned long long outlen,
+                 const unsigned char *in[8],
+                 unsigned long long inlen);
+
+void shake256x8_absorb (uint64_t *s, const unsigned char *in[8], unsigned int inlen);
+void shake256x8_squeezeblocks (unsigned char *out[8], unsigned long long nblocks, uint64_t *s);
+void shake256x8 (unsigned char *out[8],
+                 unsigned long long outlen,
+                 const unsigned char *in[8],
+                 unsigned long long inlen);
+
 #endif
@@ -0,0 +1,282 @@
+/* Four-way parallel SHAKE128 and SHAKE256 on top of the interleaved
+ * Keccak-f[1600] permutation in keccakf1600x4.c.
+ * Each call processes four independent inputs of equal length. */
+
+#include "fips202.h"
+#include "keccakf1600.h"
+#include <stdint.h>
+
+static uint64_t keccakx4_load64 (const unsigned char *x) {
+    unsigned int i;
+    uint64_t r = 0;
+
+    for (i = 0; i < 8; ++i) r |= (uint64_t)x[i] << 8 * i;
+    return r;
+}
+
+static void keccakx4_store64 (unsigned char *x, uint64_t u) {
+    unsigned int i;
+
+    for (i = 0; i < 8; ++i) {
+        x[i] = u;
+        u >>= 8;
+    }
+}
+
+/*************************************************
+ * Name:        keccakx4_absorb
+ *
+ * Description: Absorb step of four parallel Keccak instances;
+ *              non-incremental, starts by zeroeing the state.
+ *
+ * Arguments:   - uint64_t *s:              pointer to output interleaved state (4 * 25 words)
+ *              - unsigned int r:           rate in bytes (e.g., 168 for SHAKE128)
+ *              - const unsigned char *in0: pointer to input of instance 0 (likewise in1..in3)
+ *              - unsigned long long inlen: length of each input in bytes
+ *              - unsigned char p:          domain-separation byte
+ **************************************************/
+static void keccakx4_absorb (uint64_t *s,
+                             unsigned int r,
+                             const unsigned char *in0,
+                             const unsigned char *in1,
+                             const unsigned char *in2,
+                             const unsigned char *in3,
+                             unsigned long long inlen,
+                             unsigned char p) {
+    unsigned long long i;
+    unsigned int j;
+
+    for (i = 0; i < 4 * 25; i++) s[i] = 0;
+
+    while (inlen >= r) {
+        for (j = 0; j < r / 8; j++) {
+            s[4 * j + 0] ^= keccakx4_load64 (in0 + 8 * j);
+            s[4 * j + 1] ^= keccakx4_load64 (in1 + 8 * j);
+            s[4 * j + 2] ^= keccakx4_load64 (in2 + 8 * j);
+            s[4 * j + 3] ^= keccakx4_load64 (in3 + 8 * j);
+        }
+        KeccakF1600x4_StatePermute (s);
+        in0 += r;
+        in1 += r;
+        in2 += r;
+        in3 += r;
+        inlen -= r;
+    }
+
+    for (i = 0; i < inlen; i++) {
+        s[4 * (i / 8) + 0] ^= (uint64_t)in0[i] << 8 * (i % 8);
+        s[4 * (i / 8) + 1] ^= (uint64_t)in1[i] << 8 * (i % 8);
+        s[4 * (i / 8) + 2] ^= (uint64_t)in2[i] << 8 * (i % 8);
+        s[4 * (i / 8) + 3] ^= (uint64_t)in3[i] << 8 * (i % 8);
+    }
+
+    for (j = 0; j < 4; j++) {
+        s[4 * (i / 8) + j] ^= (uint64_t)p << 8 * (i % 8);
+        s[4 * ((r - 1) / 8) + j] ^= 1ULL << 63;
+    }
+}
+
+/*************************************************
+ * Name:        keccakx4_squeezeblocks
+ *
+ * Description: Squeeze step of four parallel Keccak instances.
+ *              Squeezes full blocks of r bytes each into every output.
+ *              Modifies the state. Can be called multiple times to keep
+ *              squeezing, i.e., is incremental.
+ *
+ * Arguments:   - unsigned char *out0:      pointer to output blocks of instance 0 (likewise out1..out3)
+ *              - unsigned long long nblocks: number of blocks to be squeezed
+ *              - uint64_t *s:              pointer to in/output interleaved state
+ *              - unsigned int r:           rate in bytes
+ **************************************************/
+static void keccakx4_squeezeblocks (unsigned char *out0,
+                                    unsigned char *out1,
+                                    unsigned char *out2,
+                                    unsigned char *out3,
+                                    unsigned long long nblocks,
+                                    uint64_t *s,
+                                    unsigned int r) {
+    unsigned int j;
+
+    while (nblocks > 0) {
+        KeccakF1600x4_StatePermute (s);
+        for (j = 0; j < r / 8; j++) {
+            keccakx4_store64 (out0 + 8 * j, s[4 * j + 0]);
+            keccakx4_store64 (out1 + 8 * j, s[4 * j + 1]);
+            keccakx4_store64 (out2 + 8 * j, s[4 * j + 2]);
+            keccakx4_store64 (out3 + 8 * j, s[4 * j + 3]);
+        }
+        out0 += r;
+        out1 += r;
+        out2 += r;
+        out3 += r;
+        nblocks--;
+    }
+}
+
+/*************************************************
+ * Name:        keccakx4
+ *
+ * Description: Four parallel Keccak XOFs with non-incremental API
+ *
+ * Arguments:   - unsigned char *out0:      pointer to output of instance 0 (likewise out1..out3)
+ *              - unsigned long long outlen: requested output length in bytes
+ *              - const unsigned char *in0: pointer to input of instance 0 (likewise in1..in3)
+ *              - unsigned long long inlen: length of each input in bytes
+ *              - unsigned int r:           rate in bytes
+ *              - unsigned char p:          domain-separation byte
+ **************************************************/
+static void keccakx4 (unsigned char *out0,
+                      unsigned char *out1,
+                      unsigned char *out2,
+                      unsigned char *out3,
+                      unsigned long long outlen,
+                      const unsigned char *in0,
+                      const unsigned char *in1,
+                      const unsigned char *in2,
+                      const unsigned char *in3,
+                      unsigned long long inlen,
+                      unsigned int r,
+                      unsigned char p) {
+    uint64_t s[4 * 25];
+    unsigned char t[4][SHAKE128_RATE];
+    unsigned long long nblocks = outlen / r;
+    unsigned long long i;
+
+    keccakx4_absorb (s, r, in0, in1, in2, in3, inlen, p);
+    keccakx4_squeezeblocks (out0, out1, out2, out3, nblocks, s, r);
+
+    out0 += nblocks * r;
+    out1 += nblocks * r;
+    out2 += nblocks * r;
+    out3 += nblocks * r;
+    outlen -= nblocks * r;
+
+    if (outlen) {
+        keccakx4_squeezeblocks (t[0], t[1], t[2], t[3], 1, s, r);
+        for (i = 0; i < outlen; i++) {
+            out0[i] = t[0][i];
+            out1[i] = t[1][i];
+            out2[i] = t[2][i];
+            out3[i] = t[3][i];
+        }
+    }
+}
+
+/*************************************************
+ * Name:        shake128x4_absorb
+ *
+ * Description: Absorb step of four parallel SHAKE128 XOFs;
+ *              non-incremental, starts by zeroeing the state.
+ *
+ * Arguments:   - uint64_t *s:              pointer to output interleaved state (4 * 25 words)
+ *              - const unsigned char *in0: pointer to input of instance 0 (likewise in1..in3)
+ *              - unsigned int inlen:       length of each input in bytes
+ **************************************************/
+void shake128x4_absorb (uint64_t *s,
+                        const unsigned char *in0,
+                        const unsigned char *in1,
+                        const unsigned char *in2,
+                        const unsigned char *in3,
+                        unsigned int inlen) {
+    keccakx4_absorb (s, SHAKE128_RATE, in0, in1, in2, in3, inlen, 0x1F);
+}
+
+void shake128x4_squeezeblocks (unsigned char *out0,
+                               unsigned char *out1,
+                               unsigned char *out2,
+                               unsigned char *out3,
+                               unsigned long long nblocks,
+                               uint64_t *s) {
+    keccakx4_squeezeblocks (out0, out1, out2, out3, nblocks, s, SHAKE128_RATE);
+}
+
+void shake128x4 (unsigned char *out0,
+                 unsigned char *out1,
+                 unsigned char *out2,
+                 unsigned char *out3,
+                 unsigned long long outlen,
+                 const unsigned char *in0,
+                 const unsigned char *in1,
+                 const unsigned char *in2,
+                 const unsigned char *in3,
+                 unsigned long long inlen) {
+    keccakx4 (out0, out1, out2, out3, outlen, in0, in1, in2, in3, inlen,
+              SHAKE128_RATE, 0x1F);
+}
+
+void shake256x4_absorb (uint64_t *s,
+                        const unsigned char *in0,
+                        const unsigned char *in1,
+                        const unsigned char *in2,
+                        const unsigned char *in3,
+                        unsigned int inlen) {
+    keccakx4_absorb (s, SHAKE256_RATE, in0, in1, in2, in3, inlen, 0x1F);
+}
+
+void shake256x4_squeezeblocks (unsigned char *out0,
+                               unsigned char *out1,
+                               unsigned char *out2,
+                               unsigned char *out3,
+                               unsigned long long nblocks,
+                               uint64_t *s) {
+    keccakx4_squeezeblocks (out0, out1, out2, out3, nblocks, s, SHAKE256_RATE);
+}
+
+void shake256x4 (unsigned char *out0,
+                 unsigned char *out1,
+                 unsigned char *out2,
+                 unsigned char *out3,
+                 unsigned long long outlen,
+                 const unsigned char *in0,
+                 const unsigned char *in1,
+                 const unsigned char *in2,
+                 const unsigned char *in3,
+                 unsigned long long inlen) {
+    keccakx4 (out0, out1, out2, out3, outlen, in0, in1, in2, in3, inlen,
+              SHAKE256_RATE, 0x1F);
+}
+
+/*************************************************
+ * Name:        sha3_256x4
+ *
+ * Description: Four parallel SHA3-256 hashes of equal-length inputs
+ *
+ * Arguments:   - unsigned char *out0:      pointer to 32-byte output of instance 0 (likewise out1..out3)
+ *              - const unsigned char *in0: pointer to input of instance 0 (likewise in1..in3)
+ *              - unsigned long long inlen: length of each input in bytes
+ **************************************************/
+void sha3_256x4 (unsigned char *out0,
+                 unsigned char *out1,
+                 unsigned char *out2,
+                 unsigned char *out3,
+                 const unsigned char *in0,
+                 const unsigned char *in1,
+                 const unsigned char *in2,
+                 const unsigned char *in3,
+                 unsigned long long inlen) {
+    keccakx4 (out0, out1, out2, out3, 32, in0, in1, in2, in3, inlen,
+              SHA3_256_RATE, 0x06);
+}
+
+/*************************************************
+ * Name:        sha3_512x4
+ *
+ * Description: Four parallel SHA3-512 hashes of equal-length inputs
+ *
+ * Arguments:   - unsigned char *out0:      pointer to 64-byte output of instance 0 (likewise out1..out3)
+ *              - const unsigned char *in0: pointer to input of instance 0 (likewise in1..in3)
+ *              - unsigned long long inlen: length of each input in bytes
+ **************************************************/
+void sha3_512x4 (unsigned char *out0,
+                 unsigned char *out1,
+                 unsigned char *out2,
+                 unsigned char *out3,
+                 const unsigned char *in0,
+                 const unsigned char *in1,
+                 const unsigned char *in2,
+                 const unsigned char *in3,
+                 unsigned long long inlen) {
+    keccakx4 (out0, out1, out2, out3, 64, in0, in1, in2, in3, inlen,
+              SHA3_512_RATE, 0x06);
+}
@@ -0,0 +1,174 @@
+/* Eight-way parallel SHAKE128 and SHAKE256 on top of the interleaved
+ * Keccak-f[1600] permutation in keccakf1600x8.c.
+ * Each call processes eight independent inputs of equal length;
+ * inputs and outputs are passed as arrays of eight pointers. */
+
+#include "fips202.h"
+#include "keccakf1600.h"
+#include <stdint.h>
+
+static uint64_t keccakx8_load64 (const unsigned char *x) {
+    unsigned int i;
+    uint64_t r = 0;
+
+    for (i = 0; i < 8; ++i) r |= (uint64_t)x[i] << 8 * i;
+    return r;
+}
+
+static void keccakx8_store64 (unsigned char *x, uint64_t u) {
+    unsigned int i;
+
+    for (i = 0; i < 8; ++i) {
+        x[i] = u;
+        u >>= 8;
+    }
+}
+
+/*************************************************
+ * Name:        keccakx8_absorb
+ *
+ * Description: Absorb step of eight parallel Keccak instances;
+ *              non-incremental, starts by zeroeing the state.
+ *
+ * Arguments:   - uint64_t *s:                 pointer to output interleaved state (8 * 25 words)
+ *              - unsigned int r:              rate in bytes (e.g., 168 for SHAKE128)
+ *              - const unsigned char *in[8]:  pointers to the eight inputs
+ *              - unsigned long long inlen:    length of each input in bytes
+ *              - unsigned char p:             domain-separation byte
+ **************************************************/
+static void keccakx8_absorb (uint64_t *s,
+                             unsigned int r,
+                             const unsigned char *in[8],
+                             unsigned long long inlen,
+                             unsigned char p) {
+    unsigned long long i, off = 0;
+    unsigned int j, k;
+
+    for (i = 0; i < 8 * 25; i++) s[i] = 0;
+
+    while (inlen >= r) {
+        for (j = 0; j < r / 8; j++)
+            for (k = 0; k < 8; k++)
+                s[8 * j + k] ^= keccakx8_load64 (in[k] + off + 8 * j);
+        KeccakF1600x8_StatePermute (s);
+        off += r;
+        inlen -= r;
+    }
+
+    for (i = 0; i < inlen; i++)
+        for (k = 0; k < 8; k++)
+            s[8 * (i / 8) + k] ^= (uint64_t)in[k][off + i] << 8 * (i % 8);
+
+    for (k = 0; k < 8; k++) {
+        s[8 * (i / 8) + k] ^= (uint64_t)p << 8 * (i % 8);
+        s[8 * ((r - 1) / 8) + k] ^= 1ULL << 63;
+    }
+}
+
+/*************************************************
+ * Name:        keccakx8_squeezeblocks
+ *
+ * Description: Squeeze step of eight parallel Keccak instances.
+ *              Squeezes full blocks of r bytes each into every output.
+ *              Modifies the state. Can be called multiple times to keep
+ *              squeezing, i.e., is incremental.
+ *
+ * Arguments:   - unsigned char *out[8]:      pointers to the eight outputs
+ *              - unsigned long long nblocks: number of blocks to be squeezed
+ *              - uint64_t *s:                pointer to in/output interleaved state
+ *              - unsigned int r:             rate in bytes
+ **************************************************/
+static void keccakx8_squeezeblocks (unsigned char *out[8],
+                                    unsigned long long nblocks,
+                                    uint64_t *s,
+                                    unsigned int r) {
+    unsigned long long off = 0;
+    unsigned int j, k;
+
+    while (nblocks > 0) {
+        KeccakF1600x8_StatePermute (s);
+        for (j = 0; j < r / 8; j++)
+            for (k = 0; k < 8; k++)
+                keccakx8_store64 (out[k] + off + 8 * j, s[8 * j + k]);
+        off += r;
+        nblocks--;
+    }
+}
+
+/*************************************************
+ * Name:        keccakx8
+ *
+ * Description: Eight parallel Keccak XOFs with non-incremental API
+ *
+ * Arguments:   - unsigned char *out[8]:      pointers to the eight outputs
+ *              - unsigned long long outlen:  requested output length in bytes
+ *              - const unsigned char *in[8]: pointers to the eight inputs
+ *              - unsigned long long inlen:   length of each input in bytes
+ *              - unsigned int r:             rate in bytes
+ *              - unsigned char p:            domain-separation byte
+ **************************************************/
+static void keccakx8 (unsigned char *out[8],
+                      unsigned long long outlen,
+                      const unsigned char *in[8],
+                      unsigned long long inlen,
+                      unsigned int r,
+                      unsigned char p) {
+    uint64_t s[8 * 25];
+    unsigned char t[8][SHAKE128_RATE];
+    unsigned char *tp[8];
+    unsigned long long nblocks = outlen / r;
+    unsigned long long i;
+    unsigned int k;
+
+    keccakx8_absorb (s, r, in, inlen, p);
+    keccakx8_squeezeblocks (out, nblocks, s, r);
+
+    outlen -= nblocks * r;
+
+    if (outlen) {
+        for (k = 0; k < 8; k++) tp[k] = t[k];
+        keccakx8_squeezeblocks (tp, 1, s, r);
+        for (k = 0; k < 8; k++)
+            for (i = 0; i < outlen; i++) out[k][nblocks * r + i] = t[k][i];
+    }
+}
+
+/*************************************************
+ * Name:        shake128x8_absorb
+ *
+ * Description: Absorb step of eight parallel SHAKE128 XOFs;
+ *              non-incremental, starts by zeroeing the state.
+ *
+ * Arguments:   - uint64_t *s:                pointer to output interleaved state (8 * 25 words)
+ *              - const unsigned char *in[8]: pointers to the eight inputs
+ *              - unsigned int inlen:         length of each input in bytes
+ **************************************************/
+void shake128x8_absorb (uint64_t *s, const unsigned char *in[8], unsigned int inlen) {
+    keccakx8_absorb (s, SHAKE128_RATE, in, inlen, 0x1F);
+}
+
+void shake128x8_squeezeblocks (unsigned char *out[8], unsigned long long nblocks, uint64_t *s) {
+    keccakx8_squeezeblocks (out, nblocks, s, SHAKE128_RATE);
+}
+
+void shake128x8 (unsigned char *out[8],
+                 unsigned long long outlen,
+                 const unsigned char *in[8],
+                 unsigned long long inlen) {
+    keccakx8 (out, outlen, in, inlen, SHAKE128_RATE, 0x1F);
+}
+
+void shake256x8_absorb (uint64_t *s, const unsigned char *in[8], unsigned int inlen) {
+    keccakx8_absorb (s, SHAKE256_RATE, in, inlen, 0x1F);
+}
+
+void shake256x8_squeezeblocks (unsigned char *out[8], unsigned long long nblocks, uint64_t *s) {
+    keccakx8_squeezeblocks (out, nblocks, s, SHAKE256_RATE);
+}
+
+void shake256x8 (unsigned char *out[8],
+                 unsigned long long outlen,
+                 const unsigned char *in[8],
+                 unsigned long long inlen) {
+    keccakx8 (out, outlen, in, inlen, SHAKE256_RATE, 0x1F);
+}
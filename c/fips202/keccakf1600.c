@@ -12,7 +12,7 @@
 #define NROUNDS 24
 #define ROL(a, offset) ((a << offset) ^ (a >> (64 - offset)))
 
-static const uint64_t KeccakF_RoundConstants[NROUNDS] = {
+const uint64_t KeccakF_RoundConstants[NROUNDS] = {
     (uint64_t)0x0000000000000001ULL, (uint64_t)0x0000000000008082ULL,
     (uint64_t)0x800000000000808aULL, (uint64_t)0x8000000080008000ULL,
     (uint64_t)0x000000000000808bULL, (uint64_t)0x0000000080000001ULL,
@@ -45,27 +45,27 @@ static void store64 (uint8_t *x, uint64_t u) {
     }
 }
 
-void KeccakF1600_StateExtractBytes (uint64_t *state,
-                                    unsigned char *data,
-                                    unsigned int __attribute__ ((unused)) offset,
-                                    unsigned int length) {
+void KeccakF1600_StateExtractBytes_ref (uint64_t *state,
+                                        unsigned char *data,
+                                        unsigned int __attribute__ ((unused)) offset,
+                                        unsigned int length) {
     unsigned int i;
     for (i = 0; i < (length >> 3); i++) {
         store64 (data + 8 * i, state[i]);
     }
 }
 
-void KeccakF1600_StateXORBytes (uint64_t *state,
-                                const unsigned char *data,
-                                unsigned int __attribute__ ((unused)) offset,
-                                unsigned int length) {
+void KeccakF1600_StateXORBytes_ref (uint64_t *state,
+                                    const unsigned char *data,
+                                    unsigned int __attribute__ ((unused)) offset,
+                                    unsigned int length) {
     unsigned int i;
     for (i = 0; i < length / 8; ++i) {
         state[i] ^= load64 (data + 8 * i);
     }
 }
 
-void KeccakF1600_StatePermute (uint64_t *state) {
+void KeccakF1600_StatePermute_ref (uint64_t *state) {
     int round;
 
     uint64_t Aba, Abe, Abi, Abo, Abu;
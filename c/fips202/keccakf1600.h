@@ -13,4 +13,39 @@ void KeccakF1600_StateXORBytes (uint64_t *state,
                                 unsigned int length);
 void KeccakF1600_StatePermute (uint64_t *state);
 
+/* Four states interleaved word by word: lane i of instance j is state[4 * i + j] */
+void KeccakF1600x4_StatePermute (uint64_t *state);
+
+/* Eight states in the same layout: lane i of instance j is state[8 * i + j] */
+void KeccakF1600x8_StatePermute (uint64_t *state);
+
+extern const uint64_t KeccakF_RoundConstants[24];
+
+/* Backend kernels; the unsuffixed functions above dispatch to one of these
+ * through pqgo_dispatch (see c/dispatch/dispatch.h) */
+void KeccakF1600_StateExtractBytes_ref (uint64_t *state,
+                                        unsigned char *data,
+                                        unsigned int offset,
+                                        unsigned int length);
+void KeccakF1600_StateXORBytes_ref (uint64_t *state,
+                                    const unsigned char *data,
+                                    unsigned int offset,
+                                    unsigned int length);
+void KeccakF1600_StatePermute_ref (uint64_t *state);
+void KeccakF1600_StateExtractBytes_opt (uint64_t *state,
+                                        unsigned char *data,
+                                        unsigned int offset,
+                                        unsigned int length);
+void KeccakF1600_StateXORBytes_opt (uint64_t *state,
+                                    const unsigned char *data,
+                                    unsigned int offset,
+                                    unsigned int length);
+void KeccakF1600_StatePermute_opt (uint64_t *state);
+void KeccakF1600x4_StatePermute_ref (uint64_t *state);
+void KeccakF1600x8_StatePermute_ref (uint64_t *state);
+#if defined(__x86_64__)
+void KeccakF1600x4_StatePermute_avx2 (uint64_t *state);
+void KeccakF1600x8_StatePermute_avx512 (uint64_t *state);
+#endif
+
 #endif
@@ -0,0 +1,323 @@
+/* 8-way interleaved Keccak-f[1600].
+ * Same structure as keccakf1600x4.c with 512-bit registers; the state of
+ * instance j is held in state[8 * i + j] for lanes i = 0..24. The AVX-512
+ * kernel uses native rotates and ternary logic for theta and chi. */
+
+#include "keccakf1600.h"
+#include <stdint.h>
+
+#if defined(__x86_64__)
+#define KECCAKX8_AVX512
+#include <immintrin.h>
+#endif
+
+#ifdef KECCAKX8_AVX512
+
+#define XOR(a, b) _mm512_xor_si512 (a, b)
+#define XOR5(a, b, c, d, e)                                                    \
+    _mm512_ternarylogic_epi64 (_mm512_ternarylogic_epi64 (a, b, c, 0x96), d, e, 0x96)
+#define CHI(a, b, c) _mm512_ternarylogic_epi64 (a, b, c, 0xD2) /* a ^ (~b & c) */
+#define ROL64(a, offset) _mm512_rol_epi64 (a, offset)
+#define RC(i) _mm512_set1_epi64 ((long long)KeccakF_RoundConstants[i])
+
+/*************************************************
+ * Name:        KeccakF1600x8_StatePermute_avx512
+ *
+ * Description: Applies Keccak-f[1600] to eight interleaved states at once.
+ *
+ * Arguments:   - uint64_t *state: pointer to in/output interleaved states
+ *                                 (8 * 25 words)
+ **************************************************/
+__attribute__ ((target ("avx512f"))) void
+KeccakF1600x8_StatePermute_avx512 (uint64_t *state) {
+    int round;
+
+    __m512i Aba, Abe, Abi, Abo, Abu;
+    __m512i Aga, Age, Agi, Ago, Agu;
+    __m512i Aka, Ake, Aki, Ako, Aku;
+    __m512i Ama, Ame, Ami, Amo, Amu;
+    __m512i Asa, Ase, Asi, Aso, Asu;
+    __m512i BCa, BCe, BCi, BCo, BCu;
+    __m512i Da, De, Di, Do, Du;
+    __m512i Eba, Ebe, Ebi, Ebo, Ebu;
+    __m512i Ega, Ege, Egi, Ego, Egu;
+    __m512i Eka, Eke, Eki, Eko, Eku;
+    __m512i Ema, Eme, Emi, Emo, Emu;
+    __m512i Esa, Ese, Esi, Eso, Esu;
+
+    // copyFromState(A, state)
+    Aba = _mm512_loadu_si512 ((const void *)(state + 8 * 0));
+    Abe = _mm512_loadu_si512 ((const void *)(state + 8 * 1));
+    Abi = _mm512_loadu_si512 ((const void *)(state + 8 * 2));
+    Abo = _mm512_loadu_si512 ((const void *)(state + 8 * 3));
+    Abu = _mm512_loadu_si512 ((const void *)(state + 8 * 4));
+    Aga = _mm512_loadu_si512 ((const void *)(state + 8 * 5));
+    Age = _mm512_loadu_si512 ((const void *)(state + 8 * 6));
+    Agi = _mm512_loadu_si512 ((const void *)(state + 8 * 7));
+    Ago = _mm512_loadu_si512 ((const void *)(state + 8 * 8));
+    Agu = _mm512_loadu_si512 ((const void *)(state + 8 * 9));
+    Aka = _mm512_loadu_si512 ((const void *)(state + 8 * 10));
+    Ake = _mm512_loadu_si512 ((const void *)(state + 8 * 11));
+    Aki = _mm512_loadu_si512 ((const void *)(state + 8 * 12));
+    Ako = _mm512_loadu_si512 ((const void *)(state + 8 * 13));
+    Aku = _mm512_loadu_si512 ((const void *)(state + 8 * 14));
+    Ama = _mm512_loadu_si512 ((const void *)(state + 8 * 15));
+    Ame = _mm512_loadu_si512 ((const void *)(state + 8 * 16));
+    Ami = _mm512_loadu_si512 ((const void *)(state + 8 * 17));
+    Amo = _mm512_loadu_si512 ((const void *)(state + 8 * 18));
+    Amu = _mm512_loadu_si512 ((const void *)(state + 8 * 19));
+    Asa = _mm512_loadu_si512 ((const void *)(state + 8 * 20));
+    Ase = _mm512_loadu_si512 ((const void *)(state + 8 * 21));
+    Asi = _mm512_loadu_si512 ((const void *)(state + 8 * 22));
+    Aso = _mm512_loadu_si512 ((const void *)(state + 8 * 23));
+    Asu = _mm512_loadu_si512 ((const void *)(state + 8 * 24));
+
+    for (round = 0; round < NROUNDS; round += 2) {
+        //    prepareTheta
+        BCa = XOR5 (Aba, Aga, Aka, Ama, Asa);
+        BCe = XOR5 (Abe, Age, Ake, Ame, Ase);
+        BCi = XOR5 (Abi, Agi, Aki, Ami, Asi);
+        BCo = XOR5 (Abo, Ago, Ako, Amo, Aso);
+        BCu = XOR5 (Abu, Agu, Aku, Amu, Asu);
+
+        // thetaRhoPiChiIotaPrepareTheta(round  , A, E)
+        Da = XOR (BCu, ROL64 (BCe, 1));
+        De = XOR (BCa, ROL64 (BCi, 1));
+        Di = XOR (BCe, ROL64 (BCo, 1));
+        Do = XOR (BCi, ROL64 (BCu, 1));
+        Du = XOR (BCo, ROL64 (BCa, 1));
+
+        Aba = XOR (Aba, Da);
+        BCa = Aba;
+        Age = XOR (Age, De);
+        BCe = ROL64 (Age, 44);
+        Aki = XOR (Aki, Di);
+        BCi = ROL64 (Aki, 43);
+        Amo = XOR (Amo, Do);
+        BCo = ROL64 (Amo, 21);
+        Asu = XOR (Asu, Du);
+        BCu = ROL64 (Asu, 14);
+        Eba = CHI (BCa, BCe, BCi);
+        Eba = XOR (Eba, RC (round));
+        Ebe = CHI (BCe, BCi, BCo);
+        Ebi = CHI (BCi, BCo, BCu);
+        Ebo = CHI (BCo, BCu, BCa);
+        Ebu = CHI (BCu, BCa, BCe);
+
+        Abo = XOR (Abo, Do);
+        BCa = ROL64 (Abo, 28);
+        Agu = XOR (Agu, Du);
+        BCe = ROL64 (Agu, 20);
+        Aka = XOR (Aka, Da);
+        BCi = ROL64 (Aka, 3);
+        Ame = XOR (Ame, De);
+        BCo = ROL64 (Ame, 45);
+        Asi = XOR (Asi, Di);
+        BCu = ROL64 (Asi, 61);
+        Ega = CHI (BCa, BCe, BCi);
+        Ege = CHI (BCe, BCi, BCo);
+        Egi = CHI (BCi, BCo, BCu);
+        Ego = CHI (BCo, BCu, BCa);
+        Egu = CHI (BCu, BCa, BCe);
+
+        Abe = XOR (Abe, De);
+        BCa = ROL64 (Abe, 1);
+        Agi = XOR (Agi, Di);
+        BCe = ROL64 (Agi, 6);
+        Ako = XOR (Ako, Do);
+        BCi = ROL64 (Ako, 25);
+        Amu = XOR (Amu, Du);
+        BCo = ROL64 (Amu, 8);
+        Asa = XOR (Asa, Da);
+        BCu = ROL64 (Asa, 18);
+        Eka = CHI (BCa, BCe, BCi);
+        Eke = CHI (BCe, BCi, BCo);
+        Eki = CHI (BCi, BCo, BCu);
+        Eko = CHI (BCo, BCu, BCa);
+        Eku = CHI (BCu, BCa, BCe);
+
+        Abu = XOR (Abu, Du);
+        BCa = ROL64 (Abu, 27);
+        Aga = XOR (Aga, Da);
+        BCe = ROL64 (Aga, 36);
+        Ake = XOR (Ake, De);
+        BCi = ROL64 (Ake, 10);
+        Ami = XOR (Ami, Di);
+        BCo = ROL64 (Ami, 15);
+        Aso = XOR (Aso, Do);
+        BCu = ROL64 (Aso, 56);
+        Ema = CHI (BCa, BCe, BCi);
+        Eme = CHI (BCe, BCi, BCo);
+        Emi = CHI (BCi, BCo, BCu);
+        Emo = CHI (BCo, BCu, BCa);
+        Emu = CHI (BCu, BCa, BCe);
+
+        Abi = XOR (Abi, Di);
+        BCa = ROL64 (Abi, 62);
+        Ago = XOR (Ago, Do);
+        BCe = ROL64 (Ago, 55);
+        Aku = XOR (Aku, Du);
+        BCi = ROL64 (Aku, 39);
+        Ama = XOR (Ama, Da);
+        BCo = ROL64 (Ama, 41);
+        Ase = XOR (Ase, De);
+        BCu = ROL64 (Ase, 2);
+        Esa = CHI (BCa, BCe, BCi);
+        Ese = CHI (BCe, BCi, BCo);
+        Esi = CHI (BCi, BCo, BCu);
+        Eso = CHI (BCo, BCu, BCa);
+        Esu = CHI (BCu, BCa, BCe);
+
+        //    prepareTheta
+        BCa = XOR5 (Eba, Ega, Eka, Ema, Esa);
+        BCe = XOR5 (Ebe, Ege, Eke, Eme, Ese);
+        BCi = XOR5 (Ebi, Egi, Eki, Emi, Esi);
+        BCo = XOR5 (Ebo, Ego, Eko, Emo, Eso);
+        BCu = XOR5 (Ebu, Egu, Eku, Emu, Esu);
+
+        // thetaRhoPiChiIotaPrepareTheta(round+1, E, A)
+        Da = XOR (BCu, ROL64 (BCe, 1));
+        De = XOR (BCa, ROL64 (BCi, 1));
+        Di = XOR (BCe, ROL64 (BCo, 1));
+        Do = XOR (BCi, ROL64 (BCu, 1));
+        Du = XOR (BCo, ROL64 (BCa, 1));
+
+        Eba = XOR (Eba, Da);
+        BCa = Eba;
+        Ege = XOR (Ege, De);
+        BCe = ROL64 (Ege, 44);
+        Eki = XOR (Eki, Di);
+        BCi = ROL64 (Eki, 43);
+        Emo = XOR (Emo, Do);
+        BCo = ROL64 (Emo, 21);
+        Esu = XOR (Esu, Du);
+        BCu = ROL64 (Esu, 14);
+        Aba = CHI (BCa, BCe, BCi);
+        Aba = XOR (Aba, RC (round + 1));
+        Abe = CHI (BCe, BCi, BCo);
+        Abi = CHI (BCi, BCo, BCu);
+        Abo = CHI (BCo, BCu, BCa);
+        Abu = CHI (BCu, BCa, BCe);
+
+        Ebo = XOR (Ebo, Do);
+        BCa = ROL64 (Ebo, 28);
+        Egu = XOR (Egu, Du);
+        BCe = ROL64 (Egu, 20);
+        Eka = XOR (Eka, Da);
+        BCi = ROL64 (Eka, 3);
+        Eme = XOR (Eme, De);
+        BCo = ROL64 (Eme, 45);
+        Esi = XOR (Esi, Di);
+        BCu = ROL64 (Esi, 61);
+        Aga = CHI (BCa, BCe, BCi);
+        Age = CHI (BCe, BCi, BCo);
+        Agi = CHI (BCi, BCo, BCu);
+        Ago = CHI (BCo, BCu, BCa);
+        Agu = CHI (BCu, BCa, BCe);
+
+        Ebe = XOR (Ebe, De);
+        BCa = ROL64 (Ebe, 1);
+        Egi = XOR (Egi, Di);
+        BCe = ROL64 (Egi, 6);
+        Eko = XOR (Eko, Do);
+        BCi = ROL64 (Eko, 25);
+        Emu = XOR (Emu, Du);
+        BCo = ROL64 (Emu, 8);
+        Esa = XOR (Esa, Da);
+        BCu = ROL64 (Esa, 18);
+        Aka = CHI (BCa, BCe, BCi);
+        Ake = CHI (BCe, BCi, BCo);
+        Aki = CHI (BCi, BCo, BCu);
+        Ako = CHI (BCo, BCu, BCa);
+        Aku = CHI (BCu, BCa, BCe);
+
+        Ebu = XOR (Ebu, Du);
+        BCa = ROL64 (Ebu, 27);
+        Ega = XOR (Ega, Da);
+        BCe = ROL64 (Ega, 36);
+        Eke = XOR (Eke, De);
+        BCi = ROL64 (Eke, 10);
+        Emi = XOR (Emi, Di);
+        BCo = ROL64 (Emi, 15);
+        Eso = XOR (Eso, Do);
+        BCu = ROL64 (Eso, 56);
+        Ama = CHI (BCa, BCe, BCi);
+        Ame = CHI (BCe, BCi, BCo);
+        Ami = CHI (BCi, BCo, BCu);
+        Amo = CHI (BCo, BCu, BCa);
+        Amu = CHI (BCu, BCa, BCe);
+
+        Ebi = XOR (Ebi, Di);
+        BCa = ROL64 (Ebi, 62);
+        Ego = XOR (Ego, Do);
+        BCe = ROL64 (Ego, 55);
+        Eku = XOR (Eku, Du);
+        BCi = ROL64 (Eku, 39);
+        Ema = XOR (Ema, Da);
+        BCo = ROL64 (Ema, 41);
+        Ese = XOR (Ese, De);
+        BCu = ROL64 (Ese, 2);
+        Asa = CHI (BCa, BCe, BCi);
+        Ase = CHI (BCe, BCi, BCo);
+        Asi = CHI (BCi, BCo, BCu);
+        Aso = CHI (BCo, BCu, BCa);
+        Asu = CHI (BCu, BCa, BCe);
+    }
+
+    // copyToState(state, A)
+    _mm512_storeu_si512 ((void *)(state + 8 * 0), Aba);
+    _mm512_storeu_si512 ((void *)(state + 8 * 1), Abe);
+    _mm512_storeu_si512 ((void *)(state + 8 * 2), Abi);
+    _mm512_storeu_si512 ((void *)(state + 8 * 3), Abo);
+    _mm512_storeu_si512 ((void *)(state + 8 * 4), Abu);
+    _mm512_storeu_si512 ((void *)(state + 8 * 5), Aga);
+    _mm512_storeu_si512 ((void *)(state + 8 * 6), Age);
+    _mm512_storeu_si512 ((void *)(state + 8 * 7), Agi);
+    _mm512_storeu_si512 ((void *)(state + 8 * 8), Ago);
+    _mm512_storeu_si512 ((void *)(state + 8 * 9), Agu);
+    _mm512_storeu_si512 ((void *)(state + 8 * 10), Aka);
+    _mm512_storeu_si512 ((void *)(state + 8 * 11), Ake);
+    _mm512_storeu_si512 ((void *)(state + 8 * 12), Aki);
+    _mm512_storeu_si512 ((void *)(state + 8 * 13), Ako);
+    _mm512_storeu_si512 ((void *)(state + 8 * 14), Aku);
+    _mm512_storeu_si512 ((void *)(state + 8 * 15), Ama);
+    _mm512_storeu_si512 ((void *)(state + 8 * 16), Ame);
+    _mm512_storeu_si512 ((void *)(state + 8 * 17), Ami);
+    _mm512_storeu_si512 ((void *)(state + 8 * 18), Amo);
+    _mm512_storeu_si512 ((void *)(state + 8 * 19), Amu);
+    _mm512_storeu_si512 ((void *)(state + 8 * 20), Asa);
+    _mm512_storeu_si512 ((void *)(state + 8 * 21), Ase);
+    _mm512_storeu_si512 ((void *)(state + 8 * 22), Asi);
+    _mm512_storeu_si512 ((void *)(state + 8 * 23), Aso);
+    _mm512_storeu_si512 ((void *)(state + 8 * 24), Asu);
+}
+
+#undef XOR
+#undef XOR5
+#undef CHI
+#undef ROL64
+#undef RC
+
+#endif /* KECCAKX8_AVX512 */
+
+/*************************************************
+ * Name:        KeccakF1600x8_StatePermute_ref
+ *
+ * Description: Fallback for hosts without AVX-512; splits the eight
+ *              interleaved states into two 4-way states.
+ *
+ * Arguments:   - uint64_t *state: pointer to in/output interleaved states
+ **************************************************/
+void KeccakF1600x8_StatePermute_ref (uint64_t *state) {
+    uint64_t t[2][4 * 25];
+    unsigned int i, j;
+
+    for (i = 0; i < 25; i++)
+        for (j = 0; j < 8; j++) t[j >> 2][4 * i + (j & 3)] = state[8 * i + j];
+
+    KeccakF1600x4_StatePermute (t[0]);
+    KeccakF1600x4_StatePermute (t[1]);
+
+    for (i = 0; i < 25; i++)
+        for (j = 0; j < 8; j++) state[8 * i + j] = t[j >> 2][4 * i + (j & 3)];
+}
@@ -0,0 +1,352 @@
+/* Multi-buffer hashing: jobs submitted from different threads are grouped
+ * by hash kind and number of full input blocks, and absorbed/squeezed
+ * together on the 4-way or 8-way interleaved permutation.
+ * There is no worker thread: the submitter that completes a batch hashes
+ * it, and a waiter whose batch reaches its deadline flushes it partially
+ * filled. The tails of the inputs and the output lengths may differ
+ * within a batch. */
+
+#include "mbhash.h"
+#include "fips202.h"
+#include "keccakf1600.h"
+#include <errno.h>
+#include <stdint.h>
+
+struct mbhash_job {
+    const unsigned char *in;
+    unsigned long long inlen;
+    unsigned char *out;
+    unsigned long long outlen;
+    mbhash_queue *queue; /* open batch holding the job, NULL once taken */
+    int done;
+};
+
+static int mbhash_params (int kind, unsigned int *r, unsigned char *p) {
+    switch (kind) {
+    case MBHASH_SHAKE128:
+        *r = SHAKE128_RATE;
+        *p = 0x1F;
+        return 0;
+    case MBHASH_SHAKE256:
+        *r = SHAKE256_RATE;
+        *p = 0x1F;
+        return 0;
+    case MBHASH_SHA3_256:
+        *r = SHA3_256_RATE;
+        *p = 0x06;
+        return 0;
+    case MBHASH_SHA3_512:
+        *r = SHA3_512_RATE;
+        *p = 0x06;
+        return 0;
+    }
+    return -1;
+}
+
+static void mbhash_one (int kind,
+                        unsigned char *out,
+                        unsigned long long outlen,
+                        const unsigned char *in,
+                        unsigned long long inlen) {
+    switch (kind) {
+    case MBHASH_SHAKE128: shake128 (out, outlen, in, inlen); break;
+    case MBHASH_SHAKE256: shake256 (out, outlen, in, inlen); break;
+    case MBHASH_SHA3_256: sha3_256 (out, in, inlen); break;
+    case MBHASH_SHA3_512: sha3_512 (out, in, inlen); break;
+    }
+}
+
+static uint64_t mbhash_load64 (const unsigned char *x) {
+    unsigned int i;
+    uint64_t r = 0;
+
+    for (i = 0; i < 8; ++i) r |= (uint64_t)x[i] << 8 * i;
+    return r;
+}
+
+static void mbhash_permute (uint64_t *s, unsigned int lanes) {
+    if (lanes == 8)
+        KeccakF1600x8_StatePermute (s);
+    else
+        KeccakF1600x4_StatePermute (s);
+}
+
+/*************************************************
+ * Name:        mbhash_run
+ *
+ * Description: Hashes a batch on the interleaved permutation; unused
+ *              lanes carry a zero state. All inputs have the same number
+ *              of full rate blocks.
+ *
+ * Arguments:   - int kind:           hash kind (MBHASH_*)
+ *              - unsigned int lanes: width of the permutation, 4 or 8
+ *              - mbhash_job **jobs:  jobs of the batch
+ *              - unsigned int n:     number of jobs, at most lanes
+ **************************************************/
+static void mbhash_run (int kind, unsigned int lanes, mbhash_job **jobs, unsigned int n) {
+    uint64_t s[8 * 25];
+    unsigned long long b, nblocks, off, outlen = 0;
+    unsigned int r, i, j, k;
+    unsigned char p;
+
+    if (mbhash_params (kind, &r, &p)) return; /* kinds are checked by mbhash_submit */
+    nblocks = jobs[0]->inlen / r;
+
+    for (i = 0; i < lanes * 25; i++) s[i] = 0;
+
+    for (b = 0; b < nblocks; b++) {
+        for (k = 0; k < n; k++)
+            for (j = 0; j < r / 8; j++)
+                s[lanes * j + k] ^= mbhash_load64 (jobs[k]->in + b * r + 8 * j);
+        mbhash_permute (s, lanes);
+    }
+
+    off = nblocks * r;
+    for (k = 0; k < n; k++) {
+        for (i = 0; i < jobs[k]->inlen - off; i++)
+            s[lanes * (i / 8) + k] ^= (uint64_t)jobs[k]->in[off + i] << 8 * (i % 8);
+        s[lanes * (i / 8) + k] ^= (uint64_t)p << 8 * (i % 8);
+        s[lanes * ((r - 1) / 8) + k] ^= 1ULL << 63;
+
+        if (jobs[k]->outlen > outlen) outlen = jobs[k]->outlen;
+    }
+
+    for (off = 0; off < outlen; off += r) {
+        mbhash_permute (s, lanes);
+        for (k = 0; k < n; k++)
+            for (i = 0; i < r && off + i < jobs[k]->outlen; i++)
+                jobs[k]->out[off + i] = s[lanes * (i / 8) + k] >> 8 * (i % 8);
+    }
+}
+
+/* Opens or joins the batch for (kind, nblocks); NULL if all slots are busy */
+static mbhash_queue *mbhash_find_queue (mbhash_sched *sched, int kind, unsigned long long nblocks) {
+    mbhash_queue *q, *free = NULL;
+    unsigned int i;
+
+    for (i = 0; i < MBHASH_QUEUES; i++) {
+        q = &sched->queues[i];
+        if (q->n == 0) {
+            if (free == NULL) free = q;
+        } else if (q->kind == kind && q->nblocks == nblocks) {
+            return q;
+        }
+    }
+
+    if (free != NULL) {
+        free->kind = kind;
+        free->nblocks = nblocks;
+        free->lanes = sched->lanes;
+        clock_gettime (CLOCK_MONOTONIC, &free->deadline);
+        free->deadline.tv_nsec += sched->deadline_ns;
+        free->deadline.tv_sec += free->deadline.tv_nsec / 1000000000L;
+        free->deadline.tv_nsec %= 1000000000L;
+    }
+    return free;
+}
+
+/* Removes the jobs of q from the queue (lock held); returns their number */
+static unsigned int mbhash_take (mbhash_sched *sched, mbhash_queue *q, mbhash_job **batch) {
+    unsigned int i, n = q->n;
+
+    for (i = 0; i < n; i++) {
+        batch[i] = q->jobs[i];
+        batch[i]->queue = NULL;
+    }
+
+    sched->stats.batches++;
+    if (n == q->lanes)
+        sched->stats.full_batches++;
+    else
+        sched->stats.deadline_batches++;
+    sched->stats.lanes_used += n;
+    sched->stats.lanes_total += q->lanes;
+
+    q->n = 0;
+    return n;
+}
+
+/*************************************************
+ * Name:        mbhash_init
+ *
+ * Description: Initializes a scheduler.
+ *
+ * Arguments:   - mbhash_sched *sched: pointer to (uninitialized) scheduler
+ *              - unsigned int lanes:  batch width, 4 or 8
+ *              - long deadline_ns:    longest time a job waits for its
+ *                                     batch to fill, in nanoseconds
+ *
+ * Returns 0 on success, -1 on invalid parameters.
+ **************************************************/
+int mbhash_init (mbhash_sched *sched, unsigned int lanes, long deadline_ns) {
+    pthread_condattr_t attr;
+    unsigned int i;
+
+    if ((lanes != 4 && lanes != 8) || deadline_ns < 0 || deadline_ns >= 1000000000L)
+        return -1;
+
+    pthread_mutex_init (&sched->lock, NULL);
+    pthread_condattr_init (&attr);
+    pthread_condattr_setclock (&attr, CLOCK_MONOTONIC);
+    pthread_cond_init (&sched->cond, &attr);
+    pthread_condattr_destroy (&attr);
+
+    sched->enabled = 1;
+    sched->lanes = lanes;
+    sched->deadline_ns = deadline_ns;
+    for (i = 0; i < MBHASH_QUEUES; i++) sched->queues[i].n = 0;
+    sched->stats = (mbhash_stats){ 0 };
+    return 0;
+}
+
+void mbhash_destroy (mbhash_sched *sched) {
+    pthread_cond_destroy (&sched->cond);
+    pthread_mutex_destroy (&sched->lock);
+}
+
+/*************************************************
+ * Name:        mbhash_submit
+ *
+ * Description: Hashes one input, batched with concurrent submissions of
+ *              the same kind and block count. Blocks until the output is
+ *              written, i.e., for at most the deadline plus the time to
+ *              hash the batch. For SHA3 kinds outlen must be the digest
+ *              length.
+ *
+ * Arguments:   - mbhash_sched *sched:       pointer to scheduler
+ *              - int kind:                  hash kind (MBHASH_*)
+ *              - unsigned char *out:        pointer to output
+ *              - unsigned long long outlen: output length in bytes
+ *              - const unsigned char *in:   pointer to input
+ *              - unsigned long long inlen:  input length in bytes
+ *
+ * Returns 0 on success, -1 on unknown kind.
+ **************************************************/
+int mbhash_submit (mbhash_sched *sched,
+                   int kind,
+                   unsigned char *out,
+                   unsigned long long outlen,
+                   const unsigned char *in,
+                   unsigned long long inlen) {
+    mbhash_job job, *batch[8];
+    mbhash_queue *q = NULL;
+    unsigned int r, i, n, lanes;
+    unsigned char p;
+    int timedout = 0;
+
+    if (mbhash_params (kind, &r, &p)) return -1;
+
+    job.in = in;
+    job.inlen = inlen;
+    job.out = out;
+    job.outlen = outlen;
+    job.done = 0;
+
+    pthread_mutex_lock (&sched->lock);
+    sched->stats.jobs++;
+
+    if (sched->enabled) q = mbhash_find_queue (sched, kind, inlen / r);
+    if (q == NULL) {
+        sched->stats.solo_jobs++;
+        pthread_mutex_unlock (&sched->lock);
+        mbhash_one (kind, out, outlen, in, inlen);
+        return 0;
+    }
+
+    job.queue = q;
+    q->jobs[q->n++] = &job;
+
+    while (!job.done) {
+        if (job.queue != NULL && (q->n == q->lanes || timedout)) {
+            lanes = q->lanes;
+            n = mbhash_take (sched, q, batch);
+            pthread_mutex_unlock (&sched->lock);
+
+            mbhash_run (kind, lanes, batch, n);
+
+            pthread_mutex_lock (&sched->lock);
+            for (i = 0; i < n; i++) batch[i]->done = 1;
+            pthread_cond_broadcast (&sched->cond);
+            break;
+        }
+
+        if (job.queue != NULL)
+            timedout = pthread_cond_timedwait (&sched->cond, &sched->lock, &q->deadline) == ETIMEDOUT;
+        else
+            pthread_cond_wait (&sched->cond, &sched->lock);
+    }
+
+    pthread_mutex_unlock (&sched->lock);
+    return 0;
+}
+
+void mbhash_get_stats (mbhash_sched *sched, mbhash_stats *stats) {
+    pthread_mutex_lock (&sched->lock);
+    *stats = sched->stats;
+    pthread_mutex_unlock (&sched->lock);
+}
+
+/********** Process-wide scheduler ***********/
+
+static mbhash_sched mbhash_global;
+static pthread_once_t mbhash_global_once = PTHREAD_ONCE_INIT;
+
+static void mbhash_global_init (void) {
+    mbhash_init (&mbhash_global, 4, 0);
+    mbhash_global.enabled = 0;
+}
+
+/*************************************************
+ * Name:        mbhash_enable
+ *
+ * Description: Enables or reconfigures the process-wide scheduler.
+ *              Batches already open keep their width and deadline.
+ *
+ * Arguments:   - unsigned int lanes: batch width, 4 or 8
+ *              - long deadline_ns:   longest wait for a batch to fill
+ *
+ * Returns 0 on success, -1 on invalid parameters.
+ **************************************************/
+int mbhash_enable (unsigned int lanes, long deadline_ns) {
+    if ((lanes != 4 && lanes != 8) || deadline_ns < 0 || deadline_ns >= 1000000000L)
+        return -1;
+
+    pthread_once (&mbhash_global_once, mbhash_global_init);
+    pthread_mutex_lock (&mbhash_global.lock);
+    mbhash_global.lanes = lanes;
+    mbhash_global.deadline_ns = deadline_ns;
+    __atomic_store_n (&mbhash_global.enabled, 1, __ATOMIC_RELEASE);
+    pthread_mutex_unlock (&mbhash_global.lock);
+    return 0;
+}
+
+/* Jobs submitted afterwards are hashed directly; open batches still
+ * complete on their deadline */
+void mbhash_disable (void) {
+    pthread_once (&mbhash_global_once, mbhash_global_init);
+    pthread_mutex_lock (&mbhash_global.lock);
+    __atomic_store_n (&mbhash_global.enabled, 0, __ATOMIC_RELEASE);
+    pthread_mutex_unlock (&mbhash_global.lock);
+}
+
+void mbhash_global_stats (mbhash_stats *stats) {
+    pthread_once (&mbhash_global_once, mbhash_global_init);
+    mbhash_get_stats (&mbhash_global, stats);
+}
+
+void mbhash_shake256 (unsigned char *output,
+                      unsigned long long outlen,
+                      const unsigned char *input,
+                      unsigned long long inlen) {
+    if (__atomic_load_n (&mbhash_global.enabled, __ATOMIC_ACQUIRE))
+        mbhash_submit (&mbhash_global, MBHASH_SHAKE256, output, outlen, input, inlen);
+    else
+        shake256 (output, outlen, input, inlen);
+}
+
+void mbhash_sha3_256 (unsigned char *output, const unsigned char *input, unsigned long long inlen) {
+    if (__atomic_load_n (&mbhash_global.enabled, __ATOMIC_ACQUIRE))
+        mbhash_submit (&mbhash_global, MBHASH_SHA3_256, output, 32, input, inlen);
+    else
+        sha3_256 (output, input, inlen);
+}
@@ -0,0 +1,73 @@
+#ifndef MBHASH_H
+#define MBHASH_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <time.h>
+
+/* Hash kinds handled by the scheduler */
+#define MBHASH_SHAKE128 0
+#define MBHASH_SHAKE256 1
+#define MBHASH_SHA3_256 2
+#define MBHASH_SHA3_512 3
+
+/* Number of batches that can be filling at the same time; a job whose
+ * (kind, block count) matches none and finds no free slot is hashed alone */
+#define MBHASH_QUEUES 8
+
+typedef struct mbhash_job mbhash_job;
+
+typedef struct {
+    int kind;
+    unsigned long long nblocks; /* full rate blocks absorbed by every lane */
+    unsigned int lanes;         /* batch width, 4 or 8 */
+    unsigned int n;             /* queued jobs, 0 if the slot is free */
+    struct timespec deadline;   /* flush time of a partial batch */
+    mbhash_job *jobs[8];
+} mbhash_queue;
+
+/* Counters since the scheduler was initialized; occupancy of the
+ * vector permutations is lanes_used / lanes_total */
+typedef struct {
+    unsigned long long jobs;
+    unsigned long long batches;
+    unsigned long long full_batches;
+    unsigned long long deadline_batches;
+    unsigned long long solo_jobs;
+    unsigned long long lanes_used;
+    unsigned long long lanes_total;
+} mbhash_stats;
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int enabled;
+    unsigned int lanes;
+    long deadline_ns;
+    mbhash_queue queues[MBHASH_QUEUES];
+    mbhash_stats stats;
+} mbhash_sched;
+
+int mbhash_init (mbhash_sched *sched, unsigned int lanes, long deadline_ns);
+void mbhash_destroy (mbhash_sched *sched);
+int mbhash_submit (mbhash_sched *sched,
+                   int kind,
+                   unsigned char *out,
+                   unsigned long long outlen,
+                   const unsigned char *in,
+                   unsigned long long inlen);
+void mbhash_get_stats (mbhash_sched *sched, mbhash_stats *stats);
+
+/* Process-wide scheduler used by the KEM and signature code; disabled
+ * unless mbhash_enable has been called */
+int mbhash_enable (unsigned int lanes, long deadline_ns);
+void mbhash_disable (void);
+void mbhash_global_stats (mbhash_stats *stats);
+
+void mbhash_shake256 (unsigned char *output,
+                      unsigned long long outlen,
+                      const unsigned char *input,
+                      unsigned long long inlen);
+void mbhash_sha3_256 (unsigned char *output, const unsigned char *input, unsigned long long inlen);
+
+#endif
@@ -0,0 +1,103 @@
+/* ParallelHash256 of NIST SP 800-185.
+ * The input is cut into leaves of blocklen bytes, each hashed with
+ * SHAKE256 to 64 bytes; full leaves are hashed four at a time on the
+ * interleaved permutation and spread over the thread pool of
+ * c/parallel. The leaf digests are absorbed in order into the root
+ * cSHAKE256 (N = "ParallelHash"), a window at a time so that memory use
+ * does not grow with the input. */
+
+#include "../parallel/parallel.h"
+#include "fips202.h"
+
+#define PARALLELHASH_LEAFBYTES 64
+#define PARALLELHASH_WINDOW 1024 /* leaves per window, multiple of 4 */
+#define PARALLELHASH_GRAIN 2     /* groups of four leaves per task */
+
+typedef struct {
+    const unsigned char *in;
+    unsigned long long blocklen;
+    unsigned char *z;
+} parallelhash_window;
+
+/* Hashes groups [begin, end) of four full leaves of a window */
+static void parallelhash_leaves (void *arg, size_t begin, size_t end) {
+    const parallelhash_window *w = arg;
+    const unsigned char *in;
+    unsigned char *z;
+    size_t g;
+
+    for (g = begin; g < end; g++) {
+        in = w->in + 4 * g * w->blocklen;
+        z = w->z + 4 * g * PARALLELHASH_LEAFBYTES;
+        shake256x4 (z, z + PARALLELHASH_LEAFBYTES, z + 2 * PARALLELHASH_LEAFBYTES,
+                    z + 3 * PARALLELHASH_LEAFBYTES, PARALLELHASH_LEAFBYTES, in,
+                    in + w->blocklen, in + 2 * w->blocklen, in + 3 * w->blocklen,
+                    w->blocklen);
+    }
+}
+
+static unsigned int parallelhash_encode (unsigned char *buf, unsigned long long x, int right) {
+    unsigned int i, n = 1;
+
+    while (n < 8 && (x >> 8 * n)) n++;
+    if (!right) *buf++ = n;
+    for (i = 0; i < n; i++) buf[i] = x >> 8 * (n - 1 - i);
+    if (right) buf[n] = n;
+    return n + 1;
+}
+
+/*************************************************
+ * Name:        parallelhash256
+ *
+ * Description: ParallelHash256 (X = in, B = blocklen, L = 8 * outlen,
+ *              S = cstm), multi-threaded.
+ *
+ * Arguments:   - unsigned char *out:          pointer to output
+ *              - unsigned long long outlen:   requested output length in bytes
+ *              - const unsigned char *in:     pointer to input
+ *              - unsigned long long inlen:    length of input in bytes
+ *              - unsigned long long blocklen: leaf size in bytes (B), non-zero
+ *              - const unsigned char *cstm:   customization string (S)
+ *              - unsigned long long cstmlen:  length of cstm in bytes
+ **************************************************/
+void parallelhash256 (unsigned char *out,
+                      unsigned long long outlen,
+                      const unsigned char *in,
+                      unsigned long long inlen,
+                      unsigned long long blocklen,
+                      const unsigned char *cstm,
+                      unsigned long long cstmlen) {
+    static const unsigned char name[12] = { 'P', 'a', 'r', 'a', 'l', 'l',
+                                            'e', 'l', 'H', 'a', 's', 'h' };
+    unsigned char z[PARALLELHASH_WINDOW * PARALLELHASH_LEAFBYTES];
+    unsigned char buf[9];
+    unsigned long long i, j, w, nfull = inlen / blocklen;
+    parallelhash_window win;
+    keccak_state root;
+
+    cshake256_inc_init (&root, name, sizeof (name), cstm, cstmlen);
+    shake256_inc_absorb (&root, buf, parallelhash_encode (buf, blocklen, 0));
+
+    win.blocklen = blocklen;
+    win.z = z;
+    for (i = 0; i < nfull; i += w) {
+        w = nfull - i < PARALLELHASH_WINDOW ? nfull - i : PARALLELHASH_WINDOW;
+        win.in = in + i * blocklen;
+        pqgo_parallel_for (w / 4, PARALLELHASH_GRAIN, parallelhash_leaves, &win);
+        for (j = w & ~3ULL; j < w; j++)
+            shake256 (z + j * PARALLELHASH_LEAFBYTES, PARALLELHASH_LEAFBYTES,
+                      win.in + j * blocklen, blocklen);
+        shake256_inc_absorb (&root, z, w * PARALLELHASH_LEAFBYTES);
+    }
+
+    if (inlen % blocklen) {
+        shake256 (z, PARALLELHASH_LEAFBYTES, in + nfull * blocklen, inlen % blocklen);
+        shake256_inc_absorb (&root, z, PARALLELHASH_LEAFBYTES);
+    }
+
+    /* number of leaves, including a short last one */
+    shake256_inc_absorb (&root, buf, parallelhash_encode (buf, (inlen + blocklen - 1) / blocklen, 1));
+    shake256_inc_absorb (&root, buf, parallelhash_encode (buf, 8 * outlen, 1));
+    cshake256_inc_finalize (&root);
+    shake256_inc_squeeze (out, outlen, &root);
+}
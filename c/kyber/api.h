@@ -1,8 +1,34 @@
 #pragma once
 
+#include "../randombytes/rng.h"
+#include "indcpa.h"
 #include "params.h"
+#include <stddef.h>
 
-#define KYBER_K 3
+#define kyber_kem_keypair                KYBER_NAMESPACE (kem_keypair)
+#define kyber_kem_keypair_rng            KYBER_NAMESPACE (kem_keypair_rng)
+#define kyber_kem_enc                    KYBER_NAMESPACE (kem_enc)
+#define kyber_kem_enc_rng                KYBER_NAMESPACE (kem_enc_rng)
+#define kyber_kem_prepare_pk             KYBER_NAMESPACE (kem_prepare_pk)
+#define kyber_kem_enc_prepared_rng       KYBER_NAMESPACE (kem_enc_prepared_rng)
+#define kyber_kem_enc_batch              KYBER_NAMESPACE (kem_enc_batch)
+#define kyber_kem_dec                    KYBER_NAMESPACE (kem_dec)
+#define kyber_kem_prepare_sk             KYBER_NAMESPACE (kem_prepare_sk)
+#define kyber_kem_dec_prepared           KYBER_NAMESPACE (kem_dec_prepared)
+#define kyber_kem_dec_batch              KYBER_NAMESPACE (kem_dec_batch)
+#define kyber_kem_dec_batch_prepared     KYBER_NAMESPACE (kem_dec_batch_prepared)
+#define kyber_kem_keypair_cgo            KYBER_NAMESPACE (kem_keypair_cgo)
+#define kyber_kem_enc_cgo                KYBER_NAMESPACE (kem_enc_cgo)
+#define kyber_prepare_pk_cgo             KYBER_NAMESPACE (prepare_pk_cgo)
+#define kyber_prepared_pk_free_cgo       KYBER_NAMESPACE (prepared_pk_free_cgo)
+#define kyber_kem_enc_prepared_cgo       KYBER_NAMESPACE (kem_enc_prepared_cgo)
+#define kyber_kem_enc_batch_cgo          KYBER_NAMESPACE (kem_enc_batch_cgo)
+#define kyber_kem_dec_cgo                KYBER_NAMESPACE (kem_dec_cgo)
+#define kyber_prepare_sk_cgo             KYBER_NAMESPACE (prepare_sk_cgo)
+#define kyber_prepared_sk_free_cgo       KYBER_NAMESPACE (prepared_sk_free_cgo)
+#define kyber_kem_dec_prepared_cgo       KYBER_NAMESPACE (kem_dec_prepared_cgo)
+#define kyber_kem_dec_batch_cgo          KYBER_NAMESPACE (kem_dec_batch_cgo)
+#define kyber_kem_dec_batch_prepared_cgo KYBER_NAMESPACE (kem_dec_batch_prepared_cgo)
 
 #if (KYBER_K == 2)
 #define KYBER_ALGNAME "Kyber512"
@@ -15,7 +41,43 @@
 #endif
 
 int kyber_kem_keypair (unsigned char *pk, unsigned char *sk);
+int kyber_kem_keypair_rng (unsigned char *pk, unsigned char *sk, rng_ctx *rng);
 
 int kyber_kem_enc (unsigned char *ct, unsigned char *ss, const unsigned char *pk);
+int kyber_kem_enc_rng (unsigned char *ct, unsigned char *ss, const unsigned char *pk, rng_ctx *rng);
+
+/* Public key prepared for repeated encapsulation: indcpa_prepare_pk
+ * and the hash H(pk) */
+typedef struct {
+    indcpa_prepared_pk indcpa;
+    unsigned char hpk[KYBER_SYMBYTES];
+} kyber_prepared_pk;
+
+void kyber_kem_prepare_pk (kyber_prepared_pk *ppk, const unsigned char *pk);
+int kyber_kem_enc_prepared_rng (unsigned char *ct,
+                                unsigned char *ss,
+                                const kyber_prepared_pk *ppk,
+                                rng_ctx *rng);
+
+int kyber_kem_enc_batch (unsigned char *ct,
+                         unsigned char *ss,
+                         const unsigned char *pk,
+                         const unsigned char *ent,
+                         size_t n,
+                         int rng_backend);
 
 int kyber_kem_dec (unsigned char *ss, const unsigned char *ct, const unsigned char *sk);
+
+/* Secret key prepared for repeated decapsulation: the unpacked secret
+ * vector, the embedded public key prepared for the re-encryption, H(pk)
+ * and the rejection value z */
+typedef struct {
+    indcpa_prepared_sk indcpa;
+    kyber_prepared_pk pk;
+    unsigned char z[KYBER_SYMBYTES];
+} kyber_prepared_sk;
+
+void kyber_kem_prepare_sk (kyber_prepared_sk *psk, const unsigned char *sk);
+int kyber_kem_dec_prepared (unsigned char *ss, const unsigned char *ct, const kyber_prepared_sk *psk);
+void kyber_kem_dec_batch (unsigned char *ss, const unsigned char *ct, size_t n, const unsigned char *sk);
+void kyber_kem_dec_batch_prepared (unsigned char *ss, const unsigned char *ct, size_t n, const kyber_prepared_sk *psk);
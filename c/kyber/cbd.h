@@ -4,6 +4,8 @@
 #include "kyber_poly.h"
 #include <stdint.h>
 
+#define cbd KYBER_NAMESPACE (cbd)
+
 void cbd (kyber_poly *r, const unsigned char *buf);
 
 #endif
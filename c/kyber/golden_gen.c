@@ -19,7 +19,7 @@ int main() {
 
     memset(ent, 0x00, 48);
 
-    kyber_kem_keypair_cgo(pk, sk, ent);
+    kyber_kem_keypair_cgo(pk, sk, ent, RNG_SHAKE256);
 
     fd = open("kyber_sk.golden", O_CREAT | O_WRONLY, 0644);
     write(fd, sk, KYBER_SECRETKEYBYTES);
@@ -29,7 +29,7 @@ int main() {
     write(fd, pk, KYBER_PUBLICKEYBYTES);
     close(fd);
 
-    kyber_kem_enc_cgo(ct, ss, pk, ent);
+    kyber_kem_enc_cgo(ct, ss, pk, ent, RNG_SHAKE256);
 
     fd = open("kyber_ss.golden", O_CREAT | O_WRONLY, 0644);
     write(fd, ss, KYBER_SYMBYTES);
@@ -1,5 +1,6 @@
 #include "indcpa.h"
 #include "../fips202/fips202.h"
+#include "../fips202/keccakf1600.h"
 #include "../randombytes/rng.h"
 #include "kyber_ntt.h"
 #include "kyber_poly.h"
@@ -102,6 +103,58 @@ static void kyber_unpack_sk (kyber_polyvec *sk, const unsigned char *packedsk) {
     kyber_polyvec_frombytes (sk, packedsk);
 }
 
+/*************************************************
+ * Name:        rej_uniform_lanes
+ *
+ * Description: Run rejection sampling on the SHAKE-128 output stream of a
+ *              padded, not yet permuted state, reading 13-bit candidates
+ *              straight from the rate lanes (four per lane) and permuting
+ *              again only while coefficients are missing.
+ *
+ * Arguments:   - kyber_poly *a:  pointer to output polynomial
+ *              - uint64_t *s:    Keccak state, overwritten
+ **************************************************/
+static void rej_uniform_lanes (kyber_poly *a, uint64_t *s) {
+    unsigned int ctr = 0, i, b;
+    uint16_t val;
+
+    while (ctr < KYBER_N) {
+        KeccakF1600_StatePermute (s);
+        for (i = 0; i < SHAKE128_RATE / 8 && ctr < KYBER_N; i++) {
+            for (b = 0; b < 64 && ctr < KYBER_N; b += 16) {
+                val = (s[i] >> b) & 0x1fff;
+                if (val < KYBER_Q) a->coeffs[ctr++] = val;
+            }
+        }
+    }
+}
+
+/*************************************************
+ * Name:        rej_uniform_lanes_x4
+ *
+ * Description: rej_uniform_lanes on four states at once, permuted together
+ *              with the 4-way Keccak until all four polynomials are full
+ *
+ * Arguments:   - kyber_poly **a:  pointers to the four output polynomials
+ *              - uint64_t *s:     interleaved Keccak states (4 * 25 words), overwritten
+ **************************************************/
+static void rej_uniform_lanes_x4 (kyber_poly *a[4], uint64_t *s) {
+    unsigned int ctr[4] = { 0, 0, 0, 0 }, i, b, j;
+    uint16_t val;
+
+    while (ctr[0] < KYBER_N || ctr[1] < KYBER_N || ctr[2] < KYBER_N || ctr[3] < KYBER_N) {
+        KeccakF1600x4_StatePermute (s);
+        for (j = 0; j < 4; j++) {
+            for (i = 0; i < SHAKE128_RATE / 8 && ctr[j] < KYBER_N; i++) {
+                for (b = 0; b < 64 && ctr[j] < KYBER_N; b += 16) {
+                    val = (s[4 * i + j] >> b) & 0x1fff;
+                    if (val < KYBER_Q) a[j]->coeffs[ctr[j]++] = val;
+                }
+            }
+        }
+    }
+}
+
 #define gen_a(A, B) gen_matrix (A, B, 0)
 #define gen_at(A, B) gen_matrix (A, B, 1)
 
@@ -111,7 +164,8 @@ static void kyber_unpack_sk (kyber_polyvec *sk, const unsigned char *packedsk) {
  * Description: Deterministically generate matrix A (or the transpose of A)
  *              from a seed. Entries of the matrix are polynomials that look
  *              uniformly random. Performs rejection sampling on output of
- *              SHAKE-128
+ *              SHAKE-128, four entries at a time on the 4-way Keccak
+ *              permutation and the remaining ones one by one
  *
  * Arguments:   - kyber_polyvec *a:                pointer to ouptput matrix A
  *              - const unsigned char *seed: pointer to input seed
@@ -119,51 +173,44 @@ static void kyber_unpack_sk (kyber_polyvec *sk, const unsigned char *packedsk) {
  **************************************************/
 void gen_matrix (kyber_polyvec *a, const unsigned char *seed, int transposed) // Not static for benchmarking
 {
-    unsigned int pos = 0, ctr;
-    uint16_t val;
-    unsigned int nblocks;
-    const unsigned int maxnblocks = 4;
-    uint8_t buf[SHAKE128_RATE * maxnblocks];
-    int i, j;
-    uint64_t state[25]; // SHAKE state
-    unsigned char extseed[KYBER_SYMBYTES + 2];
-
-    for (i = 0; i < KYBER_SYMBYTES; i++) extseed[i] = seed[i];
-
-
-    for (i = 0; i < KYBER_K; i++) {
-        for (j = 0; j < KYBER_K; j++) {
-            ctr = pos = 0;
-            nblocks = maxnblocks;
+    unsigned int e, i, j, k, l, w;
+    keccak_state seedstate, state;
+    kyber_poly *p[4];
+    uint64_t s4[4 * 25];
+    unsigned char ext[2];
+
+    /* The seed is absorbed once; each entry continues from that midstate */
+    shake128_inc_init (&seedstate);
+    shake128_inc_absorb (&seedstate, seed, KYBER_SYMBYTES);
+
+    for (e = 0; e < KYBER_K * KYBER_K; e += l) {
+        l = KYBER_K * KYBER_K - e < 4 ? 1 : 4;
+
+        for (w = 0; w < l; w++) {
+            i = (e + w) / KYBER_K;
+            j = (e + w) % KYBER_K;
             if (transposed) {
-                extseed[KYBER_SYMBYTES] = i;
-                extseed[KYBER_SYMBYTES + 1] = j;
+                ext[0] = i;
+                ext[1] = j;
             } else {
-                extseed[KYBER_SYMBYTES] = j;
-                extseed[KYBER_SYMBYTES + 1] = i;
+                ext[0] = j;
+                ext[1] = i;
             }
 
-            shake128_absorb (state, extseed, KYBER_SYMBYTES + 2);
-            shake128_squeezeblocks (buf, nblocks, state);
-
-            while (ctr < KYBER_N) {
-                val = (buf[pos] | ((uint16_t)buf[pos + 1] << 8)) & 0x1fff;
-                if (val < KYBER_Q) {
-                    a[i].vec[j].coeffs[ctr++] = val;
-                }
-                pos += 2;
-
-                if (pos > SHAKE128_RATE * nblocks - 2) {
-                    nblocks = 1;
-                    shake128_squeezeblocks (buf, nblocks, state);
-                    pos = 0;
-                }
-            }
+            keccak_inc_clone (&state, &seedstate);
+            shake128_inc_absorb (&state, ext, 2);
+            shake128_inc_finalize (&state);
+            p[w] = &a[i].vec[j];
+            if (l == 1)
+                rej_uniform_lanes (p[w], state.s);
+            else
+                for (k = 0; k < 25; k++) s4[4 * k + w] = state.s[k];
         }
+
+        if (l == 4) rej_uniform_lanes_x4 (p, s4);
     }
 }
 
-
 /*************************************************
  * Name:        indcpa_keypair
  *
@@ -172,28 +219,29 @@ void gen_matrix (kyber_polyvec *a, const unsigned char *seed, int transposed) //
  *
  * Arguments:   - unsigned char *pk: pointer to output public key (of length KYBER_INDCPA_PUBLICKEYBYTES bytes)
  *              - unsigned char *sk: pointer to output private key (of length KYBER_INDCPA_SECRETKEYBYTES bytes)
+ *              - rng_ctx *rng:      RNG context, NULL for the process-wide randombytes state
  **************************************************/
-void indcpa_keypair (unsigned char *pk, unsigned char *sk) {
+void indcpa_keypair_rng (unsigned char *pk, unsigned char *sk, rng_ctx *rng) {
     kyber_polyvec a[KYBER_K], e, pkpv, skpv;
     unsigned char buf[KYBER_SYMBYTES + KYBER_SYMBYTES];
     unsigned char *publicseed = buf;
     unsigned char *noiseseed = buf + KYBER_SYMBYTES;
+    kyber_poly *noise[2 * KYBER_K];
     int i;
-    unsigned char nonce = 0;
 
-    randombytes (buf, KYBER_SYMBYTES);
+    rng_bytes (rng, buf, KYBER_SYMBYTES);
     sha3_512 (buf, buf, KYBER_SYMBYTES);
 
     gen_a (a, publicseed);
 
-    for (i = 0; i < KYBER_K; i++)
-        kyber_poly_getnoise (skpv.vec + i, noiseseed, nonce++);
+    for (i = 0; i < KYBER_K; i++) { /* nonces 0..K-1 for skpv, K..2K-1 for e */
+        noise[i] = skpv.vec + i;
+        noise[KYBER_K + i] = e.vec + i;
+    }
+    kyber_poly_getnoise_batch (noise, 2 * KYBER_K, noiseseed, 0);
 
     kyber_polyvec_ntt (&skpv);
 
-    for (i = 0; i < KYBER_K; i++)
-        kyber_poly_getnoise (e.vec + i, noiseseed, nonce++);
-
     // matrix-vector multiplication
     for (i = 0; i < KYBER_K; i++)
         kyber_polyvec_pointwise_acc (&pkpv.vec[i], &skpv, a + i);
@@ -205,58 +253,72 @@ void indcpa_keypair (unsigned char *pk, unsigned char *sk) {
     kyber_pack_pk (pk, &pkpv, publicseed);
 }
 
+void indcpa_keypair (unsigned char *pk, unsigned char *sk) {
+    indcpa_keypair_rng (pk, sk, NULL);
+}
+
 
 /*************************************************
- * Name:        indcpa_enc
+ * Name:        indcpa_prepare_pk
  *
- * Description: Encryption function of the CPA-secure
- *              public-key encryption scheme underlying Kyber.
+ * Description: Unpacks a public key and does the work of indcpa_enc that
+ *              depends on it only: NTT of the public vector and expansion
+ *              of A^T from the seed.
  *
- * Arguments:   - unsigned char *c:          pointer to output ciphertext (of length KYBER_INDCPA_BYTES bytes)
- *              - const unsigned char *m:    pointer to input message (of length KYBER_INDCPA_MSGBYTES bytes)
- *              - const unsigned char *pk:   pointer to input public key (of length KYBER_INDCPA_PUBLICKEYBYTES bytes)
- *              - const unsigned char *coin: pointer to input random coins used as seed (of length KYBER_SYMBYTES bytes)
- *                                           to deterministically generate all randomness
+ * Arguments:   - indcpa_prepared_pk *ppk:  pointer to output prepared key
+ *              - const unsigned char *pk:  pointer to input public key (of length KYBER_INDCPA_PUBLICKEYBYTES bytes)
  **************************************************/
-void indcpa_enc (unsigned char *c,
-                 const unsigned char *m,
-                 const unsigned char *pk,
-                 const unsigned char *coins) {
-    kyber_polyvec sp, pkpv, ep, at[KYBER_K], bp;
-    kyber_poly v, k, epp;
+void indcpa_prepare_pk (indcpa_prepared_pk *ppk, const unsigned char *pk) {
     unsigned char seed[KYBER_SYMBYTES];
-    int i;
-    unsigned char nonce = 0;
 
+    kyber_unpack_pk (&ppk->pkpv, seed, pk);
+    kyber_polyvec_ntt (&ppk->pkpv);
+    gen_at (ppk->at, seed);
+}
 
-    kyber_unpack_pk (&pkpv, seed, pk);
+/*************************************************
+ * Name:        indcpa_enc_prepared
+ *
+ * Description: Encryption function of the CPA-secure
+ *              public-key encryption scheme underlying Kyber,
+ *              under a public key prepared by indcpa_prepare_pk.
+ *
+ * Arguments:   - unsigned char *c:                pointer to output ciphertext (of length KYBER_INDCPA_BYTES bytes)
+ *              - const unsigned char *m:          pointer to input message (of length KYBER_INDCPA_MSGBYTES bytes)
+ *              - const indcpa_prepared_pk *ppk:   pointer to input prepared public key
+ *              - const unsigned char *coin:       pointer to input random coins used as seed (of length KYBER_SYMBYTES bytes)
+ *                                                 to deterministically generate all randomness
+ **************************************************/
+void indcpa_enc_prepared (unsigned char *c,
+                          const unsigned char *m,
+                          const indcpa_prepared_pk *ppk,
+                          const unsigned char *coins) {
+    kyber_polyvec sp, ep, bp;
+    kyber_poly v, k, epp;
+    kyber_poly *noise[2 * KYBER_K + 1];
+    int i;
 
     kyber_poly_frommsg (&k, m);
 
-    kyber_polyvec_ntt (&pkpv);
-
-    gen_at (at, seed);
-
-    for (i = 0; i < KYBER_K; i++)
-        kyber_poly_getnoise (sp.vec + i, coins, nonce++);
+    for (i = 0; i < KYBER_K; i++) { /* nonces 0..K-1 for sp, K..2K-1 for ep, 2K for epp */
+        noise[i] = sp.vec + i;
+        noise[KYBER_K + i] = ep.vec + i;
+    }
+    noise[2 * KYBER_K] = &epp;
+    kyber_poly_getnoise_batch (noise, 2 * KYBER_K + 1, coins, 0);
 
     kyber_polyvec_ntt (&sp);
 
-    for (i = 0; i < KYBER_K; i++)
-        kyber_poly_getnoise (ep.vec + i, coins, nonce++);
-
     // matrix-vector multiplication
     for (i = 0; i < KYBER_K; i++)
-        kyber_polyvec_pointwise_acc (&bp.vec[i], &sp, at + i);
+        kyber_polyvec_pointwise_acc (&bp.vec[i], &sp, ppk->at + i);
 
     kyber_polyvec_invntt (&bp);
     kyber_polyvec_add (&bp, &bp, &ep);
 
-    kyber_polyvec_pointwise_acc (&v, &pkpv, &sp);
+    kyber_polyvec_pointwise_acc (&v, &ppk->pkpv, &sp);
     kyber_poly_invntt (&v);
 
-    kyber_poly_getnoise (&epp, coins, nonce++);
-
     kyber_poly_add (&v, &v, &epp);
     kyber_poly_add (&v, &v, &k);
 
@@ -264,28 +326,79 @@ void indcpa_enc (unsigned char *c,
 }
 
 /*************************************************
- * Name:        indcpa_dec
+ * Name:        indcpa_enc
  *
- * Description: Decryption function of the CPA-secure
+ * Description: Encryption function of the CPA-secure
  *              public-key encryption scheme underlying Kyber.
  *
- * Arguments:   - unsigned char *m:        pointer to output decrypted message (of length KYBER_INDCPA_MSGBYTES)
- *              - const unsigned char *c:  pointer to input ciphertext (of length KYBER_INDCPA_BYTES)
+ * Arguments:   - unsigned char *c:          pointer to output ciphertext (of length KYBER_INDCPA_BYTES bytes)
+ *              - const unsigned char *m:    pointer to input message (of length KYBER_INDCPA_MSGBYTES bytes)
+ *              - const unsigned char *pk:   pointer to input public key (of length KYBER_INDCPA_PUBLICKEYBYTES bytes)
+ *              - const unsigned char *coin: pointer to input random coins used as seed (of length KYBER_SYMBYTES bytes)
+ *                                           to deterministically generate all randomness
+ **************************************************/
+void indcpa_enc (unsigned char *c,
+                 const unsigned char *m,
+                 const unsigned char *pk,
+                 const unsigned char *coins) {
+    indcpa_prepared_pk ppk;
+
+    indcpa_prepare_pk (&ppk, pk);
+    indcpa_enc_prepared (c, m, &ppk, coins);
+}
+
+/*************************************************
+ * Name:        indcpa_prepare_sk
+ *
+ * Description: Unpacks a secret key for indcpa_dec_prepared
+ *
+ * Arguments:   - indcpa_prepared_sk *psk: pointer to output prepared key
  *              - const unsigned char *sk: pointer to input secret key (of length KYBER_INDCPA_SECRETKEYBYTES)
  **************************************************/
-void indcpa_dec (unsigned char *m, const unsigned char *c, const unsigned char *sk) {
-    kyber_polyvec bp, skpv;
+void indcpa_prepare_sk (indcpa_prepared_sk *psk, const unsigned char *sk) {
+    kyber_unpack_sk (&psk->skpv, sk);
+}
+
+/*************************************************
+ * Name:        indcpa_dec_prepared
+ *
+ * Description: Decryption function of the CPA-secure
+ *              public-key encryption scheme underlying Kyber,
+ *              under a secret key prepared by indcpa_prepare_sk.
+ *
+ * Arguments:   - unsigned char *m:                pointer to output decrypted message (of length KYBER_INDCPA_MSGBYTES)
+ *              - const unsigned char *c:          pointer to input ciphertext (of length KYBER_INDCPA_BYTES)
+ *              - const indcpa_prepared_sk *psk:   pointer to input prepared secret key
+ **************************************************/
+void indcpa_dec_prepared (unsigned char *m, const unsigned char *c, const indcpa_prepared_sk *psk) {
+    kyber_polyvec bp;
     kyber_poly v, mp;
 
     kyber_unpack_ciphertext (&bp, &v, c);
-    kyber_unpack_sk (&skpv, sk);
 
     kyber_polyvec_ntt (&bp);
 
-    kyber_polyvec_pointwise_acc (&mp, &skpv, &bp);
+    kyber_polyvec_pointwise_acc (&mp, &psk->skpv, &bp);
     kyber_poly_invntt (&mp);
 
     kyber_poly_sub (&mp, &mp, &v);
 
     kyber_poly_tomsg (m, &mp);
 }
+
+/*************************************************
+ * Name:        indcpa_dec
+ *
+ * Description: Decryption function of the CPA-secure
+ *              public-key encryption scheme underlying Kyber.
+ *
+ * Arguments:   - unsigned char *m:        pointer to output decrypted message (of length KYBER_INDCPA_MSGBYTES)
+ *              - const unsigned char *c:  pointer to input ciphertext (of length KYBER_INDCPA_BYTES)
+ *              - const unsigned char *sk: pointer to input secret key (of length KYBER_INDCPA_SECRETKEYBYTES)
+ **************************************************/
+void indcpa_dec (unsigned char *m, const unsigned char *c, const unsigned char *sk) {
+    indcpa_prepared_sk psk;
+
+    indcpa_prepare_sk (&psk, sk);
+    indcpa_dec_prepared (m, c, &psk);
+}
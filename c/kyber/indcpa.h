@@ -1,10 +1,46 @@
 #pragma once
 
+#include "../randombytes/rng.h"
+#include "kyber_polyvec.h"
+
+#define gen_matrix          KYBER_NAMESPACE (gen_matrix)
+#define indcpa_keypair      KYBER_NAMESPACE (indcpa_keypair)
+#define indcpa_keypair_rng  KYBER_NAMESPACE (indcpa_keypair_rng)
+#define indcpa_enc          KYBER_NAMESPACE (indcpa_enc)
+#define indcpa_prepare_pk   KYBER_NAMESPACE (indcpa_prepare_pk)
+#define indcpa_enc_prepared KYBER_NAMESPACE (indcpa_enc_prepared)
+#define indcpa_dec          KYBER_NAMESPACE (indcpa_dec)
+#define indcpa_prepare_sk   KYBER_NAMESPACE (indcpa_prepare_sk)
+#define indcpa_dec_prepared KYBER_NAMESPACE (indcpa_dec_prepared)
+
+/* Public key with the message-independent work of indcpa_enc done:
+ * the public vector in NTT domain and the matrix A^T expanded */
+typedef struct {
+    kyber_polyvec pkpv;
+    kyber_polyvec at[KYBER_K];
+} indcpa_prepared_pk;
+
 void indcpa_keypair (unsigned char *pk, unsigned char *sk);
+void indcpa_keypair_rng (unsigned char *pk, unsigned char *sk, rng_ctx *rng);
 
 void indcpa_enc (unsigned char *c,
                  const unsigned char *m,
                  const unsigned char *pk,
                  const unsigned char *coins);
 
+/* Secret key unpacked for repeated decryption */
+typedef struct {
+    kyber_polyvec skpv;
+} indcpa_prepared_sk;
+
+void indcpa_prepare_pk (indcpa_prepared_pk *ppk, const unsigned char *pk);
+void indcpa_enc_prepared (unsigned char *c,
+                          const unsigned char *m,
+                          const indcpa_prepared_pk *ppk,
+                          const unsigned char *coins);
+
 void indcpa_dec (unsigned char *m, const unsigned char *c, const unsigned char *sk);
+void indcpa_prepare_sk (indcpa_prepared_sk *psk, const unsigned char *sk);
+void indcpa_dec_prepared (unsigned char *m, const unsigned char *c, const indcpa_prepared_sk *psk);
+
+void gen_matrix (kyber_polyvec *a, const unsigned char *seed, int transposed);
@@ -1,9 +1,13 @@
 #include "../fips202/fips202.h"
+#include "../fips202/mbhash.h"
 #include "../randombytes/rng.h"
 #include "api.h"
 #include "indcpa.h"
+#include "kyber_sets.h"
 #include "params.h"
 #include "verify.h"
+#include <stdlib.h>
+#include <string.h>
 
 /*************************************************
  * Name:        kyber_kem_keypair
@@ -13,24 +17,85 @@
  *
  * Arguments:   - unsigned char *pk: pointer to output public key (an already allocated array of KYBER_PUBLICKEYBYTES bytes)
  *              - unsigned char *sk: pointer to output private key (an already allocated array of KYBER_SECRETKEYBYTES bytes)
+ *              - rng_ctx *rng:      RNG context, NULL for the process-wide randombytes state
  *
  * Returns 0 (success)
  **************************************************/
-int kyber_kem_keypair (unsigned char *pk, unsigned char *sk) {
+int kyber_kem_keypair_rng (unsigned char *pk, unsigned char *sk, rng_ctx *rng) {
     size_t i;
-    indcpa_keypair (pk, sk);
+    indcpa_keypair_rng (pk, sk, rng);
     for (i = 0; i < KYBER_INDCPA_PUBLICKEYBYTES; i++)
         sk[i + KYBER_INDCPA_SECRETKEYBYTES] = pk[i];
     sha3_256 (sk + KYBER_SECRETKEYBYTES - 2 * KYBER_SYMBYTES, pk, KYBER_PUBLICKEYBYTES);
-    randombytes (sk + KYBER_SECRETKEYBYTES - KYBER_SYMBYTES, KYBER_SYMBYTES); /* Value z for pseudo-random output on reject */
+    rng_bytes (rng, sk + KYBER_SECRETKEYBYTES - KYBER_SYMBYTES, KYBER_SYMBYTES); /* Value z for pseudo-random output on reject */
     return 0;
 }
 
+int kyber_kem_keypair (unsigned char *pk, unsigned char *sk) {
+    return kyber_kem_keypair_rng (pk, sk, NULL);
+}
+
 /* TESERAKT */
-int kyber_kem_keypair_cgo (char *pk, char *sk, const char *entropy) {
-    randombytes_init ((unsigned char *)entropy, NULL, 0);
-    kyber_kem_keypair ((unsigned char *)pk, (unsigned char *)sk);
+int kyber_kem_keypair_cgo (char *pk, char *sk, const char *entropy, int rng_backend) {
+    rng_ctx rng;
+    int ret;
+
+    if (rng_init (&rng, rng_backend, (const unsigned char *)entropy, NULL)) {
+        rng_wipe (&rng);
+        return -1;
+    }
+    ret = kyber_kem_keypair_rng ((unsigned char *)pk, (unsigned char *)sk, &rng);
+    rng_wipe (&rng);
 
+    return ret;
+}
+
+/*************************************************
+ * Name:        kyber_kem_prepare_pk
+ *
+ * Description: Does the work of kyber_kem_enc that only depends on the
+ *              public key, for repeated encapsulation to it
+ *
+ * Arguments:   - kyber_prepared_pk *ppk:  pointer to output prepared key
+ *              - const unsigned char *pk: pointer to input public key (an already allocated array of KYBER_PUBLICKEYBYTES bytes)
+ **************************************************/
+void kyber_kem_prepare_pk (kyber_prepared_pk *ppk, const unsigned char *pk) {
+    indcpa_prepare_pk (&ppk->indcpa, pk);
+    mbhash_sha3_256 (ppk->hpk, pk, KYBER_PUBLICKEYBYTES);
+}
+
+/*************************************************
+ * Name:        kyber_kem_enc_prepared
+ *
+ * Description: Generates cipher text and shared
+ *              secret for given prepared public key
+ *
+ * Arguments:   - unsigned char *ct:             pointer to output cipher text (an already allocated array of KYBER_CIPHERTEXTBYTES bytes)
+ *              - unsigned char *ss:             pointer to output shared secret (an already allocated array of KYBER_BYTES bytes)
+ *              - const kyber_prepared_pk *ppk:  pointer to input prepared public key
+ *              - rng_ctx *rng:                  RNG context, NULL for the process-wide randombytes state
+ *
+ * Returns 0 (success)
+ **************************************************/
+int kyber_kem_enc_prepared_rng (unsigned char *ct,
+                                unsigned char *ss,
+                                const kyber_prepared_pk *ppk,
+                                rng_ctx *rng) {
+    unsigned char kr[2 * KYBER_SYMBYTES]; /* Will contain key, coins */
+    unsigned char buf[2 * KYBER_SYMBYTES];
+    size_t i;
+
+    rng_bytes (rng, buf, KYBER_SYMBYTES);
+    sha3_256 (buf, buf, KYBER_SYMBYTES); /* Don't release system RNG output */
+
+    for (i = 0; i < KYBER_SYMBYTES; i++) /* Multitarget countermeasure for coins + contributory KEM */
+        buf[KYBER_SYMBYTES + i] = ppk->hpk[i];
+    sha3_512 (kr, buf, 2 * KYBER_SYMBYTES);
+
+    indcpa_enc_prepared (ct, buf, &ppk->indcpa, kr + KYBER_SYMBYTES); /* coins are in kr+KYBER_SYMBYTES */
+
+    mbhash_sha3_256 (kr + KYBER_SYMBYTES, ct, KYBER_CIPHERTEXTBYTES); /* overwrite coins in kr with H(c) */
+    sha3_256 (ss, kr, 2 * KYBER_SYMBYTES); /* hash concatenation of pre-k and H(c) to k */
     return 0;
 }
 
@@ -43,76 +108,383 @@ int kyber_kem_keypair_cgo (char *pk, char *sk, const char *entropy) {
  * Arguments:   - unsigned char *ct:       pointer to output cipher text (an already allocated array of KYBER_CIPHERTEXTBYTES bytes)
  *              - unsigned char *ss:       pointer to output shared secret (an already allocated array of KYBER_BYTES bytes)
  *              - const unsigned char *pk: pointer to input public key (an already allocated array of KYBER_PUBLICKEYBYTES bytes)
+ *              - rng_ctx *rng:            RNG context, NULL for the process-wide randombytes state
  *
  * Returns 0 (success)
  **************************************************/
+int kyber_kem_enc_rng (unsigned char *ct, unsigned char *ss, const unsigned char *pk, rng_ctx *rng) {
+    kyber_prepared_pk ppk;
+
+    kyber_kem_prepare_pk (&ppk, pk);
+    return kyber_kem_enc_prepared_rng (ct, ss, &ppk, rng);
+}
+
 int kyber_kem_enc (unsigned char *ct, unsigned char *ss, const unsigned char *pk) {
-    unsigned char kr[2 * KYBER_SYMBYTES]; /* Will contain key, coins */
-    unsigned char buf[2 * KYBER_SYMBYTES];
+    return kyber_kem_enc_rng (ct, ss, pk, NULL);
+}
 
-    randombytes (buf, KYBER_SYMBYTES);
-    sha3_256 (buf, buf, KYBER_SYMBYTES); /* Don't release system RNG output */
+/* TESERAKT */
+int kyber_kem_enc_cgo (char *ct, char *ss, const char *pk, const char *entropy, int rng_backend) {
+    rng_ctx rng;
+    int ret;
 
-    sha3_256 (buf + KYBER_SYMBYTES, pk, KYBER_PUBLICKEYBYTES); /* Multitarget countermeasure for coins + contributory KEM */
-    sha3_512 (kr, buf, 2 * KYBER_SYMBYTES);
+    if (rng_init (&rng, rng_backend, (const unsigned char *)entropy, NULL)) {
+        rng_wipe (&rng);
+        return -1;
+    }
+    ret = kyber_kem_enc_rng ((unsigned char *)ct, (unsigned char *)ss,
+                             (const unsigned char *)pk, &rng);
+    rng_wipe (&rng);
+    return ret;
+}
 
-    indcpa_enc (ct, buf, pk, kr + KYBER_SYMBYTES); /* coins are in kr+KYBER_SYMBYTES */
+/* TESERAKT: prepared keys cross the set layer of kyber_sets.h as void * */
+void *kyber_prepare_pk_cgo (const char *pk) {
+    kyber_prepared_pk *ppk = malloc (sizeof *ppk);
 
-    sha3_256 (kr + KYBER_SYMBYTES, ct, KYBER_CIPHERTEXTBYTES); /* overwrite coins in kr with H(c) */
-    sha3_256 (ss, kr, 2 * KYBER_SYMBYTES); /* hash concatenation of pre-k and H(c) to k */
+    if (ppk != NULL) kyber_kem_prepare_pk (ppk, (const unsigned char *)pk);
+    return ppk;
+}
+
+/* TESERAKT */
+void kyber_prepared_pk_free_cgo (void *ppk) {
+    free (ppk);
+}
+
+/* TESERAKT */
+int kyber_kem_enc_prepared_cgo (char *ct,
+                                char *ss,
+                                const void *ppk,
+                                const char *entropy,
+                                int rng_backend) {
+    rng_ctx rng;
+    int ret;
+
+    if (rng_init (&rng, rng_backend, (const unsigned char *)entropy, NULL)) {
+        rng_wipe (&rng);
+        return -1;
+    }
+    ret = kyber_kem_enc_prepared_rng ((unsigned char *)ct, (unsigned char *)ss, ppk, &rng);
+    rng_wipe (&rng);
+    return ret;
+}
+
+#define KYBER_BATCH_LANES 4
+#define KYBER_BATCH_ENTROPYBYTES 48 /* seed of the rng_ctx of an entry */
+
+/* Public keys prepared by a batch, one slot per lane so that the four
+ * entries hashed together can all target different keys */
+typedef struct {
+    kyber_prepared_pk ppk[KYBER_BATCH_LANES];
+    const unsigned char *pk[KYBER_BATCH_LANES]; /* key in each slot, NULL if none */
+    unsigned int next;                         /* slot to evict next */
+} kyber_batch_keys;
+
+/* Returns the slot of pk, preparing it if no slot holds it yet; slots in
+ * the mask pinned are used by the current group and are not evicted */
+static const kyber_prepared_pk *
+kyber_batch_key (kyber_batch_keys *keys, const unsigned char *pk, unsigned int *pinned) {
+    unsigned int i;
+
+    for (i = 0; i < KYBER_BATCH_LANES; i++) {
+        if (keys->pk[i] != NULL &&
+            (keys->pk[i] == pk || memcmp (keys->pk[i], pk, KYBER_PUBLICKEYBYTES) == 0)) {
+            *pinned |= 1U << i;
+            return &keys->ppk[i];
+        }
+    }
+
+    while (*pinned & (1U << keys->next))
+        keys->next = (keys->next + 1) % KYBER_BATCH_LANES;
+    i = keys->next;
+    keys->next = (keys->next + 1) % KYBER_BATCH_LANES;
+
+    kyber_kem_prepare_pk (&keys->ppk[i], pk);
+    keys->pk[i] = pk;
+    *pinned |= 1U << i;
+    return &keys->ppk[i];
+}
+
+/*************************************************
+ * Name:        kyber_kem_enc_batch
+ *
+ * Description: Runs n encapsulations, entry i being that of
+ *              kyber_kem_enc_rng to public key i with an RNG seeded with
+ *              entropy i. Keys that repeat within the batch are prepared
+ *              once, and the hashes of four entries at a time run on the
+ *              4-way Keccak permutation.
+ *
+ * Arguments:   - unsigned char *ct:        pointer to output slab of n cipher texts
+ *              - unsigned char *ss:        pointer to output slab of n shared secrets
+ *              - const unsigned char *pk:  pointer to input slab of n public keys
+ *              - const unsigned char *ent: pointer to input slab of n times KYBER_BATCH_ENTROPYBYTES bytes
+ *              - size_t n:                 number of entries
+ *              - int rng_backend:          RNG_* generator seeded by each entropy
+ *
+ * Returns 0 on success, -1 for an unknown RNG backend or if out of memory
+ **************************************************/
+int kyber_kem_enc_batch (unsigned char *ct,
+                         unsigned char *ss,
+                         const unsigned char *pk,
+                         const unsigned char *ent,
+                         size_t n,
+                         int rng_backend) {
+    unsigned char buf[KYBER_BATCH_LANES][2 * KYBER_SYMBYTES];
+    unsigned char kr[KYBER_BATCH_LANES][2 * KYBER_SYMBYTES]; /* Will contain key, coins */
+    unsigned char sscratch[KYBER_SYMBYTES];                  /* output of idle lanes */
+    const kyber_prepared_pk *ppk[KYBER_BATCH_LANES];
+    unsigned char *c[KYBER_BATCH_LANES], *k[KYBER_BATCH_LANES];
+    kyber_batch_keys *keys;
+    unsigned int j, lanes, pinned;
+    rng_ctx rng;
+    size_t i;
+
+    if (rng_backend != RNG_SHAKE256 && rng_backend != RNG_AES256_CTR_DRBG) return -1;
+    keys = malloc (sizeof *keys);
+    if (keys == NULL) return -1;
+    for (j = 0; j < KYBER_BATCH_LANES; j++) keys->pk[j] = NULL;
+    keys->next = 0;
+
+    for (i = 0; i < n; i += KYBER_BATCH_LANES) {
+        lanes = n - i < KYBER_BATCH_LANES ? n - i : KYBER_BATCH_LANES;
+        pinned = 0;
+
+        for (j = 0; j < lanes; j++) {
+            rng_init (&rng, rng_backend, ent + (i + j) * KYBER_BATCH_ENTROPYBYTES, NULL);
+            rng_bytes (&rng, buf[j], KYBER_SYMBYTES);
+            ppk[j] = kyber_batch_key (keys, pk + (i + j) * KYBER_PUBLICKEYBYTES, &pinned);
+            c[j] = ct + (i + j) * KYBER_CIPHERTEXTBYTES;
+            k[j] = ss + (i + j) * KYBER_SYMBYTES;
+        }
+        for (; j < KYBER_BATCH_LANES; j++) { /* idle lanes of the last group redo lane 0 */
+            memcpy (buf[j], buf[0], KYBER_SYMBYTES);
+            ppk[j] = ppk[0];
+            c[j] = c[0];
+            k[j] = sscratch;
+        }
+
+        sha3_256x4 (buf[0], buf[1], buf[2], buf[3], buf[0], buf[1], buf[2], buf[3],
+                    KYBER_SYMBYTES); /* Don't release system RNG output */
+
+        for (j = 0; j < KYBER_BATCH_LANES; j++) /* Multitarget countermeasure for coins + contributory KEM */
+            memcpy (buf[j] + KYBER_SYMBYTES, ppk[j]->hpk, KYBER_SYMBYTES);
+        sha3_512x4 (kr[0], kr[1], kr[2], kr[3], buf[0], buf[1], buf[2], buf[3], 2 * KYBER_SYMBYTES);
+
+        for (j = 0; j < lanes; j++) /* coins are in kr+KYBER_SYMBYTES */
+            indcpa_enc_prepared (c[j], buf[j], &ppk[j]->indcpa, kr[j] + KYBER_SYMBYTES);
+
+        sha3_256x4 (kr[0] + KYBER_SYMBYTES, kr[1] + KYBER_SYMBYTES, kr[2] + KYBER_SYMBYTES,
+                    kr[3] + KYBER_SYMBYTES, c[0], c[1], c[2], c[3],
+                    KYBER_CIPHERTEXTBYTES); /* overwrite coins in kr with H(c) */
+        sha3_256x4 (k[0], k[1], k[2], k[3], kr[0], kr[1], kr[2], kr[3],
+                    2 * KYBER_SYMBYTES); /* hash concatenation of pre-k and H(c) to k */
+    }
+    rng_wipe (&rng);
+
+    free (keys);
     return 0;
 }
 
 /* TESERAKT */
-int kyber_kem_enc_cgo (char *ct, char *ss, const char *pk, const char *entropy) {
-    randombytes_init ((unsigned char *)entropy, NULL, 0);
-    return kyber_kem_enc ((unsigned char *)ct, (unsigned char *)ss,
-                          (const unsigned char *)pk);
+int kyber_kem_enc_batch_cgo (char *ct, char *ss, const char *pk, const char *entropy, size_t n, int rng_backend) {
+    return kyber_kem_enc_batch ((unsigned char *)ct, (unsigned char *)ss, (const unsigned char *)pk,
+                                (const unsigned char *)entropy, n, rng_backend);
 }
 
 /*************************************************
- * Name:        kyber_kem_dec
+ * Name:        kyber_kem_prepare_sk
  *
- * Description: Generates shared secret for given
- *              cipher text and private key
+ * Description: Does the work of kyber_kem_dec that only depends on the
+ *              secret key, for repeated decapsulation with it
  *
- * Arguments:   - unsigned char *ss:       pointer to output shared secret (an already allocated array of KYBER_BYTES bytes)
- *              - const unsigned char *ct: pointer to input cipher text (an already allocated array of KYBER_CIPHERTEXTBYTES bytes)
+ * Arguments:   - kyber_prepared_sk *psk:  pointer to output prepared key
  *              - const unsigned char *sk: pointer to input private key (an already allocated array of KYBER_SECRETKEYBYTES bytes)
+ **************************************************/
+void kyber_kem_prepare_sk (kyber_prepared_sk *psk, const unsigned char *sk) {
+    size_t i;
+
+    indcpa_prepare_sk (&psk->indcpa, sk);
+    indcpa_prepare_pk (&psk->pk.indcpa, sk + KYBER_INDCPA_SECRETKEYBYTES);
+    for (i = 0; i < KYBER_SYMBYTES; i++) {
+        psk->pk.hpk[i] = sk[KYBER_SECRETKEYBYTES - 2 * KYBER_SYMBYTES + i]; /* H(pk) is stored in sk */
+        psk->z[i] = sk[KYBER_SECRETKEYBYTES - KYBER_SYMBYTES + i];
+    }
+}
+
+/*************************************************
+ * Name:        kyber_kem_dec_prepared
+ *
+ * Description: Generates shared secret for given
+ *              cipher text and prepared private key
+ *
+ * Arguments:   - unsigned char *ss:             pointer to output shared secret (an already allocated array of KYBER_BYTES bytes)
+ *              - const unsigned char *ct:       pointer to input cipher text (an already allocated array of KYBER_CIPHERTEXTBYTES bytes)
+ *              - const kyber_prepared_sk *psk:  pointer to input prepared private key
  *
  * Returns 0.
  *
  * On failure, ss will contain a pseudo-random value.
  **************************************************/
-int kyber_kem_dec (unsigned char *ss, const unsigned char *ct, const unsigned char *sk) {
+int kyber_kem_dec_prepared (unsigned char *ss, const unsigned char *ct, const kyber_prepared_sk *psk) {
     size_t i;
     int fail;
     unsigned char cmp[KYBER_CIPHERTEXTBYTES];
     unsigned char buf[2 * KYBER_SYMBYTES];
     unsigned char kr[2 * KYBER_SYMBYTES]; /* Will contain key, coins, qrom-hash */
-    const unsigned char *pk = sk + KYBER_INDCPA_SECRETKEYBYTES;
 
-    indcpa_dec (buf, ct, sk);
+    indcpa_dec_prepared (buf, ct, &psk->indcpa);
 
     for (i = 0; i < KYBER_SYMBYTES; i++) /* Multitarget countermeasure for coins + contributory KEM */
-        buf[KYBER_SYMBYTES + i] = sk[KYBER_SECRETKEYBYTES - 2 * KYBER_SYMBYTES + i]; /* Save hash by storing H(pk) in sk */
+        buf[KYBER_SYMBYTES + i] = psk->pk.hpk[i];
     sha3_512 (kr, buf, 2 * KYBER_SYMBYTES);
 
-    indcpa_enc (cmp, buf, pk, kr + KYBER_SYMBYTES); /* coins are in kr+KYBER_SYMBYTES */
+    indcpa_enc_prepared (cmp, buf, &psk->pk.indcpa, kr + KYBER_SYMBYTES); /* coins are in kr+KYBER_SYMBYTES */
 
     fail = verify (ct, cmp, KYBER_CIPHERTEXTBYTES);
 
-    sha3_256 (kr + KYBER_SYMBYTES, ct, KYBER_CIPHERTEXTBYTES); /* overwrite coins in kr with H(c)  */
+    mbhash_sha3_256 (kr + KYBER_SYMBYTES, ct, KYBER_CIPHERTEXTBYTES); /* overwrite coins in kr with H(c)  */
 
-    cmov (kr, sk + KYBER_SECRETKEYBYTES - KYBER_SYMBYTES, KYBER_SYMBYTES, fail); /* Overwrite pre-k with z on re-encryption failure */
+    cmov (kr, psk->z, KYBER_SYMBYTES, fail); /* Overwrite pre-k with z on re-encryption failure */
 
     sha3_256 (ss, kr, 2 * KYBER_SYMBYTES); /* hash concatenation of pre-k and H(c) to k */
 
     return 0;
 }
 
+/*************************************************
+ * Name:        kyber_kem_dec
+ *
+ * Description: Generates shared secret for given
+ *              cipher text and private key
+ *
+ * Arguments:   - unsigned char *ss:       pointer to output shared secret (an already allocated array of KYBER_BYTES bytes)
+ *              - const unsigned char *ct: pointer to input cipher text (an already allocated array of KYBER_CIPHERTEXTBYTES bytes)
+ *              - const unsigned char *sk: pointer to input private key (an already allocated array of KYBER_SECRETKEYBYTES bytes)
+ *
+ * Returns 0.
+ *
+ * On failure, ss will contain a pseudo-random value.
+ **************************************************/
+int kyber_kem_dec (unsigned char *ss, const unsigned char *ct, const unsigned char *sk) {
+    kyber_prepared_sk psk;
+
+    kyber_kem_prepare_sk (&psk, sk);
+    return kyber_kem_dec_prepared (ss, ct, &psk);
+}
+
 /* TESERAKT */
 int kyber_kem_dec_cgo (char *ss, const char *ct, const char *sk) {
     return kyber_kem_dec ((unsigned char *)ss, (const unsigned char *)ct,
                           (const unsigned char *)sk);
-}
\ No newline at end of file
+}
+
+/* TESERAKT */
+void *kyber_prepare_sk_cgo (const char *sk) {
+    kyber_prepared_sk *psk = malloc (sizeof *psk);
+
+    if (psk != NULL) kyber_kem_prepare_sk (psk, (const unsigned char *)sk);
+    return psk;
+}
+
+/* TESERAKT: the key material is cleared through a volatile pointer so the
+ * stores are not dropped as dead before free */
+void kyber_prepared_sk_free_cgo (void *psk) {
+    volatile unsigned char *p = psk;
+    size_t i;
+
+    for (i = 0; i < sizeof (kyber_prepared_sk); i++) p[i] = 0;
+    free (psk);
+}
+
+/* TESERAKT */
+int kyber_kem_dec_prepared_cgo (char *ss, const char *ct, const void *psk) {
+    return kyber_kem_dec_prepared ((unsigned char *)ss, (const unsigned char *)ct, psk);
+}
+
+/*************************************************
+ * Name:        kyber_kem_dec_batch_prepared
+ *
+ * Description: Runs kyber_kem_dec_prepared on n cipher texts. The hashes
+ *              and the re-encryption checks of four cipher texts at a time
+ *              run together; each check stays constant time.
+ *
+ * Arguments:   - unsigned char *ss:             pointer to output slab of n shared secrets
+ *              - const unsigned char *ct:       pointer to input slab of n cipher texts
+ *              - size_t n:                      number of cipher texts
+ *              - const kyber_prepared_sk *psk:  pointer to input prepared private key
+ **************************************************/
+void kyber_kem_dec_batch_prepared (unsigned char *ss, const unsigned char *ct, size_t n, const kyber_prepared_sk *psk) {
+    unsigned char cmp[KYBER_BATCH_LANES][KYBER_CIPHERTEXTBYTES];
+    unsigned char buf[KYBER_BATCH_LANES][2 * KYBER_SYMBYTES];
+    unsigned char kr[KYBER_BATCH_LANES][2 * KYBER_SYMBYTES]; /* Will contain key, coins, qrom-hash */
+    unsigned char sscratch[KYBER_SYMBYTES];                  /* output of idle lanes */
+    const unsigned char *c[KYBER_BATCH_LANES], *e[KYBER_BATCH_LANES];
+    unsigned char *k[KYBER_BATCH_LANES];
+    int fail[KYBER_BATCH_LANES];
+    unsigned int j, lanes;
+    size_t i;
+
+    for (i = 0; i < n; i += KYBER_BATCH_LANES) {
+        lanes = n - i < KYBER_BATCH_LANES ? n - i : KYBER_BATCH_LANES;
+
+        for (j = 0; j < lanes; j++) {
+            c[j] = ct + (i + j) * KYBER_CIPHERTEXTBYTES;
+            k[j] = ss + (i + j) * KYBER_SYMBYTES;
+            e[j] = cmp[j];
+            indcpa_dec_prepared (buf[j], c[j], &psk->indcpa);
+        }
+        for (; j < KYBER_BATCH_LANES; j++) { /* idle lanes of the last group redo lane 0 */
+            c[j] = c[0];
+            k[j] = sscratch;
+            e[j] = cmp[0];
+            memcpy (buf[j], buf[0], KYBER_SYMBYTES);
+        }
+
+        for (j = 0; j < KYBER_BATCH_LANES; j++) /* Multitarget countermeasure for coins + contributory KEM */
+            memcpy (buf[j] + KYBER_SYMBYTES, psk->pk.hpk, KYBER_SYMBYTES);
+        sha3_512x4 (kr[0], kr[1], kr[2], kr[3], buf[0], buf[1], buf[2], buf[3], 2 * KYBER_SYMBYTES);
+
+        for (j = 0; j < lanes; j++) /* coins are in kr+KYBER_SYMBYTES */
+            indcpa_enc_prepared (cmp[j], buf[j], &psk->pk.indcpa, kr[j] + KYBER_SYMBYTES);
+
+        verifyx4 (fail, e, c, KYBER_CIPHERTEXTBYTES);
+
+        sha3_256x4 (kr[0] + KYBER_SYMBYTES, kr[1] + KYBER_SYMBYTES, kr[2] + KYBER_SYMBYTES,
+                    kr[3] + KYBER_SYMBYTES, c[0], c[1], c[2], c[3],
+                    KYBER_CIPHERTEXTBYTES); /* overwrite coins in kr with H(c) */
+
+        for (j = 0; j < KYBER_BATCH_LANES; j++) /* Overwrite pre-k with z on re-encryption failure */
+            cmov (kr[j], psk->z, KYBER_SYMBYTES, fail[j]);
+
+        sha3_256x4 (k[0], k[1], k[2], k[3], kr[0], kr[1], kr[2], kr[3],
+                    2 * KYBER_SYMBYTES); /* hash concatenation of pre-k and H(c) to k */
+    }
+}
+
+/*************************************************
+ * Name:        kyber_kem_dec_batch
+ *
+ * Description: Runs kyber_kem_dec on n cipher texts under one private
+ *              key, which is unpacked and prepared once for the batch
+ *
+ * Arguments:   - unsigned char *ss:       pointer to output slab of n shared secrets
+ *              - const unsigned char *ct: pointer to input slab of n cipher texts
+ *              - size_t n:                number of cipher texts
+ *              - const unsigned char *sk: pointer to input private key (an already allocated array of KYBER_SECRETKEYBYTES bytes)
+ **************************************************/
+void kyber_kem_dec_batch (unsigned char *ss, const unsigned char *ct, size_t n, const unsigned char *sk) {
+    kyber_prepared_sk psk;
+
+    kyber_kem_prepare_sk (&psk, sk);
+    kyber_kem_dec_batch_prepared (ss, ct, n, &psk);
+}
+
+/* TESERAKT */
+void kyber_kem_dec_batch_cgo (char *ss, const char *ct, size_t n, const char *sk) {
+    kyber_kem_dec_batch ((unsigned char *)ss, (const unsigned char *)ct, n, (const unsigned char *)sk);
+}
+
+/* TESERAKT */
+void kyber_kem_dec_batch_prepared_cgo (char *ss, const char *ct, size_t n, const void *psk) {
+    kyber_kem_dec_batch_prepared ((unsigned char *)ss, (const unsigned char *)ct, n, psk);
+}
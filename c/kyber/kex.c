@@ -1,19 +1,31 @@
 #include "kex.h"
+#include "kyber_sets.h"
 #include "../fips202/fips202.h"
+#include "../randombytes/rng.h"
 #include "verify.h"
 
+/* The _rng variants draw the randomness of the handshakes from rng, NULL
+ * for the process-wide randombytes state */
+void kyber_uake_initA_rng (u8 *send, u8 *tk, u8 *sk, const u8 *pkb, rng_ctx *rng) {
+    kyber_kem_keypair_rng (send, sk, rng);
+    kyber_kem_enc_rng (send + KYBER_PUBLICKEYBYTES, tk, pkb, rng);
+}
+
 void kyber_uake_initA (u8 *send, u8 *tk, u8 *sk, const u8 *pkb) {
-    kyber_kem_keypair (send, sk);
-    kyber_kem_enc (send + KYBER_PUBLICKEYBYTES, tk, pkb);
+    kyber_uake_initA_rng (send, tk, sk, pkb, NULL);
 }
 
-void kyber_uake_sharedB (u8 *send, u8 *k, const u8 *recv, const u8 *skb) {
+void kyber_uake_sharedB_rng (u8 *send, u8 *k, const u8 *recv, const u8 *skb, rng_ctx *rng) {
     unsigned char buf[2 * KYBER_SYMBYTES];
-    kyber_kem_enc (send, buf, recv);
+    kyber_kem_enc_rng (send, buf, recv, rng);
     kyber_kem_dec (buf + KYBER_SYMBYTES, recv + KYBER_PUBLICKEYBYTES, skb);
     shake256 (k, KYBER_SYMBYTES, buf, 2 * KYBER_SYMBYTES);
 }
 
+void kyber_uake_sharedB (u8 *send, u8 *k, const u8 *recv, const u8 *skb) {
+    kyber_uake_sharedB_rng (send, k, recv, skb, NULL);
+}
+
 void kyber_uake_sharedA (u8 *k, const u8 *recv, const u8 *tk, const u8 *sk) {
     unsigned char buf[2 * KYBER_SYMBYTES];
     int i;
@@ -23,19 +35,26 @@ void kyber_uake_sharedA (u8 *k, const u8 *recv, const u8 *tk, const u8 *sk) {
 }
 
 
+void kyber_ake_initA_rng (u8 *send, u8 *tk, u8 *sk, const u8 *pkb, rng_ctx *rng) {
+    kyber_uake_initA_rng (send, tk, sk, pkb, rng);
+}
+
 void kyber_ake_initA (u8 *send, u8 *tk, u8 *sk, const u8 *pkb) {
-    kyber_kem_keypair (send, sk);
-    kyber_kem_enc (send + KYBER_PUBLICKEYBYTES, tk, pkb);
+    kyber_ake_initA_rng (send, tk, sk, pkb, NULL);
 }
 
-void kyber_ake_sharedB (u8 *send, u8 *k, const u8 *recv, const u8 *skb, const u8 *pka) {
+void kyber_ake_sharedB_rng (u8 *send, u8 *k, const u8 *recv, const u8 *skb, const u8 *pka, rng_ctx *rng) {
     unsigned char buf[3 * KYBER_SYMBYTES];
-    kyber_kem_enc (send, buf, recv);
-    kyber_kem_enc (send + KYBER_CIPHERTEXTBYTES, buf + KYBER_SYMBYTES, pka);
+    kyber_kem_enc_rng (send, buf, recv, rng);
+    kyber_kem_enc_rng (send + KYBER_CIPHERTEXTBYTES, buf + KYBER_SYMBYTES, pka, rng);
     kyber_kem_dec (buf + 2 * KYBER_SYMBYTES, recv + KYBER_PUBLICKEYBYTES, skb);
     shake256 (k, KYBER_SYMBYTES, buf, 3 * KYBER_SYMBYTES);
 }
 
+void kyber_ake_sharedB (u8 *send, u8 *k, const u8 *recv, const u8 *skb, const u8 *pka) {
+    kyber_ake_sharedB_rng (send, k, recv, skb, pka, NULL);
+}
+
 void kyber_ake_sharedA (u8 *k, const u8 *recv, const u8 *tk, const u8 *sk, const u8 *ska) {
     unsigned char buf[3 * KYBER_SYMBYTES];
     int i;
@@ -44,3 +63,53 @@ void kyber_ake_sharedA (u8 *k, const u8 *recv, const u8 *tk, const u8 *sk, const
     for (i = 0; i < KYBER_SYMBYTES; i++) buf[i + 2 * KYBER_SYMBYTES] = tk[i];
     shake256 (k, KYBER_SYMBYTES, buf, 3 * KYBER_SYMBYTES);
 }
+
+/* TESERAKT: each step of the handshakes in a single call. The state kept
+ * by A between its two steps is tk || sk, KYBER_KEX_STATEBYTES bytes; the
+ * steps that draw randomness seed their own rng_ctx with the 48 bytes of
+ * entropy and wipe it before returning. */
+int kyber_kex_initA_cgo (char *send, char *state, const char *pkb, const char *entropy, int rng_backend) {
+    rng_ctx rng;
+
+    if (rng_init (&rng, rng_backend, (const unsigned char *)entropy, NULL)) return -1;
+    kyber_uake_initA_rng ((u8 *)send, (u8 *)state, (u8 *)state + KYBER_SYMBYTES, (const u8 *)pkb, &rng);
+    rng_wipe (&rng);
+    return 0;
+}
+
+/* TESERAKT */
+int kyber_uake_sharedB_cgo (char *send, char *k, const char *recv, const char *skb, const char *entropy, int rng_backend) {
+    rng_ctx rng;
+
+    if (rng_init (&rng, rng_backend, (const unsigned char *)entropy, NULL)) return -1;
+    kyber_uake_sharedB_rng ((u8 *)send, (u8 *)k, (const u8 *)recv, (const u8 *)skb, &rng);
+    rng_wipe (&rng);
+    return 0;
+}
+
+/* TESERAKT */
+void kyber_uake_sharedA_cgo (char *k, const char *recv, const char *state) {
+    kyber_uake_sharedA ((u8 *)k, (const u8 *)recv, (const u8 *)state, (const u8 *)state + KYBER_SYMBYTES);
+}
+
+/* TESERAKT */
+int kyber_ake_sharedB_cgo (char *send,
+                           char *k,
+                           const char *recv,
+                           const char *skb,
+                           const char *pka,
+                           const char *entropy,
+                           int rng_backend) {
+    rng_ctx rng;
+
+    if (rng_init (&rng, rng_backend, (const unsigned char *)entropy, NULL)) return -1;
+    kyber_ake_sharedB_rng ((u8 *)send, (u8 *)k, (const u8 *)recv, (const u8 *)skb, (const u8 *)pka, &rng);
+    rng_wipe (&rng);
+    return 0;
+}
+
+/* TESERAKT */
+void kyber_ake_sharedA_cgo (char *k, const char *recv, const char *state, const char *ska) {
+    kyber_ake_sharedA ((u8 *)k, (const u8 *)recv, (const u8 *)state,
+                       (const u8 *)state + KYBER_SYMBYTES, (const u8 *)ska);
+}
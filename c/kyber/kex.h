@@ -1,28 +1,52 @@
 #ifndef KEX_H
 #define KEX_H
 
+#include "../randombytes/rng.h"
 #include "api.h"
 #include "params.h"
 
+#define kyber_uake_initA       KYBER_NAMESPACE (uake_initA)
+#define kyber_uake_initA_rng   KYBER_NAMESPACE (uake_initA_rng)
+#define kyber_uake_sharedB     KYBER_NAMESPACE (uake_sharedB)
+#define kyber_uake_sharedB_rng KYBER_NAMESPACE (uake_sharedB_rng)
+#define kyber_uake_sharedA     KYBER_NAMESPACE (uake_sharedA)
+#define kyber_ake_initA        KYBER_NAMESPACE (ake_initA)
+#define kyber_ake_initA_rng    KYBER_NAMESPACE (ake_initA_rng)
+#define kyber_ake_sharedB      KYBER_NAMESPACE (ake_sharedB)
+#define kyber_ake_sharedB_rng  KYBER_NAMESPACE (ake_sharedB_rng)
+#define kyber_ake_sharedA      KYBER_NAMESPACE (ake_sharedA)
+#define kyber_kex_initA_cgo    KYBER_NAMESPACE (kex_initA_cgo)
+#define kyber_uake_sharedB_cgo KYBER_NAMESPACE (uake_sharedB_cgo)
+#define kyber_uake_sharedA_cgo KYBER_NAMESPACE (uake_sharedA_cgo)
+#define kyber_ake_sharedB_cgo  KYBER_NAMESPACE (ake_sharedB_cgo)
+#define kyber_ake_sharedA_cgo  KYBER_NAMESPACE (ake_sharedA_cgo)
+
 #define KYBER_UAKE_SENDABYTES (KYBER_PUBLICKEYBYTES + KYBER_CIPHERTEXTBYTES)
 #define KYBER_UAKE_SENDBBYTES (KYBER_CIPHERTEXTBYTES)
 
 #define KYBER_AKE_SENDABYTES (KYBER_PUBLICKEYBYTES + KYBER_CIPHERTEXTBYTES)
 #define KYBER_AKE_SENDBBYTES (2 * KYBER_CIPHERTEXTBYTES)
 
+/* What A keeps between its two steps: tk and the ephemeral sk */
+#define KYBER_KEX_STATEBYTES (KYBER_SYMBYTES + KYBER_SECRETKEYBYTES)
+
 
 typedef unsigned char u8;
 
 void kyber_uake_initA (u8 *send, u8 *tk, u8 *sk, const u8 *pkb);
+void kyber_uake_initA_rng (u8 *send, u8 *tk, u8 *sk, const u8 *pkb, rng_ctx *rng);
 
 void kyber_uake_sharedB (u8 *send, u8 *k, const u8 *recv, const u8 *skb);
+void kyber_uake_sharedB_rng (u8 *send, u8 *k, const u8 *recv, const u8 *skb, rng_ctx *rng);
 
 void kyber_uake_sharedA (u8 *k, const u8 *recv, const u8 *tk, const u8 *sk);
 
 
 void kyber_ake_initA (u8 *send, u8 *tk, u8 *sk, const u8 *pkb);
+void kyber_ake_initA_rng (u8 *send, u8 *tk, u8 *sk, const u8 *pkb, rng_ctx *rng);
 
 void kyber_ake_sharedB (u8 *send, u8 *k, const u8 *recv, const u8 *skb, const u8 *pka);
+void kyber_ake_sharedB_rng (u8 *send, u8 *k, const u8 *recv, const u8 *skb, const u8 *pka, rng_ctx *rng);
 
 void kyber_ake_sharedA (u8 *k, const u8 *recv, const u8 *tk, const u8 *sk, const u8 *ska);
 
@@ -0,0 +1,320 @@
+/* Compression and serialization of single polynomials: 11 bits per
+ * coefficient for the vector part of public keys and cipher texts, 3 bits
+ * for the polynomial v of cipher texts. The AVX2 kernels compute the same
+ * rounded quotients with multiply-high instructions instead of divisions
+ * and pack the bits with byte shuffles and variable shifts. */
+
+#include "kyber_compress.h"
+#include "kyber_reduce.h"
+#include "params.h"
+#include <string.h>
+
+/*************************************************
+ * Name:        kyber_compress11_ref
+ *
+ * Description: Compression of a polynomial to 11 bits per coefficient
+ *              and serialization to 352 bytes
+ *
+ * Arguments:   - unsigned char *r:   pointer to output byte array
+ *              - const uint16_t *a:  pointer to input coefficients
+ **************************************************/
+void kyber_compress11_ref (unsigned char *r, const uint16_t *a) {
+    int j, k;
+    uint16_t t[8];
+
+    for (j = 0; j < KYBER_N / 8; j++) {
+        for (k = 0; k < 8; k++)
+            t[k] = ((((uint32_t)freeze16 (a[8 * j + k]) << 11) + KYBER_Q / 2) / KYBER_Q) & 0x7ff;
+
+        r[11 * j + 0] = t[0] & 0xff;
+        r[11 * j + 1] = (t[0] >> 8) | ((t[1] & 0x1f) << 3);
+        r[11 * j + 2] = (t[1] >> 5) | ((t[2] & 0x03) << 6);
+        r[11 * j + 3] = (t[2] >> 2) & 0xff;
+        r[11 * j + 4] = (t[2] >> 10) | ((t[3] & 0x7f) << 1);
+        r[11 * j + 5] = (t[3] >> 7) | ((t[4] & 0x0f) << 4);
+        r[11 * j + 6] = (t[4] >> 4) | ((t[5] & 0x01) << 7);
+        r[11 * j + 7] = (t[5] >> 1) & 0xff;
+        r[11 * j + 8] = (t[5] >> 9) | ((t[6] & 0x3f) << 2);
+        r[11 * j + 9] = (t[6] >> 6) | ((t[7] & 0x07) << 5);
+        r[11 * j + 10] = (t[7] >> 3);
+    }
+}
+
+/*************************************************
+ * Name:        kyber_decompress11_ref
+ *
+ * Description: De-serialization and decompression of 352 bytes;
+ *              approximate inverse of kyber_compress11_ref
+ *
+ * Arguments:   - uint16_t *r:             pointer to output coefficients
+ *              - const unsigned char *a:  pointer to input byte array
+ **************************************************/
+void kyber_decompress11_ref (uint16_t *r, const unsigned char *a) {
+    int j;
+
+    for (j = 0; j < KYBER_N / 8; j++) {
+        r[8 * j + 0] = (((a[11 * j + 0] | (((uint32_t)a[11 * j + 1] & 0x07) << 8)) * KYBER_Q) + 1024) >> 11;
+        r[8 * j + 1] =
+        ((((a[11 * j + 1] >> 3) | (((uint32_t)a[11 * j + 2] & 0x3f) << 5)) * KYBER_Q) + 1024) >> 11;
+        r[8 * j + 2] = ((((a[11 * j + 2] >> 6) | (((uint32_t)a[11 * j + 3] & 0xff) << 2) |
+                          (((uint32_t)a[11 * j + 4] & 0x01) << 10)) *
+                         KYBER_Q) +
+                        1024) >>
+                       11;
+        r[8 * j + 3] =
+        ((((a[11 * j + 4] >> 1) | (((uint32_t)a[11 * j + 5] & 0x0f) << 7)) * KYBER_Q) + 1024) >> 11;
+        r[8 * j + 4] =
+        ((((a[11 * j + 5] >> 4) | (((uint32_t)a[11 * j + 6] & 0x7f) << 4)) * KYBER_Q) + 1024) >> 11;
+        r[8 * j + 5] = ((((a[11 * j + 6] >> 7) | (((uint32_t)a[11 * j + 7] & 0xff) << 1) |
+                          (((uint32_t)a[11 * j + 8] & 0x03) << 9)) *
+                         KYBER_Q) +
+                        1024) >>
+                       11;
+        r[8 * j + 6] =
+        ((((a[11 * j + 8] >> 2) | (((uint32_t)a[11 * j + 9] & 0x1f) << 6)) * KYBER_Q) + 1024) >> 11;
+        r[8 * j + 7] =
+        ((((a[11 * j + 9] >> 5) | (((uint32_t)a[11 * j + 10] & 0xff) << 3)) * KYBER_Q) + 1024) >> 11;
+    }
+}
+
+/*************************************************
+ * Name:        kyber_compress3_ref
+ *
+ * Description: Compression of a polynomial to 3 bits per coefficient
+ *              and serialization to 96 bytes
+ *
+ * Arguments:   - unsigned char *r:   pointer to output byte array
+ *              - const uint16_t *a:  pointer to input coefficients
+ **************************************************/
+void kyber_compress3_ref (unsigned char *r, const uint16_t *a) {
+    uint32_t t[8];
+    unsigned int i, j, k = 0;
+
+    for (i = 0; i < KYBER_N; i += 8) {
+        for (j = 0; j < 8; j++)
+            t[j] = (((freeze16 (a[i + j]) << 3) + KYBER_Q / 2) / KYBER_Q) & 7;
+
+        r[k] = t[0] | (t[1] << 3) | (t[2] << 6);
+        r[k + 1] = (t[2] >> 2) | (t[3] << 1) | (t[4] << 4) | (t[5] << 7);
+        r[k + 2] = (t[5] >> 1) | (t[6] << 2) | (t[7] << 5);
+        k += 3;
+    }
+}
+
+/*************************************************
+ * Name:        kyber_decompress3_ref
+ *
+ * Description: De-serialization and decompression of 96 bytes;
+ *              approximate inverse of kyber_compress3_ref
+ *
+ * Arguments:   - uint16_t *r:             pointer to output coefficients
+ *              - const unsigned char *a:  pointer to input byte array
+ **************************************************/
+void kyber_decompress3_ref (uint16_t *r, const unsigned char *a) {
+    unsigned int i;
+
+    for (i = 0; i < KYBER_N; i += 8) {
+        r[i + 0] = (((a[0] & 7) * KYBER_Q) + 4) >> 3;
+        r[i + 1] = ((((a[0] >> 3) & 7) * KYBER_Q) + 4) >> 3;
+        r[i + 2] = ((((a[0] >> 6) | ((a[1] << 2) & 4)) * KYBER_Q) + 4) >> 3;
+        r[i + 3] = ((((a[1] >> 1) & 7) * KYBER_Q) + 4) >> 3;
+        r[i + 4] = ((((a[1] >> 4) & 7) * KYBER_Q) + 4) >> 3;
+        r[i + 5] = ((((a[1] >> 7) | ((a[2] << 1) & 6)) * KYBER_Q) + 4) >> 3;
+        r[i + 6] = ((((a[2] >> 2) & 7) * KYBER_Q) + 4) >> 3;
+        r[i + 7] = ((((a[2] >> 5)) * KYBER_Q) + 4) >> 3;
+        a += 3;
+    }
+}
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+
+/* freeze16 in 16-bit lanes: the Barrett step leaves a value below 2q, and
+ * the unsigned minimum with a - q subtracts q when that does not wrap */
+static inline __attribute__ ((target ("avx2"), always_inline)) __m256i kyber_freeze_avx2 (__m256i a) {
+    const __m256i q = _mm256_set1_epi16 (KYBER_Q);
+
+    a = _mm256_sub_epi16 (a, _mm256_mullo_epi16 (_mm256_srli_epi16 (a, 13), q));
+    return _mm256_min_epu16 (a, _mm256_sub_epi16 (a, q));
+}
+
+/* (a * c + d) >> 16 for a < q, with d = dhi * 2^16 + dlo, from the high
+ * and low halves of the product and the carry of the low addition. For
+ * the constants below it equals ((a << k) + q/2) / q for all a < q,
+ * checked exhaustively. */
+static inline __attribute__ ((target ("avx2"), always_inline)) __m256i
+kyber_mulshift_avx2 (__m256i a, __m256i c, __m256i dlo, __m256i dhi) {
+    const __m256i sign = _mm256_set1_epi16 ((int16_t)0x8000);
+    __m256i lo, hi, s;
+
+    lo = _mm256_mullo_epi16 (a, c);
+    hi = _mm256_mulhi_epu16 (a, c);
+    s = _mm256_add_epi16 (lo, dlo);
+    /* the low addition carries iff s < lo as unsigned; the mask is -1 */
+    hi = _mm256_sub_epi16 (hi, _mm256_cmpgt_epi16 (_mm256_xor_si256 (lo, sign), _mm256_xor_si256 (s, sign)));
+    return _mm256_add_epi16 (hi, dhi);
+}
+
+/* round (2^11 a / q) = (a * 17474 + 32730) >> 16 */
+#define KYBER_C11 17474
+#define KYBER_D11 32730
+/* round (2^3 a / q) = (a * 4369 + 31 * 2^16 + 62262) >> 22 */
+#define KYBER_C3 4369
+#define KYBER_D3HI 31
+#define KYBER_D3LO 62262
+
+/*************************************************
+ * Name:        kyber_compress11_avx2
+ *
+ * Description: kyber_compress11_ref on 16 coefficients per step: pairs are
+ *              joined to 22 bits with madd, pairs of those to 44 bits in
+ *              each quadword, and the two quadwords of each 128-bit lane
+ *              are merged bytewise into its 11 output bytes.
+ **************************************************/
+__attribute__ ((target ("avx2"))) void kyber_compress11_avx2 (unsigned char *r, const uint16_t *a) {
+    const __m256i c = _mm256_set1_epi16 (KYBER_C11);
+    const __m256i dlo = _mm256_set1_epi16 (KYBER_D11);
+    const __m256i zero = _mm256_setzero_si256 ();
+    const __m256i mask = _mm256_set1_epi16 (0x7ff);
+    const __m256i join = _mm256_set1_epi32 (2048 << 16 | 1);
+    const __m256i sllv32 = _mm256_set1_epi64x (10);
+    const __m256i sllv64 = _mm256_set_epi64x (4, 0, 4, 0);
+    const __m256i shufa = _mm256_set_epi8 (-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 5, 4, 3, 2, 1, 0,
+                                           -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 5, 4, 3, 2, 1, 0);
+    const __m256i shufb = _mm256_set_epi8 (-1, -1, -1, -1, -1, 13, 12, 11, 10, 9, 8, -1, -1, -1, -1, -1,
+                                           -1, -1, -1, -1, -1, 13, 12, 11, 10, 9, 8, -1, -1, -1, -1, -1);
+    unsigned char t[32];
+    __m256i f;
+    int i;
+
+    for (i = 0; i < KYBER_N / 16; i++) {
+        f = _mm256_loadu_si256 ((const __m256i *)(a + 16 * i));
+        f = kyber_mulshift_avx2 (kyber_freeze_avx2 (f), c, dlo, zero);
+        f = _mm256_and_si256 (f, mask);
+
+        f = _mm256_madd_epi16 (f, join);                                        /* t0 | t1 << 11 */
+        f = _mm256_srli_epi64 (_mm256_sllv_epi32 (f, sllv32), 10);              /* 4 values in 44 bits */
+        f = _mm256_sllv_epi64 (f, sllv64);                                      /* odd quadwords start at bit 4 */
+        f = _mm256_or_si256 (_mm256_shuffle_epi8 (f, shufa), _mm256_shuffle_epi8 (f, shufb));
+
+        if (i < KYBER_N / 16 - 1) {
+            _mm_storeu_si128 ((__m128i *)(r + 22 * i), _mm256_castsi256_si128 (f));
+            _mm_storeu_si128 ((__m128i *)(r + 22 * i + 11), _mm256_extracti128_si256 (f, 1));
+        } else { /* the 16-byte stores would run past the end */
+            _mm256_storeu_si256 ((__m256i *)t, f);
+            memcpy (r + 22 * i, t, 11);
+            memcpy (r + 22 * i + 11, t + 16, 11);
+        }
+    }
+}
+
+/*************************************************
+ * Name:        kyber_decompress11_avx2
+ *
+ * Description: kyber_decompress11_ref on 22 bytes per step: each
+ *              doubleword gathers the 4 bytes holding a pair of values,
+ *              which a variable shift aligns and masks split into words.
+ *              (x q + 2^10) >> 11 is mulhrs (16 x, q).
+ **************************************************/
+__attribute__ ((target ("avx2"))) void kyber_decompress11_avx2 (uint16_t *r, const unsigned char *a) {
+    const __m256i q = _mm256_set1_epi16 (KYBER_Q);
+    const __m256i shuf = _mm256_set_epi8 (-1, 10, 9, 8, 8, 7, 6, 5, 5, 4, 3, 2, 3, 2, 1, 0,
+                                          -1, 10, 9, 8, 8, 7, 6, 5, 5, 4, 3, 2, 3, 2, 1, 0);
+    const __m256i srlv = _mm256_set_epi32 (2, 4, 6, 0, 2, 4, 6, 0);
+    const __m256i mlo = _mm256_set1_epi32 (0x7ff);
+    const __m256i mhi = _mm256_set1_epi32 (0x7ff << 16);
+    unsigned char t[27] = { 0 };
+    __m256i f;
+    int i;
+
+    for (i = 0; i < KYBER_N / 16; i++) {
+        if (i < KYBER_N / 16 - 1) {
+            f = _mm256_loadu2_m128i ((const __m128i *)(a + 22 * i + 11), (const __m128i *)(a + 22 * i));
+        } else { /* the 16-byte loads would run past the end */
+            memcpy (t, a + 22 * i, 22);
+            f = _mm256_loadu2_m128i ((const __m128i *)(t + 11), (const __m128i *)t);
+        }
+        f = _mm256_srlv_epi32 (_mm256_shuffle_epi8 (f, shuf), srlv);
+        f = _mm256_or_si256 (_mm256_and_si256 (f, mlo), _mm256_and_si256 (_mm256_slli_epi32 (f, 5), mhi));
+        f = _mm256_mulhrs_epi16 (_mm256_slli_epi16 (f, 4), q);
+        _mm256_storeu_si256 ((__m256i *)(r + 16 * i), f);
+    }
+}
+
+/*************************************************
+ * Name:        kyber_compress3_avx2
+ *
+ * Description: kyber_compress3_ref on 32 coefficients per step: the values
+ *              are narrowed to bytes and joined by twos, fours and eights
+ *              with maddubs, madd and a quadword shift, 3 bytes per
+ *              quadword.
+ **************************************************/
+__attribute__ ((target ("avx2"))) void kyber_compress3_avx2 (unsigned char *r, const uint16_t *a) {
+    const __m256i c = _mm256_set1_epi16 (KYBER_C3);
+    const __m256i dlo = _mm256_set1_epi16 ((int16_t)KYBER_D3LO);
+    const __m256i dhi = _mm256_set1_epi16 (KYBER_D3HI);
+    const __m256i mask = _mm256_set1_epi16 (7);
+    const __m256i join2 = _mm256_set1_epi16 (8 << 8 | 1);
+    const __m256i join4 = _mm256_set1_epi32 (64 << 16 | 1);
+    const __m256i sllv32 = _mm256_set1_epi64x (20);
+    const __m256i shuf = _mm256_set_epi8 (-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 10, 9, 8, 2, 1, 0,
+                                          -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 10, 9, 8, 2, 1, 0);
+    unsigned char t[32];
+    __m256i f0, f1;
+    int i;
+
+    for (i = 0; i < KYBER_N / 32; i++) {
+        f0 = _mm256_loadu_si256 ((const __m256i *)(a + 32 * i));
+        f1 = _mm256_loadu_si256 ((const __m256i *)(a + 32 * i + 16));
+        f0 = _mm256_srli_epi16 (kyber_mulshift_avx2 (kyber_freeze_avx2 (f0), c, dlo, dhi), 6);
+        f1 = _mm256_srli_epi16 (kyber_mulshift_avx2 (kyber_freeze_avx2 (f1), c, dlo, dhi), 6);
+        f0 = _mm256_and_si256 (f0, mask);
+        f1 = _mm256_and_si256 (f1, mask);
+
+        /* packus interleaves the 128-bit lanes; the permutation restores the order */
+        f0 = _mm256_permute4x64_epi64 (_mm256_packus_epi16 (f0, f1), 0xD8);
+        f0 = _mm256_maddubs_epi16 (f0, join2);                            /* 2 values in 6 bits */
+        f0 = _mm256_madd_epi16 (f0, join4);                               /* 4 values in 12 bits */
+        f0 = _mm256_srli_epi64 (_mm256_sllv_epi32 (f0, sllv32), 20);      /* 8 values in 24 bits */
+        f0 = _mm256_shuffle_epi8 (f0, shuf);
+
+        _mm256_storeu_si256 ((__m256i *)t, f0);
+        memcpy (r + 12 * i, t, 6);
+        memcpy (r + 12 * i + 6, t + 16, 6);
+    }
+}
+
+/*************************************************
+ * Name:        kyber_decompress3_avx2
+ *
+ * Description: kyber_decompress3_ref on 6 bytes per step: each word gathers
+ *              the 2 bytes holding a value, and a multiplication moves the
+ *              value to the top bits; (x q + 4) >> 3 is mulhrs (x << 12, q).
+ **************************************************/
+__attribute__ ((target ("avx2"))) void kyber_decompress3_avx2 (uint16_t *r, const unsigned char *a) {
+    const __m256i q = _mm256_set1_epi16 (KYBER_Q);
+    const __m256i shuf = _mm256_set_epi8 (6, 5, 6, 5, 5, 4, 5, 4, 5, 4, 4, 3, 4, 3, 4, 3,
+                                          3, 2, 3, 2, 2, 1, 2, 1, 2, 1, 1, 0, 1, 0, 1, 0);
+    const __m256i sllv = _mm256_set_epi16 (1 << 8, 1 << 11, 1 << 6, 1 << 9, 1 << 12, 1 << 7, 1 << 10, 1 << 13,
+                                           1 << 8, 1 << 11, 1 << 6, 1 << 9, 1 << 12, 1 << 7, 1 << 10, 1 << 13);
+    const __m256i mask = _mm256_set1_epi16 (0x7000);
+    uint64_t t;
+    __m256i f;
+    int i;
+
+    for (i = 0; i < KYBER_N / 16; i++) {
+        t = 0;
+        memcpy (&t, a + 6 * i, i < KYBER_N / 16 - 1 ? 8 : 6); /* 8 bytes would run past the end */
+        f = _mm256_shuffle_epi8 (_mm256_set1_epi64x ((long long)t), shuf);
+        f = _mm256_and_si256 (_mm256_srli_epi16 (_mm256_mullo_epi16 (f, sllv), 1), mask);
+        f = _mm256_mulhrs_epi16 (f, q);
+        _mm256_storeu_si256 ((__m256i *)(r + 16 * i), f);
+    }
+}
+
+#undef KYBER_C11
+#undef KYBER_D11
+#undef KYBER_C3
+#undef KYBER_D3HI
+#undef KYBER_D3LO
+#endif
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <stdint.h>
+
+/* Compression of one polynomial to 11 bits (352 bytes) or 3 bits (96 bytes)
+ * per coefficient, and the inverse decompression */
+void kyber_compress11 (unsigned char *r, const uint16_t *a);
+void kyber_decompress11 (uint16_t *r, const unsigned char *a);
+void kyber_compress3 (unsigned char *r, const uint16_t *a);
+void kyber_decompress3 (uint16_t *r, const unsigned char *a);
+
+void kyber_compress11_ref (unsigned char *r, const uint16_t *a);
+void kyber_decompress11_ref (uint16_t *r, const unsigned char *a);
+void kyber_compress3_ref (unsigned char *r, const uint16_t *a);
+void kyber_decompress3_ref (uint16_t *r, const unsigned char *a);
+#if defined(__x86_64__)
+void kyber_compress11_avx2 (unsigned char *r, const uint16_t *a);
+void kyber_decompress11_avx2 (uint16_t *r, const unsigned char *a);
+void kyber_compress3_avx2 (unsigned char *r, const uint16_t *a);
+void kyber_decompress3_avx2 (uint16_t *r, const unsigned char *a);
+#endif
@@ -8,7 +8,7 @@ extern const uint16_t kyber_psis_inv_montgomery[];
 extern const uint16_t kyber_zetas[];
 
 /*************************************************
- * Name:        ntt
+ * Name:        kyber_ntt_ref
  *
  * Description: Computes negacyclic number-theoretic transform (NTT) of
  *              a polynomial (vector of 256 coefficients) in place;
@@ -16,7 +16,7 @@ extern const uint16_t kyber_zetas[];
  *
  * Arguments:   - uint16_t *p: pointer to in/output polynomial
  **************************************************/
-void kyber_ntt (uint16_t *p) {
+void kyber_ntt_ref (uint16_t *p) {
     int level, start, j, k;
     uint16_t zeta, t;
 
@@ -39,7 +39,7 @@ void kyber_ntt (uint16_t *p) {
 }
 
 /*************************************************
- * Name:        invntt
+ * Name:        kyber_invntt_ref
  *
  * Description: Computes inverse of negacyclic number-theoretic transform (NTT) of
  *              a polynomial (vector of 256 coefficients) in place;
@@ -47,7 +47,7 @@ void kyber_ntt (uint16_t *p) {
  *
  * Arguments:   - uint16_t *a: pointer to in/output polynomial
  **************************************************/
-void kyber_invntt (uint16_t *a) {
+void kyber_invntt_ref (uint16_t *a) {
     int start, j, jTwiddle, level;
     uint16_t temp, W;
     uint32_t t;
@@ -74,3 +74,401 @@ void kyber_invntt (uint16_t *a) {
     for (j = 0; j < KYBER_N; j++)
         a[j] = kyber_montgomery_reduce ((a[j] * kyber_psis_inv_montgomery[j]));
 }
+
+/* The portable kernels below work on two coefficients at a time, held in
+ * the 32-bit halves of a uint64_t: the products, reductions and sums of
+ * kyber_ntt_ref never carry across the halves for the bounds noted below,
+ * and sums are masked back to 16 bits as stores to uint16_t would do. */
+#define KYBER_X2(lo, hi) ((uint64_t)(lo) | (uint64_t)(hi) << 32)
+#define KYBER_M14 KYBER_X2 (0x3FFF, 0x3FFF)
+#define KYBER_M16 KYBER_X2 (0xFFFF, 0xFFFF)
+#define KYBER_M18 KYBER_X2 (0x3FFFF, 0x3FFFF)
+
+/* kyber_montgomery_reduce of two products below 2^29 */
+static inline uint64_t kyber_montgomery_reduce_x2 (uint64_t a) {
+    uint64_t u = ((a & KYBER_M18) * 7679) & KYBER_M18;
+
+    return ((a + u * KYBER_Q) >> 18) & KYBER_M14;
+}
+
+/* barrett_reduce of two 16-bit coefficients */
+static inline uint64_t barrett_reduce_x2 (uint64_t a) {
+    return a - ((a >> 13) & KYBER_X2 (7, 7)) * KYBER_Q;
+}
+
+/* Butterfly of kyber_ntt_ref; zb is the product of b with its zetas. The
+ * Montgomery output is below 2^14 < 4q, so a + 4q - t stays positive. */
+static inline void kyber_ntt_butterfly_x2 (uint64_t *a, uint64_t *b, uint64_t zb, int lazy) {
+    uint64_t t = kyber_montgomery_reduce_x2 (zb);
+
+    *b = barrett_reduce_x2 ((*a + KYBER_X2 (4 * KYBER_Q, 4 * KYBER_Q) - t) & KYBER_M16);
+    *a = (*a + t) & KYBER_M16;
+    if (!lazy) *a = barrett_reduce_x2 (*a);
+}
+
+/* Butterfly of kyber_invntt_ref; returns the difference a + 4q - b to be
+ * multiplied by the twiddles and sets a to the sum. For inputs below 2q
+ * the sums entering an odd level stay below 4q and every difference lies
+ * in (0, 8q), so it fits the lane and needs no wrap-around. */
+static inline uint64_t kyber_invntt_butterfly_x2 (uint64_t *a, uint64_t b, int lazy) {
+    uint64_t t = *a;
+
+    *a = (t + b) & KYBER_M16;
+    if (!lazy) *a = barrett_reduce_x2 (*a);
+    return t + KYBER_X2 (4 * KYBER_Q, 4 * KYBER_Q) - b;
+}
+
+/* Zeta of kyber_ntt_ref for the butterfly at position pos of a level */
+#define KYBER_ZETA(level, pos) kyber_zetas[(128 >> (level)) + ((pos) >> ((level) + 1))]
+
+/* Twiddle of kyber_invntt_ref for the butterfly at position pos of a level */
+#define KYBER_OMEGA(level, pos) kyber_omegas_inv_bitrev_montgomery[(pos) >> ((level) + 1)]
+
+/*************************************************
+ * Name:        kyber_ntt_opt
+ *
+ * Description: Same as kyber_ntt_ref, bit for bit. The polynomial is held
+ *              as pairs of coefficients and transformed two levels per
+ *              pass: each radix-4 step loads four pairs at distance
+ *              len = 2^level, runs the butterflies of levels level + 1 and
+ *              level on them and stores them back. The upper level of each
+ *              pair is odd, so its sums stay unreduced as in kyber_ntt_ref,
+ *              and the even level reduces everything; the reduction
+ *              schedule is fixed at compile time.
+ *
+ * Arguments:   - uint16_t *p: pointer to in/output polynomial
+ **************************************************/
+void kyber_ntt_opt (uint16_t *p) {
+    uint64_t w[KYBER_N / 2], z1, z2, z3, x0, x1, x2, x3;
+    int level, len, start, j;
+
+    for (j = 0; j < KYBER_N / 2; j++) w[j] = KYBER_X2 (p[2 * j], p[2 * j + 1]);
+
+    /* levels 7 to 2, pair j holding coefficients 2j and 2j + 1 */
+    for (level = 6; level >= 2; level -= 2) {
+        len = 1 << level;
+        for (start = 0; start < KYBER_N; start += 4 * len) {
+            z1 = KYBER_ZETA (level + 1, start);
+            z2 = KYBER_ZETA (level, start);
+            z3 = KYBER_ZETA (level, start + 2 * len);
+            for (j = start / 2; j < (start + len) / 2; j++) {
+                x0 = w[j];
+                x1 = w[j + len / 2];
+                x2 = w[j + len];
+                x3 = w[j + 3 * len / 2];
+                kyber_ntt_butterfly_x2 (&x0, &x2, z1 * x2, 1);
+                kyber_ntt_butterfly_x2 (&x1, &x3, z1 * x3, 1);
+                kyber_ntt_butterfly_x2 (&x0, &x1, z2 * x1, 0);
+                kyber_ntt_butterfly_x2 (&x2, &x3, z3 * x3, 0);
+                w[j] = x0;
+                w[j + len / 2] = x1;
+                w[j + len] = x2;
+                w[j + 3 * len / 2] = x3;
+            }
+        }
+    }
+
+    /* levels 1 and 0 on blocks of four coefficients c0..c3: level 1 pairs
+     * (c0, c1) with (c2, c3), level 0 pairs (c0, c2) with (c1, c3) */
+    for (start = 0; start < KYBER_N; start += 4) {
+        x0 = w[start / 2];
+        x2 = w[start / 2 + 1];
+        kyber_ntt_butterfly_x2 (&x0, &x2, KYBER_ZETA (1, start) * x2, 1);
+
+        x1 = (x0 >> 32) | (x2 >> 32 << 32);
+        x0 = (x0 & 0xFFFF) | (x2 << 32);
+        x2 = KYBER_X2 (KYBER_ZETA (0, start) * (x1 & 0xFFFF), KYBER_ZETA (0, start + 2) * (x1 >> 32));
+        kyber_ntt_butterfly_x2 (&x0, &x1, x2, 0);
+
+        p[start] = x0;
+        p[start + 1] = x1;
+        p[start + 2] = x0 >> 32;
+        p[start + 3] = x1 >> 32;
+    }
+}
+
+/*************************************************
+ * Name:        kyber_invntt_opt
+ *
+ * Description: Same as kyber_invntt_ref, bit for bit for coefficients below
+ *              2q (kyber_polyvec_pointwise_acc returns them below 11769),
+ *              two levels per pass as in kyber_ntt_opt: the even level of
+ *              each pair leaves its sums unreduced, the odd one reduces
+ *              them. The last pass also applies the final multiplication
+ *              by kyber_psis_inv_montgomery.
+ *
+ * Arguments:   - uint16_t *a: pointer to in/output polynomial
+ **************************************************/
+void kyber_invntt_opt (uint16_t *a) {
+    uint64_t w[KYBER_N / 2], w1, w2, w3, x0, x1, x2, x3, v;
+    int level, len, start, j;
+
+    /* levels 0 and 1 on blocks of four coefficients, see kyber_ntt_opt */
+    for (start = 0; start < KYBER_N; start += 4) {
+        x0 = KYBER_X2 (a[start], a[start + 2]);
+        x1 = KYBER_X2 (a[start + 1], a[start + 3]);
+        v = kyber_invntt_butterfly_x2 (&x0, x1, 1);
+        x1 = kyber_montgomery_reduce_x2 (KYBER_X2 (KYBER_OMEGA (0, start) * (v & 0xFFFF),
+                                                   KYBER_OMEGA (0, start + 2) * (v >> 32)));
+
+        x2 = (x0 >> 32) | (x1 >> 32 << 32);
+        x0 = (x0 & 0xFFFF) | (x1 << 32);
+        v = kyber_invntt_butterfly_x2 (&x0, x2, 0);
+        w[start / 2] = x0;
+        w[start / 2 + 1] = kyber_montgomery_reduce_x2 (KYBER_OMEGA (1, start) * v);
+    }
+
+    /* levels 2 to 7 */
+    for (level = 2; level < 8; level += 2) {
+        len = 1 << level;
+        for (start = 0; start < KYBER_N; start += 4 * len) {
+            w1 = KYBER_OMEGA (level, start);
+            w2 = KYBER_OMEGA (level, start + 2 * len);
+            w3 = KYBER_OMEGA (level + 1, start);
+            for (j = start / 2; j < (start + len) / 2; j++) {
+                x0 = w[j];
+                x1 = w[j + len / 2];
+                x2 = w[j + len];
+                x3 = w[j + 3 * len / 2];
+                x1 = kyber_montgomery_reduce_x2 (w1 * kyber_invntt_butterfly_x2 (&x0, x1, 1));
+                x3 = kyber_montgomery_reduce_x2 (w2 * kyber_invntt_butterfly_x2 (&x2, x3, 1));
+                x2 = kyber_montgomery_reduce_x2 (w3 * kyber_invntt_butterfly_x2 (&x0, x2, 0));
+                x3 = kyber_montgomery_reduce_x2 (w3 * kyber_invntt_butterfly_x2 (&x1, x3, 0));
+                w[j] = x0;
+                w[j + len / 2] = x1;
+                w[j + len] = x2;
+                w[j + 3 * len / 2] = x3;
+            }
+        }
+    }
+
+    for (j = 0; j < KYBER_N / 2; j++) {
+        v = kyber_montgomery_reduce_x2 (KYBER_X2 (kyber_psis_inv_montgomery[2 * j] * (w[j] & 0xFFFF),
+                                                  kyber_psis_inv_montgomery[2 * j + 1] * (w[j] >> 32)));
+        a[2 * j] = v;
+        a[2 * j + 1] = v >> 32;
+    }
+}
+
+#undef KYBER_ZETA
+#undef KYBER_OMEGA
+
+#if defined(__x86_64__)
+
+#include <immintrin.h>
+
+extern const uint16_t kyber_zetas_avx2[];
+extern const uint16_t kyber_omegas_inv_avx2[];
+
+/*************************************************
+ * Name:        kyber_montmul_avx2
+ *
+ * Description: Sixteen-way kyber_montgomery_reduce (z * b) in 16-bit lanes,
+ *              exact for z < 2^13. With a = z * b = hi * 2^16 + lo and
+ *              u = a * qinv mod 2^18 = uh * 2^16 + ul, the low halves of a
+ *              and u * q sum to 2^16 if lo != 0 and to 0 otherwise, so
+ *              (a + u * q) >> 18 = (hi + uh * q + (ul * q >> 16) + (lo != 0)) >> 2,
+ *              where the sum stays below 2^16.
+ *
+ * Arguments:   - __m256i z: sixteen multipliers below 2^13
+ *              - __m256i b: sixteen coefficients
+ *
+ * Returns the sixteen reduced products.
+ **************************************************/
+static inline __attribute__ ((target ("avx2"), always_inline)) __m256i
+kyber_montmul_avx2 (__m256i z, __m256i b) {
+    const __m256i qinv = _mm256_set1_epi16 (7679);
+    const __m256i q = _mm256_set1_epi16 (KYBER_Q);
+    const __m256i one = _mm256_set1_epi16 (1);
+    __m256i lo, hi, ul, uh;
+
+    lo = _mm256_mullo_epi16 (z, b);
+    hi = _mm256_mulhi_epu16 (z, b);
+    ul = _mm256_mullo_epi16 (lo, qinv);
+    uh = _mm256_add_epi16 (_mm256_mulhi_epu16 (lo, qinv), _mm256_mullo_epi16 (hi, qinv));
+    uh = _mm256_and_si256 (uh, _mm256_set1_epi16 (3));
+
+    hi = _mm256_add_epi16 (hi, _mm256_mullo_epi16 (uh, q));
+    hi = _mm256_add_epi16 (hi, _mm256_mulhi_epu16 (ul, q));
+    hi = _mm256_add_epi16 (hi, one);
+    hi = _mm256_add_epi16 (hi, _mm256_cmpeq_epi16 (lo, _mm256_setzero_si256 ()));
+    return _mm256_srli_epi16 (hi, 2);
+}
+
+/* barrett_reduce in 16-bit lanes */
+static inline __attribute__ ((target ("avx2"), always_inline)) __m256i kyber_barrett_avx2 (__m256i a) {
+    const __m256i q = _mm256_set1_epi16 (KYBER_Q);
+
+    return _mm256_sub_epi16 (a, _mm256_mullo_epi16 (_mm256_srli_epi16 (a, 13), q));
+}
+
+/* kyber_montgomery_reduce of the 32-bit products w * v, eight lanes */
+static inline __attribute__ ((target ("avx2"), always_inline)) __m256i
+kyber_montmul32_avx2 (__m256i w, __m256i v) {
+    const __m256i qinv = _mm256_set1_epi32 (7679);
+    const __m256i q = _mm256_set1_epi32 (KYBER_Q);
+    __m256i a, u;
+
+    a = _mm256_mullo_epi32 (w, v);
+    u = _mm256_and_si256 (_mm256_mullo_epi32 (a, qinv), _mm256_set1_epi32 ((1 << 18) - 1));
+    return _mm256_srli_epi32 (_mm256_add_epi32 (a, _mm256_mullo_epi32 (u, q)), 18);
+}
+
+/* Butterfly of kyber_ntt_ref at one level, for the coefficients in a and b */
+static inline __attribute__ ((target ("avx2"), always_inline)) void
+kyber_ntt_butterfly_avx2 (__m256i *a, __m256i *b, __m256i z, int lazy) {
+    const __m256i q4 = _mm256_set1_epi16 (4 * KYBER_Q);
+    __m256i t;
+
+    t = kyber_montmul_avx2 (z, *b);
+    *b = kyber_barrett_avx2 (_mm256_sub_epi16 (_mm256_add_epi16 (*a, q4), t));
+    *a = _mm256_add_epi16 (*a, t);
+    if (!lazy) *a = kyber_barrett_avx2 (*a);
+}
+
+/* Butterfly of kyber_invntt_ref at one level. The difference a + 4q - b
+ * may exceed 16 bits, so it is multiplied by w in 32-bit lanes; unpacking
+ * and packing within 128-bit lanes keeps the coefficient order. */
+static inline __attribute__ ((target ("avx2"), always_inline)) void
+kyber_invntt_butterfly_avx2 (__m256i *a, __m256i *b, __m256i w, int lazy) {
+    const __m256i q4 = _mm256_set1_epi32 (4 * KYBER_Q);
+    const __m256i zero = _mm256_setzero_si256 ();
+    __m256i v0, v1;
+
+    v0 = _mm256_sub_epi32 (_mm256_add_epi32 (_mm256_unpacklo_epi16 (*a, zero), q4),
+                           _mm256_unpacklo_epi16 (*b, zero));
+    v1 = _mm256_sub_epi32 (_mm256_add_epi32 (_mm256_unpackhi_epi16 (*a, zero), q4),
+                           _mm256_unpackhi_epi16 (*b, zero));
+    v0 = kyber_montmul32_avx2 (_mm256_unpacklo_epi16 (w, zero), v0);
+    v1 = kyber_montmul32_avx2 (_mm256_unpackhi_epi16 (w, zero), v1);
+
+    *a = _mm256_add_epi16 (*a, *b);
+    if (!lazy) *a = kyber_barrett_avx2 (*a);
+    *b = _mm256_packus_epi32 (v0, v1);
+}
+
+/*************************************************
+ * Name:        kyber_transpose_avx2
+ *
+ * Description: Transposes the 16x16 matrix of 16-bit words in r[0..15]:
+ *              afterwards lane c of r[i] is the former lane i of r[c].
+ *
+ * Arguments:   - __m256i *r: pointer to the sixteen rows
+ **************************************************/
+static inline __attribute__ ((target ("avx2"), always_inline)) void kyber_transpose_avx2 (__m256i r[16]) {
+    __m256i t[16], u[16];
+    int i;
+
+    /* pairs of rows, 32-bit words: columns 0-3 and 4-7 of each lane */
+    for (i = 0; i < 16; i += 2) {
+        t[i] = _mm256_unpacklo_epi16 (r[i], r[i + 1]);
+        t[i + 1] = _mm256_unpackhi_epi16 (r[i], r[i + 1]);
+    }
+    /* quads of rows, 64-bit words: columns 0-1, 2-3, 4-5, 6-7 */
+    for (i = 0; i < 16; i += 4) {
+        u[i] = _mm256_unpacklo_epi32 (t[i], t[i + 2]);
+        u[i + 1] = _mm256_unpackhi_epi32 (t[i], t[i + 2]);
+        u[i + 2] = _mm256_unpacklo_epi32 (t[i + 1], t[i + 3]);
+        u[i + 3] = _mm256_unpackhi_epi32 (t[i + 1], t[i + 3]);
+    }
+    /* octets of rows: t[8 * h + c] holds column c of rows 8h..8h+7 in
+     * lane 0 and column c + 8 in lane 1 */
+    for (i = 0; i < 4; i++) {
+        t[2 * i] = _mm256_unpacklo_epi64 (u[i], u[i + 4]);
+        t[2 * i + 1] = _mm256_unpackhi_epi64 (u[i], u[i + 4]);
+        t[8 + 2 * i] = _mm256_unpacklo_epi64 (u[8 + i], u[12 + i]);
+        t[8 + 2 * i + 1] = _mm256_unpackhi_epi64 (u[8 + i], u[12 + i]);
+    }
+    for (i = 0; i < 8; i++) {
+        r[i] = _mm256_permute2x128_si256 (t[i], t[8 + i], 0x20);
+        r[i + 8] = _mm256_permute2x128_si256 (t[i], t[8 + i], 0x31);
+    }
+}
+
+/*************************************************
+ * Name:        kyber_ntt_avx2
+ *
+ * Description: Same as kyber_ntt_ref, sixteen coefficients at a time. The
+ *              polynomial stays in sixteen registers: the levels with
+ *              distance len >= 16 pair whole registers, then the registers
+ *              are transposed so the levels with len < 16 pair whole
+ *              registers as well, with the twiddles of kyber_zetas_avx2.
+ *
+ * Arguments:   - uint16_t *p: pointer to in/output polynomial
+ **************************************************/
+__attribute__ ((target ("avx2"))) void kyber_ntt_avx2 (uint16_t *p) {
+    __m256i r[16];
+    const uint16_t *zeta = kyber_zetas_avx2;
+    int level, dist, start, i, k;
+
+    for (i = 0; i < 16; i++) r[i] = _mm256_loadu_si256 ((const __m256i *)&p[16 * i]);
+
+    k = 1;
+    for (level = 7; level >= 4; level--) {
+        dist = 1 << (level - 4);
+        for (start = 0; start < 16; start += 2 * dist) {
+            __m256i z = _mm256_set1_epi16 (kyber_zetas[k++]);
+            for (i = start; i < start + dist; i++)
+                kyber_ntt_butterfly_avx2 (&r[i], &r[i + dist], z, level & 1);
+        }
+    }
+
+    kyber_transpose_avx2 (r);
+    for (level = 3; level >= 0; level--) {
+        dist = 1 << level;
+        for (start = 0; start < 16; start += 2 * dist) {
+            __m256i z = _mm256_load_si256 ((const __m256i *)zeta);
+            zeta += 16;
+            for (i = start; i < start + dist; i++)
+                kyber_ntt_butterfly_avx2 (&r[i], &r[i + dist], z, level & 1);
+        }
+    }
+    kyber_transpose_avx2 (r);
+
+    for (i = 0; i < 16; i++) _mm256_storeu_si256 ((__m256i *)&p[16 * i], r[i]);
+}
+
+/*************************************************
+ * Name:        kyber_invntt_avx2
+ *
+ * Description: Same as kyber_invntt_ref, sixteen coefficients at a time,
+ *              starting on the transposed polynomial with the twiddles of
+ *              kyber_omegas_inv_avx2 (see kyber_ntt_avx2).
+ *
+ * Arguments:   - uint16_t *a: pointer to in/output polynomial
+ **************************************************/
+__attribute__ ((target ("avx2"))) void kyber_invntt_avx2 (uint16_t *a) {
+    __m256i r[16];
+    const uint16_t *omega = kyber_omegas_inv_avx2;
+    int level, dist, start, i;
+
+    for (i = 0; i < 16; i++) r[i] = _mm256_loadu_si256 ((const __m256i *)&a[16 * i]);
+
+    kyber_transpose_avx2 (r);
+    for (level = 0; level < 4; level++) {
+        dist = 1 << level;
+        for (start = 0; start < 16; start += 2 * dist) {
+            __m256i w = _mm256_load_si256 ((const __m256i *)omega);
+            omega += 16;
+            for (i = start; i < start + dist; i++)
+                kyber_invntt_butterfly_avx2 (&r[i], &r[i + dist], w, !(level & 1));
+        }
+    }
+    kyber_transpose_avx2 (r);
+
+    for (level = 4; level < 8; level++) {
+        dist = 1 << (level - 4);
+        for (start = 0; start < 16; start += 2 * dist) {
+            __m256i w = _mm256_set1_epi16 (kyber_omegas_inv_bitrev_montgomery[start / (2 * dist)]);
+            for (i = start; i < start + dist; i++)
+                kyber_invntt_butterfly_avx2 (&r[i], &r[i + dist], w, !(level & 1));
+        }
+    }
+
+    for (i = 0; i < 16; i++) {
+        __m256i psi = _mm256_loadu_si256 ((const __m256i *)&kyber_psis_inv_montgomery[16 * i]);
+        _mm256_storeu_si256 ((__m256i *)&a[16 * i], kyber_montmul_avx2 (psi, r[i]));
+    }
+}
+
+#endif /* __x86_64__ */
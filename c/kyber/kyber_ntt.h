@@ -4,3 +4,12 @@
 
 void kyber_ntt (uint16_t *poly);
 void kyber_invntt (uint16_t *poly);
+
+void kyber_ntt_ref (uint16_t *poly);
+void kyber_invntt_ref (uint16_t *poly);
+void kyber_ntt_opt (uint16_t *poly);
+void kyber_invntt_opt (uint16_t *poly);
+#if defined(__x86_64__)
+void kyber_ntt_avx2 (uint16_t *poly);
+void kyber_invntt_avx2 (uint16_t *poly);
+#endif
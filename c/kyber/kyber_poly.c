@@ -1,10 +1,12 @@
 #include "kyber_poly.h"
 #include "../fips202/fips202.h"
 #include "cbd.h"
+#include "kyber_compress.h"
 #include "kyber_ntt.h"
 #include "kyber_polyvec.h"
 #include "kyber_reduce.h"
 #include <stdio.h>
+#include <string.h>
 
 /*************************************************
  * Name:        kyber_poly_compress
@@ -15,18 +17,7 @@
  *              - const kyber_poly *a:    pointer to input kyber_polynomial
  **************************************************/
 void kyber_poly_compress (unsigned char *r, const kyber_poly *a) {
-    uint32_t t[8];
-    unsigned int i, j, k = 0;
-
-    for (i = 0; i < KYBER_N; i += 8) {
-        for (j = 0; j < 8; j++)
-            t[j] = (((freeze16 (a->coeffs[i + j]) << 3) + KYBER_Q / 2) / KYBER_Q) & 7;
-
-        r[k] = t[0] | (t[1] << 3) | (t[2] << 6);
-        r[k + 1] = (t[2] >> 2) | (t[3] << 1) | (t[4] << 4) | (t[5] << 7);
-        r[k + 2] = (t[5] >> 1) | (t[6] << 2) | (t[7] << 5);
-        k += 3;
-    }
+    kyber_compress3 (r, a->coeffs);
 }
 
 /*************************************************
@@ -39,18 +30,7 @@ void kyber_poly_compress (unsigned char *r, const kyber_poly *a) {
  *              - const unsigned char *a: pointer to input byte array
  **************************************************/
 void kyber_poly_decompress (kyber_poly *r, const unsigned char *a) {
-    unsigned int i;
-    for (i = 0; i < KYBER_N; i += 8) {
-        r->coeffs[i + 0] = (((a[0] & 7) * KYBER_Q) + 4) >> 3;
-        r->coeffs[i + 1] = ((((a[0] >> 3) & 7) * KYBER_Q) + 4) >> 3;
-        r->coeffs[i + 2] = ((((a[0] >> 6) | ((a[1] << 2) & 4)) * KYBER_Q) + 4) >> 3;
-        r->coeffs[i + 3] = ((((a[1] >> 1) & 7) * KYBER_Q) + 4) >> 3;
-        r->coeffs[i + 4] = ((((a[1] >> 4) & 7) * KYBER_Q) + 4) >> 3;
-        r->coeffs[i + 5] = ((((a[1] >> 7) | ((a[2] << 1) & 6)) * KYBER_Q) + 4) >> 3;
-        r->coeffs[i + 6] = ((((a[2] >> 2) & 7) * KYBER_Q) + 4) >> 3;
-        r->coeffs[i + 7] = ((((a[2] >> 5)) * KYBER_Q) + 4) >> 3;
-        a += 3;
-    }
+    kyber_decompress3 (r->coeffs, a);
 }
 
 /*************************************************
@@ -138,6 +118,43 @@ void kyber_poly_getnoise (kyber_poly *r, const unsigned char *seed, unsigned cha
     cbd (r, buf);
 }
 
+/*************************************************
+ * Name:        kyber_poly_getnoise_batch
+ *
+ * Description: Samples n kyber_polynomials as kyber_poly_getnoise does, with
+ *              the nonces nonce, nonce + 1, ..., nonce + n - 1. The SHAKE256
+ *              calls run four at a time on the 4-way Keccak permutation, a
+ *              single remaining one on its own.
+ *
+ * Arguments:   - kyber_poly *const *r:       pointers to the n output kyber_polynomials
+ *              - unsigned int n:             number of kyber_polynomials
+ *              - const unsigned char *seed:  pointer to input seed
+ *              - unsigned char nonce:        nonce of the first kyber_polynomial
+ **************************************************/
+void kyber_poly_getnoise_batch (kyber_poly *const *r, unsigned int n, const unsigned char *seed, unsigned char nonce) {
+    unsigned char buf[4][KYBER_ETA * KYBER_N / 4];
+    unsigned char extseed[4][KYBER_SYMBYTES + 1];
+    unsigned int i, j, lanes;
+
+    for (i = 0; i < n; i += lanes) {
+        lanes = n - i < 4 ? n - i : 4;
+        if (lanes == 1) {
+            kyber_poly_getnoise (r[i], seed, nonce + i);
+            break;
+        }
+
+        /* idle lanes of the last group hash the input of lane 0 again */
+        for (j = 0; j < 4; j++) {
+            memcpy (extseed[j], seed, KYBER_SYMBYTES);
+            extseed[j][KYBER_SYMBYTES] = nonce + i + (j < lanes ? j : 0);
+        }
+        shake256x4 (buf[0], buf[1], buf[2], buf[3], KYBER_ETA * KYBER_N / 4, extseed[0],
+                    extseed[1], extseed[2], extseed[3], KYBER_SYMBYTES + 1);
+
+        for (j = 0; j < lanes; j++) cbd (r[i + j], buf[j]);
+    }
+}
+
 /*************************************************
  * Name:        kyber_poly_ntt
  *
@@ -3,6 +3,19 @@
 #include "params.h"
 #include <stdint.h>
 
+#define kyber_poly_compress       KYBER_NAMESPACE (poly_compress)
+#define kyber_poly_decompress     KYBER_NAMESPACE (poly_decompress)
+#define kyber_poly_tobytes        KYBER_NAMESPACE (poly_tobytes)
+#define kyber_poly_frombytes      KYBER_NAMESPACE (poly_frombytes)
+#define kyber_poly_frommsg        KYBER_NAMESPACE (poly_frommsg)
+#define kyber_poly_tomsg          KYBER_NAMESPACE (poly_tomsg)
+#define kyber_poly_getnoise       KYBER_NAMESPACE (poly_getnoise)
+#define kyber_poly_getnoise_batch KYBER_NAMESPACE (poly_getnoise_batch)
+#define kyber_poly_ntt            KYBER_NAMESPACE (poly_ntt)
+#define kyber_poly_invntt         KYBER_NAMESPACE (poly_invntt)
+#define kyber_poly_add            KYBER_NAMESPACE (poly_add)
+#define kyber_poly_sub            KYBER_NAMESPACE (poly_sub)
+
 /*
  * Elements of R_q = Z_q[X]/(X^n + 1). Represents kyber_polynomial
  * coeffs[0] + X*coeffs[1] + X^2*xoeffs[2] + ... + X^{n-1}*coeffs[n-1]
@@ -21,6 +34,7 @@ void kyber_poly_frommsg (kyber_poly *r, const unsigned char msg[KYBER_SYMBYTES])
 void kyber_poly_tomsg (unsigned char msg[KYBER_SYMBYTES], const kyber_poly *r);
 
 void kyber_poly_getnoise (kyber_poly *r, const unsigned char *seed, unsigned char nonce);
+void kyber_poly_getnoise_batch (kyber_poly *const *r, unsigned int n, const unsigned char *seed, unsigned char nonce);
 
 void kyber_poly_ntt (kyber_poly *r);
 void kyber_poly_invntt (kyber_poly *r);
@@ -3,6 +3,15 @@
 #include "kyber_poly.h"
 #include "params.h"
 
+#define kyber_polyvec_compress      KYBER_NAMESPACE (polyvec_compress)
+#define kyber_polyvec_decompress    KYBER_NAMESPACE (polyvec_decompress)
+#define kyber_polyvec_tobytes       KYBER_NAMESPACE (polyvec_tobytes)
+#define kyber_polyvec_frombytes     KYBER_NAMESPACE (polyvec_frombytes)
+#define kyber_polyvec_ntt           KYBER_NAMESPACE (polyvec_ntt)
+#define kyber_polyvec_invntt        KYBER_NAMESPACE (polyvec_invntt)
+#define kyber_polyvec_pointwise_acc KYBER_NAMESPACE (polyvec_pointwise_acc)
+#define kyber_polyvec_add           KYBER_NAMESPACE (polyvec_add)
+
 typedef struct {
     kyber_poly vec[KYBER_K];
 } kyber_polyvec;
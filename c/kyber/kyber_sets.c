@@ -0,0 +1,168 @@
+/* Selection among the Kyber parameter sets at run time.
+ * Each set is compiled on its own with KYBER_K fixed, so its loops are
+ * specialized for its k; the wrappers below forward the calls of the Go
+ * types to one of them through a table per set. */
+
+#include "kyber_sets.h"
+
+typedef struct {
+    int (*keypair) (char *pk, char *sk, const char *entropy, int rng_backend);
+    int (*enc) (char *ct, char *ss, const char *pk, const char *entropy, int rng_backend);
+    int (*dec) (char *ss, const char *ct, const char *sk);
+    void *(*prepare_pk) (const char *pk);
+    void (*prepared_pk_free) (void *ppk);
+    int (*enc_prepared) (char *ct, char *ss, const void *ppk, const char *entropy, int rng_backend);
+    int (*enc_batch) (char *ct, char *ss, const char *pk, const char *entropy, size_t n, int rng_backend);
+    void *(*prepare_sk) (const char *sk);
+    void (*prepared_sk_free) (void *psk);
+    int (*dec_prepared) (char *ss, const char *ct, const void *psk);
+    void (*dec_batch) (char *ss, const char *ct, size_t n, const char *sk);
+    void (*dec_batch_prepared) (char *ss, const char *ct, size_t n, const void *psk);
+    int (*kex_initA) (char *send, char *state, const char *pkb, const char *entropy, int rng_backend);
+    int (*uake_sharedB) (char *send, char *k, const char *recv, const char *skb, const char *entropy, int rng_backend);
+    void (*uake_sharedA) (char *k, const char *recv, const char *state);
+    int (*ake_sharedB) (char *send, char *k, const char *recv, const char *skb, const char *pka, const char *entropy, int rng_backend);
+    void (*ake_sharedA) (char *k, const char *recv, const char *state, const char *ska);
+} kyber_set_table;
+
+#define KYBER_SET_TABLE(p)                                                                  \
+    {                                                                                       \
+        p##_kem_keypair_cgo, p##_kem_enc_cgo, p##_kem_dec_cgo, p##_prepare_pk_cgo,          \
+        p##_prepared_pk_free_cgo, p##_kem_enc_prepared_cgo, p##_kem_enc_batch_cgo,          \
+        p##_prepare_sk_cgo, p##_prepared_sk_free_cgo, p##_kem_dec_prepared_cgo,             \
+        p##_kem_dec_batch_cgo, p##_kem_dec_batch_prepared_cgo, p##_kex_initA_cgo,           \
+        p##_uake_sharedB_cgo, p##_uake_sharedA_cgo, p##_ake_sharedB_cgo, p##_ake_sharedA_cgo \
+    }
+
+static const kyber_set_table kyber_set_tables[3] = {
+    KYBER_SET_TABLE (kyber512),
+    KYBER_SET_TABLE (kyber768),
+    KYBER_SET_TABLE (kyber1024),
+};
+
+#undef KYBER_SET_TABLE
+
+/* The table of the set of k, NULL for a k of no set: the wrappers then
+ * fail without calling anything */
+static const kyber_set_table *kyber_set (int k) {
+    if (k < 2 || k > 4) return NULL;
+    return &kyber_set_tables[k - 2];
+}
+
+int kyber_set_keypair_cgo (int k, char *pk, char *sk, const char *entropy, int rng_backend) {
+    const kyber_set_table *t = kyber_set (k);
+
+    return t != NULL ? t->keypair (pk, sk, entropy, rng_backend) : -1;
+}
+
+int kyber_set_enc_cgo (int k, char *ct, char *ss, const char *pk, const char *entropy, int rng_backend) {
+    const kyber_set_table *t = kyber_set (k);
+
+    return t != NULL ? t->enc (ct, ss, pk, entropy, rng_backend) : -1;
+}
+
+int kyber_set_dec_cgo (int k, char *ss, const char *ct, const char *sk) {
+    const kyber_set_table *t = kyber_set (k);
+
+    return t != NULL ? t->dec (ss, ct, sk) : -1;
+}
+
+void *kyber_set_prepare_pk_cgo (int k, const char *pk) {
+    const kyber_set_table *t = kyber_set (k);
+
+    return t != NULL ? t->prepare_pk (pk) : NULL;
+}
+
+void kyber_set_prepared_pk_free_cgo (int k, void *ppk) {
+    const kyber_set_table *t = kyber_set (k);
+
+    if (t != NULL) t->prepared_pk_free (ppk);
+}
+
+int kyber_set_enc_prepared_cgo (int k, char *ct, char *ss, const void *ppk, const char *entropy, int rng_backend) {
+    const kyber_set_table *t = kyber_set (k);
+
+    return t != NULL ? t->enc_prepared (ct, ss, ppk, entropy, rng_backend) : -1;
+}
+
+int kyber_set_enc_batch_cgo (int k, char *ct, char *ss, const char *pk, const char *entropy, size_t n, int rng_backend) {
+    const kyber_set_table *t = kyber_set (k);
+
+    return t != NULL ? t->enc_batch (ct, ss, pk, entropy, n, rng_backend) : -1;
+}
+
+void *kyber_set_prepare_sk_cgo (int k, const char *sk) {
+    const kyber_set_table *t = kyber_set (k);
+
+    return t != NULL ? t->prepare_sk (sk) : NULL;
+}
+
+void kyber_set_prepared_sk_free_cgo (int k, void *psk) {
+    const kyber_set_table *t = kyber_set (k);
+
+    if (t != NULL) t->prepared_sk_free (psk);
+}
+
+int kyber_set_dec_prepared_cgo (int k, char *ss, const char *ct, const void *psk) {
+    const kyber_set_table *t = kyber_set (k);
+
+    return t != NULL ? t->dec_prepared (ss, ct, psk) : -1;
+}
+
+int kyber_set_dec_batch_cgo (int k, char *ss, const char *ct, size_t n, const char *sk) {
+    const kyber_set_table *t = kyber_set (k);
+
+    if (t == NULL) return -1;
+    t->dec_batch (ss, ct, n, sk);
+    return 0;
+}
+
+int kyber_set_dec_batch_prepared_cgo (int k, char *ss, const char *ct, size_t n, const void *psk) {
+    const kyber_set_table *t = kyber_set (k);
+
+    if (t == NULL) return -1;
+    t->dec_batch_prepared (ss, ct, n, psk);
+    return 0;
+}
+
+/* kk is the key of the exchange, k the set */
+int kyber_set_kex_initA_cgo (int k, char *send, char *state, const char *pkb, const char *entropy, int rng_backend) {
+    const kyber_set_table *t = kyber_set (k);
+
+    return t != NULL ? t->kex_initA (send, state, pkb, entropy, rng_backend) : -1;
+}
+
+int kyber_set_uake_sharedB_cgo (int k, char *send, char *kk, const char *recv, const char *skb, const char *entropy, int rng_backend) {
+    const kyber_set_table *t = kyber_set (k);
+
+    return t != NULL ? t->uake_sharedB (send, kk, recv, skb, entropy, rng_backend) : -1;
+}
+
+int kyber_set_uake_sharedA_cgo (int k, char *kk, const char *recv, const char *state) {
+    const kyber_set_table *t = kyber_set (k);
+
+    if (t == NULL) return -1;
+    t->uake_sharedA (kk, recv, state);
+    return 0;
+}
+
+int kyber_set_ake_sharedB_cgo (int k,
+                               char *send,
+                               char *kk,
+                               const char *recv,
+                               const char *skb,
+                               const char *pka,
+                               const char *entropy,
+                               int rng_backend) {
+    const kyber_set_table *t = kyber_set (k);
+
+    return t != NULL ? t->ake_sharedB (send, kk, recv, skb, pka, entropy, rng_backend) : -1;
+}
+
+int kyber_set_ake_sharedA_cgo (int k, char *kk, const char *recv, const char *state, const char *ska) {
+    const kyber_set_table *t = kyber_set (k);
+
+    if (t == NULL) return -1;
+    t->ake_sharedA (kk, recv, state, ska);
+    return 0;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "../randombytes/rng.h"
+#include "params.h"
+#include <stddef.h>
+
+/* Sizes of the parameter sets, Kyber512 (k = 2), Kyber768 (k = 3) and
+ * Kyber1024 (k = 4) */
+enum {
+    KYBER512_PUBLICKEYBYTES = KYBER_PUBLICKEYBYTES_K (2),
+    KYBER512_SECRETKEYBYTES = KYBER_SECRETKEYBYTES_K (2),
+    KYBER512_CIPHERTEXTBYTES = KYBER_CIPHERTEXTBYTES_K (2),
+    KYBER768_PUBLICKEYBYTES = KYBER_PUBLICKEYBYTES_K (3),
+    KYBER768_SECRETKEYBYTES = KYBER_SECRETKEYBYTES_K (3),
+    KYBER768_CIPHERTEXTBYTES = KYBER_CIPHERTEXTBYTES_K (3),
+    KYBER1024_PUBLICKEYBYTES = KYBER_PUBLICKEYBYTES_K (4),
+    KYBER1024_SECRETKEYBYTES = KYBER_SECRETKEYBYTES_K (4),
+    KYBER1024_CIPHERTEXTBYTES = KYBER_CIPHERTEXTBYTES_K (4)
+};
+
+/* Entry points of the set built with prefix p (see KYBER_NAMESPACE); the
+ * cgo wrappers are those of kem.c and kex.c */
+#define KYBER_SET_DECLARE(p)                                                                     \
+    int p##_kem_keypair_rng (unsigned char *pk, unsigned char *sk, rng_ctx *rng);                \
+    int p##_kem_keypair_cgo (char *pk, char *sk, const char *entropy, int rng_backend);          \
+    int p##_kem_enc_cgo (char *ct, char *ss, const char *pk, const char *entropy, int rng_backend); \
+    int p##_kem_dec_cgo (char *ss, const char *ct, const char *sk);                              \
+    void *p##_prepare_pk_cgo (const char *pk);                                                   \
+    void p##_prepared_pk_free_cgo (void *ppk);                                                   \
+    int p##_kem_enc_prepared_cgo (char *ct, char *ss, const void *ppk, const char *entropy,      \
+                                  int rng_backend);                                              \
+    int p##_kem_enc_batch_cgo (char *ct, char *ss, const char *pk, const char *entropy,          \
+                               size_t n, int rng_backend);                                       \
+    void *p##_prepare_sk_cgo (const char *sk);                                                   \
+    void p##_prepared_sk_free_cgo (void *psk);                                                   \
+    int p##_kem_dec_prepared_cgo (char *ss, const char *ct, const void *psk);                    \
+    void p##_kem_dec_batch_cgo (char *ss, const char *ct, size_t n, const char *sk);             \
+    void p##_kem_dec_batch_prepared_cgo (char *ss, const char *ct, size_t n, const void *psk);      \
+    int p##_kex_initA_cgo (char *send, char *state, const char *pkb, const char *entropy,        \
+                           int rng_backend);                                                     \
+    int p##_uake_sharedB_cgo (char *send, char *k, const char *recv, const char *skb,            \
+                              const char *entropy, int rng_backend);                             \
+    void p##_uake_sharedA_cgo (char *k, const char *recv, const char *state);                    \
+    int p##_ake_sharedB_cgo (char *send, char *k, const char *recv, const char *skb,             \
+                             const char *pka, const char *entropy, int rng_backend);             \
+    void p##_ake_sharedA_cgo (char *k, const char *recv, const char *state, const char *ska);
+
+KYBER_SET_DECLARE (kyber512)
+KYBER_SET_DECLARE (kyber768)
+KYBER_SET_DECLARE (kyber1024)
+
+/* The entry points above for the set of k in {2, 3, 4}; prepared keys
+ * must come from the same set. For any other k they return -1 or NULL. */
+int kyber_set_keypair_cgo (int k, char *pk, char *sk, const char *entropy, int rng_backend);
+int kyber_set_enc_cgo (int k, char *ct, char *ss, const char *pk, const char *entropy, int rng_backend);
+int kyber_set_dec_cgo (int k, char *ss, const char *ct, const char *sk);
+void *kyber_set_prepare_pk_cgo (int k, const char *pk);
+void kyber_set_prepared_pk_free_cgo (int k, void *ppk);
+int kyber_set_enc_prepared_cgo (int k, char *ct, char *ss, const void *ppk, const char *entropy, int rng_backend);
+int kyber_set_enc_batch_cgo (int k, char *ct, char *ss, const char *pk, const char *entropy, size_t n, int rng_backend);
+void *kyber_set_prepare_sk_cgo (int k, const char *sk);
+void kyber_set_prepared_sk_free_cgo (int k, void *psk);
+int kyber_set_dec_prepared_cgo (int k, char *ss, const char *ct, const void *psk);
+int kyber_set_dec_batch_cgo (int k, char *ss, const char *ct, size_t n, const char *sk);
+int kyber_set_dec_batch_prepared_cgo (int k, char *ss, const char *ct, size_t n, const void *psk);
+int kyber_set_kex_initA_cgo (int k, char *send, char *state, const char *pkb, const char *entropy, int rng_backend);
+int kyber_set_uake_sharedB_cgo (int k, char *send, char *kk, const char *recv, const char *skb, const char *entropy, int rng_backend);
+int kyber_set_uake_sharedA_cgo (int k, char *kk, const char *recv, const char *state);
+int kyber_set_ake_sharedB_cgo (int k,
+                               char *send,
+                               char *kk,
+                               const char *recv,
+                               const char *skb,
+                               const char *pka,
+                               const char *entropy,
+                               int rng_backend);
+int kyber_set_ake_sharedA_cgo (int k, char *kk, const char *recv, const char *state, const char *ska);
@@ -19,6 +19,18 @@
 #error "KYBER_K must be in {2,3,4}"
 #endif
 
+/* The three parameter sets are built side by side, each as a translation
+ * unit of its own (kyber512.c, kyber768.c and kyber1024.c at the package
+ * root); the headers of the sources that depend on KYBER_K rename their
+ * external symbols with the prefix of the set. */
+#if (KYBER_K == 2)
+#define KYBER_NAMESPACE(s) kyber512_##s
+#elif (KYBER_K == 3)
+#define KYBER_NAMESPACE(s) kyber768_##s
+#else
+#define KYBER_NAMESPACE(s) kyber1024_##s
+#endif
+
 #define KYBER_SYMBYTES 32 /* size in bytes of shared key, hashes, and seeds */
 
 #define KYBER_POLYBYTES 416
@@ -37,3 +49,9 @@
 #define KYBER_SECRETKEYBYTES                                                   \
     (KYBER_INDCPA_SECRETKEYBYTES + KYBER_INDCPA_PUBLICKEYBYTES + 2 * KYBER_SYMBYTES) /* 32 bytes of additional space to save H(pk) */
 #define KYBER_CIPHERTEXTBYTES KYBER_INDCPA_BYTES
+
+/* Sizes for any k, for code that handles all parameter sets */
+#define KYBER_PUBLICKEYBYTES_K(k) ((k) * 352 + KYBER_SYMBYTES)
+#define KYBER_SECRETKEYBYTES_K(k)                                              \
+    ((k) * KYBER_POLYBYTES + KYBER_PUBLICKEYBYTES_K (k) + 2 * KYBER_SYMBYTES)
+#define KYBER_CIPHERTEXTBYTES_K(k) ((k) * 352 + KYBER_POLYCOMPRESSEDBYTES)
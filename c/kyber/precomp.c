@@ -97,3 +97,67 @@ const uint16_t kyber_psis_inv_montgomery[KYBER_N] = {
     6839, 5933, 1954, 4987, 7142, 5814, 7527, 4953, 7637, 4707, 2182, 5734,
     2818, 541,  4097, 5641
 };
+
+#if defined(__x86_64__)
+
+/* Twiddles of the AVX2 NTTs for the levels with distance len < 16, which
+ * run on the transposed polynomial: register i holds coefficient i of each
+ * of the 16 blocks of 16 coefficients, so lane c of the twiddle vector for
+ * register i serves block c. Vectors follow the order of the levels,
+ * len = 8, 4, 2, 1 for the forward NTT and len = 1, 2, 4, 8 for the
+ * inverse, and within a level the registers i with i / (2 * len) = s:
+
+zetas_avx2 = concat(vector(4, l, my(L = 2^(4-l)); \
+    concat(vector(8/L, s, vector(16, c, zetas[128/L + (c-1)*8/L + s])))))
+omegas_inv_avx2 = concat(vector(4, l, my(L = 2^(l-1)); \
+    concat(vector(8/L, s, vector(16, c, omegas_inv_bitrev_montgomery[(c-1)*8/L + s])))))
+
+*/
+
+const uint16_t kyber_zetas_avx2[15 * 16] __attribute__ ((aligned (32))) = {
+    3583, 7010, 6414, 263,  1285, 291,  7143, 7338, 1581, 5134, 5184, 5932,
+    4042, 5775, 2468, 3,    606,  5383, 3240, 5129, 5929, 2461, 1584, 1142,
+    7407, 5602, 6140, 4931, 2085, 2056, 7269, 7190, 729,  962,  7548, 7653,
+    4965, 641,  2666, 157,  5222, 5142, 5485, 1559, 5284, 3538, 3535, 1957,
+    3465, 2023, 1694, 5939, 1019, 657,  1693, 6466, 2121, 3659, 1549, 5544,
+    6722, 6128, 3457, 6239, 6792, 7643, 6905, 1859, 1492, 4859, 2607, 1010,
+    6392, 3375, 5856, 1650, 2915, 7676, 3132, 851,  1538, 3660, 3995, 6910,
+    7087, 5798, 2782, 957,  7319, 6430, 4773, 3997, 4245, 5737, 7196, 2122,
+    4664, 7673, 3475, 4434, 4761, 2640, 5400, 3851, 3367, 7583, 6084, 4390,
+    2635, 1616, 4702, 3009, 7613, 6965, 7078, 5850, 6848, 6591, 6055, 6374,
+    7443, 5175, 1730, 5113, 925,  3866, 1990, 6947, 7295, 2713, 4484, 3387,
+    6793, 590,  1162, 5006, 6330, 5655, 332,  333,  4573, 2065, 4067, 2159,
+    2007, 7126, 5937, 6487, 3463, 6643, 1679, 4576, 3184, 1898, 1577, 3502,
+    599,  4048, 2036, 654,  323,  3401, 944,  6777, 5877, 1337, 3883, 4288,
+    4971, 382,  3304, 4517, 1367, 839,  2069, 7327, 5112, 963,  2860, 4812,
+    1174, 6036, 4311, 5180, 2530, 7211, 2329, 1480, 4109, 5764, 3567, 2768,
+    3716, 6596, 2680, 4724, 7116, 3991, 2106, 4102, 5325, 43,   1699, 1172,
+    1863, 2447, 7371, 6676, 2289, 607,  5049, 7077, 3077, 1675, 6163, 282,
+    4171, 5965, 6150, 5567, 6929, 2022, 2368, 987,  6442, 5027, 1777, 186,
+    5945, 2053, 4486, 6119, 7185, 6073, 2379, 651,  1605, 3345, 339,  2214
+};
+
+const uint16_t kyber_omegas_inv_avx2[15 * 16] __attribute__ ((aligned (32))) = {
+    990,  2025, 7678, 343,  5724, 6122, 7524, 28,   4672, 6065, 3291, 98,
+    3830, 5041, 3247, 8,    254,  6804, 5213, 538,  491,  2750, 6539, 2552,
+    5559, 1944, 3684, 1251, 6724, 1883, 771,  4021, 862,  3858, 1906, 7390,
+    4146, 2196, 5015, 133,  6830, 5,    6031, 4306, 6671, 2822, 5822, 38,
+    5047, 1595, 3639, 6396, 412,  1541, 6097, 4441, 1442, 1553, 2137, 4022,
+    1215, 7024, 1742, 5658, 6586, 2299, 1749, 7418, 4143, 2539, 7040, 6719,
+    2979, 5046, 1597, 4314, 2281, 2920, 4206, 3017, 5538, 4345, 2497, 1267,
+    5625, 2079, 5220, 2298, 485,  3436, 2908, 362,  4899, 594,  3686, 6143,
+    4400, 1319, 2547, 671,  2397, 2459, 2716, 6952, 4549, 4766, 1825, 1289,
+    5074, 6189, 776,  889,  7103, 7197, 6100, 4098, 5596, 274,  1752, 7075,
+    4224, 959,  6132, 5560, 5988, 6662, 5987, 4216, 990,  6586, 2025, 2299,
+    7678, 1749, 343,  7418, 5724, 4143, 6122, 2539, 7524, 7040, 28,   6719,
+    254,  5538, 6804, 4345, 5213, 2497, 538,  1267, 491,  5625, 2750, 2079,
+    6539, 5220, 2552, 2298, 862,  4400, 3858, 1319, 1906, 2547, 7390, 671,
+    4146, 2397, 2196, 2459, 5015, 2716, 133,  6952, 5047, 7103, 1595, 7197,
+    3639, 6100, 6396, 4098, 412,  5596, 1541, 274,  6097, 1752, 4441, 7075,
+    990,  862,  6586, 4400, 2025, 3858, 2299, 1319, 7678, 1906, 1749, 2547,
+    343,  7390, 7418, 671,  254,  5047, 5538, 7103, 6804, 1595, 4345, 7197,
+    5213, 3639, 2497, 6100, 538,  6396, 1267, 4098, 990,  254,  862,  5047,
+    6586, 5538, 4400, 7103, 2025, 6804, 3858, 1595, 2299, 4345, 1319, 7197
+};
+
+#endif
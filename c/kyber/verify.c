@@ -23,6 +23,36 @@ int verify (const unsigned char *a, const unsigned char *b, size_t len) {
     return r;
 }
 
+/*************************************************
+ * Name:        verifyx4
+ *
+ * Description: Compares four pairs of arrays for equality in constant time,
+ *              eight bytes of each pair per step.
+ *
+ * Arguments:   int *fail:              pointer to output array of four results,
+ *                                      0 if pair i is equal, 1 otherwise
+ *              const unsigned char **a: pointer to the four first byte arrays
+ *              const unsigned char **b: pointer to the four second byte arrays
+ *              size_t len:             length of the byte arrays
+ **************************************************/
+void verifyx4 (int fail[4], const unsigned char *const a[4], const unsigned char *const b[4], size_t len) {
+    uint64_t r[4] = { 0 }, x, y;
+    size_t i;
+    unsigned int j;
+
+    for (i = 0; i + 8 <= len; i += 8) {
+        for (j = 0; j < 4; j++) {
+            memcpy (&x, a[j] + i, 8);
+            memcpy (&y, b[j] + i, 8);
+            r[j] |= x ^ y;
+        }
+    }
+    for (; i < len; i++)
+        for (j = 0; j < 4; j++) r[j] |= a[j][i] ^ b[j][i];
+
+    for (j = 0; j < 4; j++) fail[j] = (r[j] | (0 - r[j])) >> 63;
+}
+
 /*************************************************
  * Name:        cmov
  *
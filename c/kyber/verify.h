@@ -4,6 +4,7 @@
 #include <stdio.h>
 
 int verify (const unsigned char *a, const unsigned char *b, size_t len);
+void verifyx4 (int fail[4], const unsigned char *const a[4], const unsigned char *const b[4], size_t len);
 
 void cmov (unsigned char *r, const unsigned char *x, size_t len, unsigned char b);
 
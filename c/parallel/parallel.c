@@ -0,0 +1,147 @@
+/* Process-wide thread pool for data-parallel loops.
+ * Workers are started on first use and live for the rest of the process.
+ * A loop is cut into chunks of grain items that workers, and the calling
+ * thread, claim in order; several loops from different threads may be in
+ * flight at once. */
+
+#include "parallel.h"
+#include <pthread.h>
+#include <unistd.h>
+
+typedef struct pqgo_loop {
+    pqgo_task_fn fn;
+    void *arg;
+    size_t n, grain;
+    size_t next;    /* first item not claimed yet */
+    size_t pending; /* chunks claimed or not, not yet finished */
+    struct pqgo_loop *link;
+} pqgo_loop;
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t work;
+    pthread_cond_t done;
+    pqgo_loop *loops; /* loops with unclaimed chunks */
+    unsigned int nthreads;
+    unsigned int started;
+} pqgo_pool = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER, NULL, 0, 0 };
+
+/* Claims the next chunk of l (lock held); unlinks l once fully claimed */
+static void pqgo_claim (pqgo_loop *l, size_t *begin, size_t *end) {
+    pqgo_loop **p;
+
+    *begin = l->next;
+    *end = l->n - l->next > l->grain ? l->next + l->grain : l->n;
+    l->next = *end;
+
+    if (l->next == l->n) {
+        for (p = &pqgo_pool.loops; *p != l; p = &(*p)->link)
+            ;
+        *p = l->link;
+    }
+}
+
+/* Runs a claimed chunk without the lock and accounts for it */
+static void pqgo_run (pqgo_loop *l, size_t begin, size_t end) {
+    pthread_mutex_unlock (&pqgo_pool.lock);
+    l->fn (l->arg, begin, end);
+    pthread_mutex_lock (&pqgo_pool.lock);
+    if (--l->pending == 0) pthread_cond_broadcast (&pqgo_pool.done);
+}
+
+static void *pqgo_worker (void *unused) {
+    size_t begin, end;
+    pqgo_loop *l;
+
+    (void)unused;
+    pthread_mutex_lock (&pqgo_pool.lock);
+    for (;;) {
+        while (pqgo_pool.loops == NULL) pthread_cond_wait (&pqgo_pool.work, &pqgo_pool.lock);
+        l = pqgo_pool.loops;
+        pqgo_claim (l, &begin, &end);
+        pqgo_run (l, begin, end);
+    }
+    return NULL;
+}
+
+static unsigned int pqgo_online_cpus (void) {
+    long ncpu = sysconf (_SC_NPROCESSORS_ONLN);
+
+    return ncpu > 0 ? (unsigned int)ncpu : 1;
+}
+
+/* Starts workers up to nthreads - 1 (lock held); the caller is the last one */
+static void pqgo_start (void) {
+    pthread_t t;
+
+    if (pqgo_pool.nthreads == 0) pqgo_pool.nthreads = pqgo_online_cpus ();
+
+    while (pqgo_pool.started + 1 < pqgo_pool.nthreads) {
+        if (pthread_create (&t, NULL, pqgo_worker, NULL) != 0) break;
+        pthread_detach (t);
+        pqgo_pool.started++;
+    }
+}
+
+/*************************************************
+ * Name:        pqgo_parallel_for
+ *
+ * Description: Calls fn on consecutive ranges of at most grain items
+ *              covering [0, n), spread over the pool and the calling
+ *              thread; returns when all ranges are done. Runs inline when
+ *              there is a single range.
+ *
+ * Arguments:   - size_t n:         number of items
+ *              - size_t grain:     items per range (at least 1)
+ *              - pqgo_task_fn fn:  function processing a range
+ *              - void *arg:        argument passed to fn
+ **************************************************/
+void pqgo_parallel_for (size_t n, size_t grain, pqgo_task_fn fn, void *arg) {
+    pqgo_loop l;
+    size_t begin, end;
+
+    if (grain == 0) grain = 1;
+    if (n <= grain) {
+        if (n > 0) fn (arg, 0, n);
+        return;
+    }
+
+    l.fn = fn;
+    l.arg = arg;
+    l.n = n;
+    l.grain = grain;
+    l.next = 0;
+    l.pending = (n + grain - 1) / grain;
+
+    pthread_mutex_lock (&pqgo_pool.lock);
+    pqgo_start ();
+    l.link = pqgo_pool.loops;
+    pqgo_pool.loops = &l;
+    pthread_cond_broadcast (&pqgo_pool.work);
+
+    while (l.next < l.n) {
+        pqgo_claim (&l, &begin, &end);
+        pqgo_run (&l, begin, end);
+    }
+    while (l.pending > 0) pthread_cond_wait (&pqgo_pool.done, &pqgo_pool.lock);
+    pthread_mutex_unlock (&pqgo_pool.lock);
+}
+
+/* Sets the number of threads used by parallel loops, caller included;
+ * 0 means one per online CPU. Workers are never stopped, so lowering the
+ * count only has an effect before the first parallel loop. */
+void pqgo_parallel_set_threads (unsigned int nthreads) {
+    pthread_mutex_lock (&pqgo_pool.lock);
+    pqgo_pool.nthreads = nthreads ? nthreads : pqgo_online_cpus ();
+    pthread_mutex_unlock (&pqgo_pool.lock);
+}
+
+unsigned int pqgo_parallel_threads (void) {
+    unsigned int n;
+
+    pthread_mutex_lock (&pqgo_pool.lock);
+    n = pqgo_pool.nthreads ? pqgo_pool.nthreads : pqgo_online_cpus ();
+    if (n < pqgo_pool.started + 1) n = pqgo_pool.started + 1;
+    pthread_mutex_unlock (&pqgo_pool.lock);
+    return n;
+}
@@ -0,0 +1,13 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <stddef.h>
+
+/* Processes items [begin, end) of a parallel loop */
+typedef void (*pqgo_task_fn) (void *arg, size_t begin, size_t end);
+
+void pqgo_parallel_for (size_t n, size_t grain, pqgo_task_fn fn, void *arg);
+void pqgo_parallel_set_threads (unsigned int nthreads);
+unsigned int pqgo_parallel_threads (void);
+
+#endif
@@ -0,0 +1,214 @@
+/* AES-256 block encryption for the CTR_DRBG of rng.c.
+ * The portable code works on eight bytes at a time in 64-bit words and
+ * computes the S-box as inversion in GF(2^8) followed by the affine map,
+ * so it has no secret-dependent table lookups or branches. */
+
+#include "aes256.h"
+#include <string.h>
+
+#define AES_BYTES(x) (0x0101010101010101ULL * (x))
+
+/* multiplication by x in GF(2^8), bytewise */
+static uint64_t aes_xtime64 (uint64_t a) {
+    return ((a & AES_BYTES (0x7F)) << 1) ^ (((a >> 7) & AES_BYTES (0x01)) * 0x1B);
+}
+
+/* bytewise product in GF(2^8) */
+static uint64_t aes_gmul64 (uint64_t a, uint64_t b) {
+    uint64_t p = 0;
+    unsigned int i;
+
+    for (i = 0; i < 8; i++) {
+        p ^= (((b >> i) & AES_BYTES (0x01)) * 0xFF) & a;
+        a = aes_xtime64 (a);
+    }
+    return p;
+}
+
+/* rotation left by k within every byte */
+static uint64_t aes_rotb64 (uint64_t b, unsigned int k) {
+    return ((b << k) & AES_BYTES ((0xFF << k) & 0xFF)) | ((b >> (8 - k)) & AES_BYTES (0xFF >> (8 - k)));
+}
+
+/* S-box of eight bytes: x^254, then the affine transformation */
+static uint64_t aes_sbox64 (uint64_t x) {
+    uint64_t x2, x3, x12, x14, y;
+
+    x2 = aes_gmul64 (x, x);
+    x3 = aes_gmul64 (x2, x);
+    x12 = aes_gmul64 (x3, x3);
+    x12 = aes_gmul64 (x12, x12);
+    x14 = aes_gmul64 (x12, x2);
+    y = aes_gmul64 (x14, x); /* x^15 */
+    y = aes_gmul64 (y, y);
+    y = aes_gmul64 (y, y);
+    y = aes_gmul64 (y, y);
+    y = aes_gmul64 (y, y); /* x^240 */
+    y = aes_gmul64 (y, x14);
+
+    return y ^ aes_rotb64 (y, 1) ^ aes_rotb64 (y, 2) ^ aes_rotb64 (y, 3) ^
+           aes_rotb64 (y, 4) ^ AES_BYTES (0x63);
+}
+
+static uint64_t aes_load64 (const uint8_t *x) {
+    uint64_t r = 0;
+    unsigned int i;
+
+    for (i = 0; i < 8; i++) r |= (uint64_t)x[i] << 8 * i;
+    return r;
+}
+
+static void aes_store64 (uint8_t *x, uint64_t u) {
+    unsigned int i;
+
+    for (i = 0; i < 8; i++) x[i] = u >> 8 * i;
+}
+
+/*************************************************
+ * Name:        aes256_setkey_ref
+ *
+ * Description: FIPS-197 key expansion for a 256-bit key.
+ *
+ * Arguments:   - aes256_ctx *ctx:       pointer to output expanded key
+ *              - const uint8_t key[32]: AES-256 key
+ **************************************************/
+void aes256_setkey_ref (aes256_ctx *ctx, const uint8_t key[32]) {
+    uint8_t *w = ctx->rk;
+    uint8_t t[8], rcon = 1;
+    unsigned int i, j;
+
+    memcpy (w, key, 32);
+    for (i = 8; i < 60; i++) {
+        memcpy (t, w + 4 * (i - 1), 4);
+        if (i % 4 == 0) {
+            if (i % 8 == 0) { /* RotWord */
+                t[4] = t[0];
+                for (j = 0; j < 4; j++) t[j] = t[j + 1];
+            }
+            memset (t + 4, 0, 4);
+            aes_store64 (t, aes_sbox64 (aes_load64 (t)));
+            if (i % 8 == 0) {
+                t[0] ^= rcon;
+                rcon = aes_xtime64 (rcon);
+            }
+        }
+        for (j = 0; j < 4; j++) w[4 * i + j] = w[4 * (i - 8) + j] ^ t[j];
+    }
+}
+
+/*************************************************
+ * Name:        aes256_ecb_ref
+ *
+ * Description: Encrypts independent blocks with an expanded key.
+ *
+ * Arguments:   - const aes256_ctx *ctx: pointer to expanded key
+ *              - uint8_t *out:          pointer to output (16 * nblocks bytes)
+ *              - const uint8_t *in:     pointer to input, may equal out
+ *              - size_t nblocks:        number of blocks
+ **************************************************/
+void aes256_ecb_ref (const aes256_ctx *ctx, uint8_t *out, const uint8_t *in, size_t nblocks) {
+    uint8_t s[16], t[16];
+    unsigned int r, c, i;
+
+    for (; nblocks > 0; nblocks--, in += 16, out += 16) {
+        for (i = 0; i < 16; i++) s[i] = in[i] ^ ctx->rk[i];
+
+        for (r = 1; r <= 14; r++) {
+            /* SubBytes and ShiftRows; byte i is row i % 4, column i / 4 */
+            aes_store64 (t, aes_sbox64 (aes_load64 (s)));
+            aes_store64 (t + 8, aes_sbox64 (aes_load64 (s + 8)));
+            for (i = 0; i < 16; i++) s[i] = t[(i + 4 * (i % 4)) % 16];
+
+            /* MixColumns, skipped in the last round */
+            if (r < 14) {
+                for (c = 0; c < 16; c += 4) {
+                    uint8_t a0 = s[c], a1 = s[c + 1], a2 = s[c + 2], a3 = s[c + 3];
+                    uint8_t x = a0 ^ a1 ^ a2 ^ a3;
+
+                    s[c] ^= x ^ (uint8_t)aes_xtime64 (a0 ^ a1);
+                    s[c + 1] ^= x ^ (uint8_t)aes_xtime64 (a1 ^ a2);
+                    s[c + 2] ^= x ^ (uint8_t)aes_xtime64 (a2 ^ a3);
+                    s[c + 3] ^= x ^ (uint8_t)aes_xtime64 (a3 ^ a0);
+                }
+            }
+
+            for (i = 0; i < 16; i++) s[i] ^= ctx->rk[16 * r + i];
+        }
+
+        memcpy (out, s, 16);
+    }
+}
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+
+/* One step of the AES-256 key schedule (Intel AES-NI white paper):
+ * a is the round key two steps back, g the keygenassist output of the
+ * previous round key; the shuffle selects RotWord/SubWord or SubWord */
+static inline __attribute__ ((target ("aes,sse2"), always_inline)) __m128i
+aes256_expand_aesni (__m128i a, __m128i g) {
+    a = _mm_xor_si128 (a, _mm_slli_si128 (a, 4));
+    a = _mm_xor_si128 (a, _mm_slli_si128 (a, 8));
+    return _mm_xor_si128 (a, g);
+}
+
+#define AES256_KEYSTEP(i, rcon)                                                         \
+    do {                                                                                \
+        k[i] = aes256_expand_aesni (                                                    \
+        k[i - 2], _mm_shuffle_epi32 (_mm_aeskeygenassist_si128 (k[i - 1], rcon), 0xFF)); \
+        if (i < 14)                                                                     \
+            k[i + 1] = aes256_expand_aesni (                                            \
+            k[i - 1], _mm_shuffle_epi32 (_mm_aeskeygenassist_si128 (k[i], 0), 0xAA));   \
+    } while (0)
+
+__attribute__ ((target ("aes,sse2"))) void aes256_setkey_aesni (aes256_ctx *ctx, const uint8_t key[32]) {
+    __m128i k[15];
+    unsigned int i;
+
+    k[0] = _mm_loadu_si128 ((const __m128i *)key);
+    k[1] = _mm_loadu_si128 ((const __m128i *)(key + 16));
+    AES256_KEYSTEP (2, 0x01);
+    AES256_KEYSTEP (4, 0x02);
+    AES256_KEYSTEP (6, 0x04);
+    AES256_KEYSTEP (8, 0x08);
+    AES256_KEYSTEP (10, 0x10);
+    AES256_KEYSTEP (12, 0x20);
+    AES256_KEYSTEP (14, 0x40);
+
+    for (i = 0; i < 15; i++) _mm_storeu_si128 ((__m128i *)(ctx->rk + 16 * i), k[i]);
+}
+
+#undef AES256_KEYSTEP
+
+/* four blocks are interleaved to cover the latency of aesenc */
+__attribute__ ((target ("aes,sse2"))) void
+aes256_ecb_aesni (const aes256_ctx *ctx, uint8_t *out, const uint8_t *in, size_t nblocks) {
+    __m128i k[15], b0, b1, b2, b3;
+    unsigned int i;
+
+    for (i = 0; i < 15; i++) k[i] = _mm_loadu_si128 ((const __m128i *)(ctx->rk + 16 * i));
+
+    for (; nblocks >= 4; nblocks -= 4, in += 64, out += 64) {
+        b0 = _mm_xor_si128 (_mm_loadu_si128 ((const __m128i *)in), k[0]);
+        b1 = _mm_xor_si128 (_mm_loadu_si128 ((const __m128i *)(in + 16)), k[0]);
+        b2 = _mm_xor_si128 (_mm_loadu_si128 ((const __m128i *)(in + 32)), k[0]);
+        b3 = _mm_xor_si128 (_mm_loadu_si128 ((const __m128i *)(in + 48)), k[0]);
+        for (i = 1; i < 14; i++) {
+            b0 = _mm_aesenc_si128 (b0, k[i]);
+            b1 = _mm_aesenc_si128 (b1, k[i]);
+            b2 = _mm_aesenc_si128 (b2, k[i]);
+            b3 = _mm_aesenc_si128 (b3, k[i]);
+        }
+        _mm_storeu_si128 ((__m128i *)out, _mm_aesenclast_si128 (b0, k[14]));
+        _mm_storeu_si128 ((__m128i *)(out + 16), _mm_aesenclast_si128 (b1, k[14]));
+        _mm_storeu_si128 ((__m128i *)(out + 32), _mm_aesenclast_si128 (b2, k[14]));
+        _mm_storeu_si128 ((__m128i *)(out + 48), _mm_aesenclast_si128 (b3, k[14]));
+    }
+
+    for (; nblocks > 0; nblocks--, in += 16, out += 16) {
+        b0 = _mm_xor_si128 (_mm_loadu_si128 ((const __m128i *)in), k[0]);
+        for (i = 1; i < 14; i++) b0 = _mm_aesenc_si128 (b0, k[i]);
+        _mm_storeu_si128 ((__m128i *)out, _mm_aesenclast_si128 (b0, k[14]));
+    }
+}
+#endif
@@ -0,0 +1,26 @@
+#ifndef AES256_H
+#define AES256_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Expanded AES-256 key: 15 round keys in FIPS-197 byte order, the layout
+ * shared by the portable code and AES-NI */
+typedef struct {
+    uint8_t rk[15 * 16];
+} aes256_ctx;
+
+void aes256_setkey (aes256_ctx *ctx, const uint8_t key[32]);
+
+/* Encrypts nblocks independent 16-byte blocks; out may equal in */
+void aes256_ecb (const aes256_ctx *ctx, uint8_t *out, const uint8_t *in, size_t nblocks);
+
+/* Backend kernels; the functions above dispatch to one of these through
+ * pqgo_dispatch (see c/dispatch/dispatch.h). The portable code computes the
+ * S-box arithmetically and runs in constant time. */
+void aes256_setkey_ref (aes256_ctx *ctx, const uint8_t key[32]);
+void aes256_ecb_ref (const aes256_ctx *ctx, uint8_t *out, const uint8_t *in, size_t nblocks);
+void aes256_setkey_aesni (aes256_ctx *ctx, const uint8_t key[32]);
+void aes256_ecb_aesni (const aes256_ctx *ctx, uint8_t *out, const uint8_t *in, size_t nblocks);
+
+#endif
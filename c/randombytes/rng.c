@@ -4,17 +4,133 @@
 #include "rng.h"
 #include "xof_hash.h"
 
+#include <string.h>
+
+// AES-256 CTR_DRBG of SP 800-90A without derivation function, following
+// the NIST PQC rng.c; V is a 128-bit big-endian counter
+
+static void ctr_drbg_increment (uint8_t v[16]) {
+    int j;
+
+    for (j = 15; j >= 0; j--)
+        if (++v[j] != 0) break;
+}
+
+static void ctr_drbg_update (ctr_drbg_ctx *d, const uint8_t *provided_data) {
+    uint8_t temp[48];
+    int i;
+
+    for (i = 0; i < 3; i++) {
+        ctr_drbg_increment (d->v);
+        memcpy (temp + 16 * i, d->v, 16);
+    }
+    aes256_ecb (&d->aes, temp, temp, 3);
+    if (provided_data != NULL)
+        for (i = 0; i < 48; i++) temp[i] ^= provided_data[i];
+
+    aes256_setkey (&d->aes, temp);
+    memcpy (d->v, temp + 32, 16);
+}
+
+static void ctr_drbg_init (ctr_drbg_ctx *d,
+                           const unsigned char *entropy_input,
+                           const unsigned char *personalization_string) {
+    uint8_t seed_material[48], key[32];
+    int i;
+
+    memcpy (seed_material, entropy_input, 48);
+    if (personalization_string != NULL)
+        for (i = 0; i < 48; i++) seed_material[i] ^= personalization_string[i];
+
+    memset (key, 0, 32);
+    memset (d->v, 0, 16);
+    aes256_setkey (&d->aes, key);
+    ctr_drbg_update (d, seed_material);
+    d->reseed_counter = 1;
+}
+
+// counter blocks are encrypted eight at a time; the bytes of a partial
+// last block are dropped, as in the NIST code
+static void ctr_drbg_generate (ctr_drbg_ctx *d, unsigned char *x, unsigned long long xlen) {
+    uint8_t buf[8 * 16];
+    unsigned long long m;
+    unsigned int i, n;
+
+    while (xlen > 0) {
+        n = xlen >= sizeof (buf) ? 8 : (unsigned int)((xlen + 15) / 16);
+        for (i = 0; i < n; i++) {
+            ctr_drbg_increment (d->v);
+            memcpy (buf + 16 * i, d->v, 16);
+        }
+        aes256_ecb (&d->aes, buf, buf, n);
+
+        m = xlen < 16 * n ? xlen : 16 * n;
+        memcpy (x, buf, m);
+        x += m;
+        xlen -= m;
+    }
+    ctr_drbg_update (d, NULL);
+    d->reseed_counter++;
+}
+
 // state for randombytes
 
-static XOF_ctx rng_xof;
+static rng_ctx rng_global;
+static int rng_global_backend = RNG_SHAKE256;
+
+int rng_init (rng_ctx *ctx,
+              int backend,
+              const unsigned char *entropy_input,
+              const unsigned char *personalization_string) {
+    unsigned char seed[96];
+
+    switch (backend) {
+    case RNG_SHAKE256:
+        memcpy (seed, entropy_input, 48);
+        if (personalization_string != NULL) memcpy (seed + 48, personalization_string, 48);
+        XOF_absorb (&ctx->u.xof, seed, personalization_string != NULL ? 96 : 48);
+        break;
+    case RNG_AES256_CTR_DRBG:
+        ctr_drbg_init (&ctx->u.drbg, entropy_input, personalization_string);
+        break;
+    default:
+        return RNG_BAD_BACKEND;
+    }
+    ctx->backend = backend;
+    return RNG_SUCCESS;
+}
+
+int rng_bytes (rng_ctx *ctx, unsigned char *x, unsigned long long xlen) {
+    if (ctx == NULL) ctx = &rng_global;
+
+    if (ctx->backend == RNG_AES256_CTR_DRBG)
+        ctr_drbg_generate (&ctx->u.drbg, x, xlen);
+    else
+        XOF_squeeze (&ctx->u.xof, x, xlen);
+    return RNG_SUCCESS;
+}
+
+// volatile stores so that wiping a context about to go out of scope is
+// not optimized away
+void rng_wipe (rng_ctx *ctx) {
+    volatile unsigned char *p = (volatile unsigned char *)ctx;
+    size_t i;
+
+    for (i = 0; i < sizeof (rng_ctx); i++) p[i] = 0;
+}
+
+int randombytes_select (int backend) {
+    if (backend != RNG_SHAKE256 && backend != RNG_AES256_CTR_DRBG) return RNG_BAD_BACKEND;
+    rng_global_backend = backend;
+    return RNG_SUCCESS;
+}
 
 void randombytes_init (unsigned char *entropy_input,
                        unsigned char *personalization_string,
                        int security_strength) {
-    XOF_absorb (&rng_xof, entropy_input, 48);
+    rng_init (&rng_global, rng_global_backend, entropy_input, personalization_string);
 }
 
 int randombytes (unsigned char *x, unsigned long long xlen) {
-    XOF_squeeze (&rng_xof, x, xlen);
-    return 0;
+    return rng_bytes (NULL, x, xlen);
 }
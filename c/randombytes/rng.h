@@ -4,10 +4,52 @@
 #ifndef __RNG_H__
 #define __RNG_H__
 
+#include "aes256.h"
+#include "xof_hash.h"
+
 #define RNG_SUCCESS 0
 #define RNG_BAD_MAXLEN -1
 #define RNG_BAD_OUTBUF -2
 #define RNG_BAD_REQ_LEN -3
+#define RNG_BAD_BACKEND -4
+
+// generators behind an rng_ctx
+#define RNG_SHAKE256 0        // SHAKE256 of entropy (|| personalization)
+#define RNG_AES256_CTR_DRBG 1 // SP 800-90A AES-256 CTR_DRBG, no df, as in
+                              // the rng.c of the NIST PQC KAT generators
+
+typedef struct {
+    aes256_ctx aes; // expanded Key
+    uint8_t v[16];
+    unsigned long long reseed_counter;
+} ctr_drbg_ctx;
+
+// Deterministic RNG state. Each call of the KEM entry points seeds its own
+// context, so concurrent calls never share state.
+typedef struct {
+    int backend;
+    union {
+        XOF_ctx xof;
+        ctr_drbg_ctx drbg;
+    } u;
+} rng_ctx;
+
+// seeds ctx from 48 bytes of entropy and an optional 48-byte
+// personalization string (NULL for none)
+int rng_init (rng_ctx *ctx,
+              int backend,
+              const unsigned char *entropy_input,
+              const unsigned char *personalization_string);
+
+// a NULL ctx selects the process-wide state of randombytes_init
+int rng_bytes (rng_ctx *ctx, unsigned char *x, unsigned long long xlen);
+
+// zeroes ctx, e.g. before a context on the stack goes out of scope
+void rng_wipe (rng_ctx *ctx);
+
+// backend of the process-wide state from the next randombytes_init on;
+// RNG_AES256_CTR_DRBG reproduces the NIST KAT files
+int randombytes_select (int backend);
 
 void randombytes_init (unsigned char *entropy_input,
                        unsigned char *personalization_string,
@@ -8,16 +8,38 @@ void XOF_absorb (XOF_ctx *ctx, const void *data, size_t len) {
     ctx->pt = SHAKE256_RATE;
 }
 
+// copy n output bytes starting at byte offset pos of the rate lanes
+
+static void XOF_extract (const uint64_t *st, uint8_t *out, size_t pos, size_t n) {
+    size_t i;
+
+    for (i = 0; i < n; i++, pos++) out[i] = st[pos / 8] >> 8 * (pos % 8);
+}
+
+// squeeze: leftover bytes of the current block first, then whole blocks
+// straight into the output, and the tail from a freshly permuted state
+
 void XOF_squeeze (XOF_ctx *ctx, void *data, size_t len) {
-    size_t i, j;
-
-    i = ctx->pt;
-    for (j = 0; j < len; j++) {
-        if (i >= SHAKE256_RATE) {
-            shake256_squeezeblocks (ctx->byt, 1, ctx->st);
-            i = 0;
-        }
-        ((uint8_t *)data)[j] = ctx->byt[i++];
+    uint8_t *out = (uint8_t *)data;
+    size_t n;
+
+    n = SHAKE256_RATE - ctx->pt;
+    if (n > len) n = len;
+    XOF_extract (ctx->st, out, ctx->pt, n);
+    ctx->pt += n;
+    out += n;
+    len -= n;
+
+    if (len >= SHAKE256_RATE) {
+        n = len / SHAKE256_RATE;
+        shake256_squeezeblocks (out, n, ctx->st);
+        out += n * SHAKE256_RATE;
+        len -= n * SHAKE256_RATE;
+    }
+
+    if (len > 0) {
+        KeccakF1600_StatePermute (ctx->st);
+        XOF_extract (ctx->st, out, 0, len);
+        ctx->pt = len;
     }
-    ctx->pt = i;
 }
@@ -10,9 +10,10 @@
 #include "../fips202/fips202.h"
 #include "../fips202/keccakf1600.h"
 
+// output is read straight from the rate lanes of st; pt is the byte
+// offset of the next unread output byte in the current block
 typedef struct {
     uint64_t st[25];
-    uint8_t byt[SHAKE256_RATE];
     size_t pt;
 } XOF_ctx;
 
@@ -20,6 +21,19 @@ typedef struct {
 void XOF_absorb (XOF_ctx *ctx, const void *data, size_t len);
 void XOF_squeeze (XOF_ctx *ctx, void *data, size_t len);
 
+// fixed-width draw of the next two bytes as a little-endian integer;
+// same stream position and value as XOF_squeeze of 2 bytes
+static inline uint16_t XOF_squeeze_u16 (XOF_ctx *ctx) {
+    uint8_t b[2];
+
+    if (ctx->pt + 2 <= SHAKE256_RATE && !(ctx->pt & 1)) {
+        ctx->pt += 2;
+        return ctx->st[(ctx->pt - 2) / 8] >> 8 * ((ctx->pt - 2) % 8);
+    }
+    XOF_squeeze (ctx, b, 2);
+    return b[0] | ((uint16_t)b[1] << 8);
+}
+
 #define XOF_hash(output, input, input_byte_len, output_byte_len)               \
     shake256 ((unsigned char *)(output), (size_t) (output_byte_len),           \
               (const unsigned char *)(input), (size_t) (input_byte_len))
@@ -4,6 +4,7 @@
 #ifndef _API_H_
 #define _API_H_
 
+#include "../randombytes/rng.h"
 #include "params.h"
 
 /*
@@ -22,12 +23,16 @@
 
 int round5_kem_keypair (char *pk, char *sk);
 
+int round5_kem_keypair_rng (char *pk, char *sk, rng_ctx *rng);
+
 int round5_kem_keypair_entropy (char *pk, char *sk, const char *entropy);
 
 // Encapsulate: (ct, ss) = Encaps(pk)
 
 int round5_kem_enc (unsigned char *ct, unsigned char *ss, const unsigned char *pk);
 
+int round5_kem_enc_rng (unsigned char *ct, unsigned char *ss, const unsigned char *pk, rng_ctx *rng);
+
 int round5_kem_enc_entropy (char *ct, char *ss, const char *pk, const char *entropy);
 
 
@@ -76,20 +76,21 @@ static void unpack_ndp (modp_t *vp, const uint8_t *pv) {
 #endif
 }
 
-// generate a keypair (sigma, B)
+// generate a keypair (sigma, B), drawing randomness from rng
+// (NULL for the process-wide randombytes state)
 
-int generate_keypair (uint8_t *pk, uint8_t *sk) {
+int generate_keypair_rng (uint8_t *pk, uint8_t *sk, rng_ctx *rng) {
     modq_t A[PARAMS_ND];
     modq_t B[PARAMS_ND + PARAMS_MUL_PAD];
 
     uint16_t S_idx[PARAMS_H / 2][2];
 
-    randombytes (pk, PARAMS_SS_SIZE); // sigma = seed of A
+    rng_bytes (rng, pk, PARAMS_SS_SIZE); // sigma = seed of A
     XOF_hash (A, pk, PARAMS_SS_SIZE, PARAMS_ND * sizeof (modq_t));
 #if __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
     flip16vec (A, PARAMS_ND);
 #endif
-    randombytes (sk, PARAMS_SK_SIZE); // secret key -- Random S
+    rng_bytes (rng, sk, PARAMS_SK_SIZE); // secret key -- Random S
     create_spter_idx (S_idx, sk, PARAMS_SK_SIZE);
 
     ringmul_q (B, A, S_idx); // B = A * S
@@ -100,6 +101,10 @@ int generate_keypair (uint8_t *pk, uint8_t *sk) {
     return 0;
 }
 
+int generate_keypair (uint8_t *pk, uint8_t *sk) {
+    return generate_keypair_rng (pk, sk, NULL);
+}
+
 int encrypt_rho (uint8_t *ct, const uint8_t *m, const uint8_t *rho, const uint8_t *pk) {
     size_t i, j;
     modq_t A[PARAMS_ND];
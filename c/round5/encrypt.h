@@ -7,9 +7,12 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "../randombytes/rng.h"
+
 int encrypt_rho (uint8_t *c, const uint8_t *m, const uint8_t *rho, const uint8_t *pk);
 
 int generate_keypair (uint8_t *pk, uint8_t *sk);
+int generate_keypair_rng (uint8_t *pk, uint8_t *sk, rng_ctx *rng);
 
 int encrypt (uint8_t *c, const uint8_t *m, const uint8_t *pk);
 
@@ -19,7 +19,7 @@ int main() {
 
     memset(ent, 0x00, 32);
 
-    round5_kem_keypair_cgo(pk, sk, ent);
+    round5_kem_keypair_cgo(pk, sk, ent, RNG_SHAKE256);
 
     fd = open("round5_sk.golden", O_CREAT | O_WRONLY, 0644);
     write(fd, sk, ROUND5_SECRETKEYBYTES);
@@ -29,7 +29,7 @@ int main() {
     write(fd, pk, ROUND5_PUBLICKEYBYTES);
     close(fd);
 
-    round5_kem_enc_cgo(ct, ss, pk, ent);
+    round5_kem_enc_cgo(ct, ss, pk, ent, RNG_SHAKE256);
 
     fd = open("round5_ss.golden", O_CREAT | O_WRONLY, 0644);
     write(fd, ss, PARAMS_SS_SIZE);
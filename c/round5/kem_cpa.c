@@ -17,29 +17,41 @@
 // CPA-KEM KeyGen()
 
 int round5_kem_keypair (char *pk, char *sk) {
-    generate_keypair ((uint8_t *)pk, (uint8_t *)sk);
+    return round5_kem_keypair_rng (pk, sk, NULL);
+}
 
-    return 0;
+int round5_kem_keypair_rng (char *pk, char *sk, rng_ctx *rng) {
+    return generate_keypair_rng ((uint8_t *)pk, (uint8_t *)sk, rng);
 }
 
 /* TESERAKT */
-int round5_kem_keypair_cgo (char *pk, char *sk, const char *entropy) {
-    randombytes_init ((unsigned char *)entropy, NULL, 0);
-    generate_keypair ((uint8_t *)pk, (uint8_t *)sk);
-
-    return 0;
+int round5_kem_keypair_cgo (char *pk, char *sk, const char *entropy, int rng_backend) {
+    rng_ctx rng;
+    int ret;
+
+    if (rng_init (&rng, rng_backend, (const unsigned char *)entropy, NULL)) {
+        rng_wipe (&rng);
+        return -1;
+    }
+    ret = round5_kem_keypair_rng (pk, sk, &rng);
+    rng_wipe (&rng);
+    return ret;
 }
 
 // CPA-KEM Encaps()
 
 int round5_kem_enc (uint8_t *ct, uint8_t *ss, const uint8_t *pk) {
+    return round5_kem_enc_rng (ct, ss, pk, NULL);
+}
+
+int round5_kem_enc_rng (uint8_t *ct, uint8_t *ss, const uint8_t *pk, rng_ctx *rng) {
     uint8_t hash_input[PARAMS_SS_SIZE + ROUND5_CIPHERTEXTBYTES];
     uint8_t m[PARAMS_SS_SIZE];
     uint8_t rho[PARAMS_SS_SIZE];
 
     // Generate a random m
-    randombytes (m, PARAMS_SS_SIZE);
-    randombytes (rho, PARAMS_SS_SIZE);
+    rng_bytes (rng, m, PARAMS_SS_SIZE);
+    rng_bytes (rng, rho, PARAMS_SS_SIZE);
     encrypt_rho (ct, m, rho, pk);
 
     // K = H(m, c)
@@ -51,10 +63,18 @@ int round5_kem_enc (uint8_t *ct, uint8_t *ss, const uint8_t *pk) {
 }
 
 /* TESERAKT */
-int round5_kem_enc_cgo (char *ct, char *ss, const char *pk, const char *entropy) {
-    randombytes_init ((unsigned char *)entropy, NULL, 0);
-    return round5_kem_enc ((unsigned char *)ct, (unsigned char *)ss,
-                           (const unsigned char *)pk);
+int round5_kem_enc_cgo (char *ct, char *ss, const char *pk, const char *entropy, int rng_backend) {
+    rng_ctx rng;
+    int ret;
+
+    if (rng_init (&rng, rng_backend, (const unsigned char *)entropy, NULL)) {
+        rng_wipe (&rng);
+        return -1;
+    }
+    ret = round5_kem_enc_rng ((unsigned char *)ct, (unsigned char *)ss,
+                              (const unsigned char *)pk, &rng);
+    rng_wipe (&rng);
+    return ret;
 }
 
 
@@ -25,10 +25,7 @@ void create_spter_idx (uint16_t idx[PARAMS_H / 2][2], const uint8_t *seed, const
     for (i = 0; i < PARAMS_H; i++) {
         do {
             do {
-                XOF_squeeze (&xof, &x, 2);
-#if __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
-                x = ((x << 8) ^ (x >> 8)) & 0xFFFF;
-#endif
+                x = XOF_squeeze_u16 (&xof);
             } while (x >= PARAMS_RS_LIM);
             x /= PARAMS_RS_DIV;
         } while (v[x]);
@@ -39,9 +36,9 @@ void create_spter_idx (uint16_t idx[PARAMS_H / 2][2], const uint8_t *seed, const
 
 // multiplication mod q, result length n
 
-void ringmul_q (modq_t d[PARAMS_ND + PARAMS_MUL_PAD],
-                const modq_t a[PARAMS_ND],
-                const uint16_t idx[PARAMS_H / 2][2]) {
+void ringmul_q_ref (modq_t d[PARAMS_ND + PARAMS_MUL_PAD],
+                    const modq_t a[PARAMS_ND],
+                    const uint16_t idx[PARAMS_H / 2][2]) {
     size_t i, j;
     modq_t t;
     modq_t *qt, *rt;
@@ -120,9 +117,9 @@ void ringmul_q (modq_t d[PARAMS_ND + PARAMS_MUL_PAD],
 
 // multiplication mod p, result length mu
 
-void ringmul_p (modp_t d[PARAMS_MU + PARAMS_MUL_PAD],
-                const modp_t a[PARAMS_ND],
-                const uint16_t idx[PARAMS_H / 2][2]) {
+void ringmul_p_ref (modp_t d[PARAMS_MU + PARAMS_MUL_PAD],
+                    const modp_t a[PARAMS_ND],
+                    const uint16_t idx[PARAMS_H / 2][2]) {
     int i, j;
     modp_t *qt, *rt;
     modp_t p[(PARAMS_ND + 1) + PARAMS_MU + PARAMS_MUL_PAD];
@@ -194,4 +191,132 @@ void ringmul_p (modp_t d[PARAMS_MU + PARAMS_MUL_PAD],
     }
 }
 
+#if defined(__x86_64__)
+
+#include <immintrin.h>
+
+// d[j] += qt[j] - rt[j] for j < n, 16 or 32 coefficients per step
+
+static inline __attribute__ ((target ("avx2"), always_inline)) void
+ringmul_acc16_avx2 (uint16_t *d, const uint16_t *qt, const uint16_t *rt, size_t n) {
+    size_t j;
+    __m256i q, r, t;
+
+    for (j = 0; j + 16 <= n; j += 16) {
+        q = _mm256_loadu_si256 ((const __m256i *)&qt[j]);
+        r = _mm256_loadu_si256 ((const __m256i *)&rt[j]);
+        t = _mm256_loadu_si256 ((const __m256i *)&d[j]);
+        t = _mm256_add_epi16 (t, _mm256_sub_epi16 (q, r));
+        _mm256_storeu_si256 ((__m256i *)&d[j], t);
+    }
+    for (; j < n; j++) d[j] += qt[j] - rt[j];
+}
+
+#if (PARAMS_P_BITS <= 8)
+static inline __attribute__ ((target ("avx2"), always_inline)) void
+ringmul_acc8_avx2 (uint8_t *d, const uint8_t *qt, const uint8_t *rt, size_t n) {
+    size_t j;
+    __m256i q, r, t;
+
+    for (j = 0; j + 32 <= n; j += 32) {
+        q = _mm256_loadu_si256 ((const __m256i *)&qt[j]);
+        r = _mm256_loadu_si256 ((const __m256i *)&rt[j]);
+        t = _mm256_loadu_si256 ((const __m256i *)&d[j]);
+        t = _mm256_add_epi8 (t, _mm256_sub_epi8 (q, r));
+        _mm256_storeu_si256 ((__m256i *)&d[j], t);
+    }
+    for (; j < n; j++) d[j] += qt[j] - rt[j];
+}
+#define ringmul_accp_avx2 ringmul_acc8_avx2
+#else
+#define ringmul_accp_avx2 ringmul_acc16_avx2
+#endif
+
+// multiplication mod q, result length n; same as ringmul_q_ref
+
+__attribute__ ((target ("avx2"))) void
+ringmul_q_avx2 (modq_t d[PARAMS_ND + PARAMS_MUL_PAD],
+                const modq_t a[PARAMS_ND],
+                const uint16_t idx[PARAMS_H / 2][2]) {
+    size_t i;
+    modq_t t;
+    modq_t p[2 * (PARAMS_ND + 1) + PARAMS_MUL_PAD];
+
+    // duplicate for ring x^n-1
+    memcpy (p, a, PARAMS_ND * sizeof (modq_t));
+    p[PARAMS_ND] = 0;
+    memcpy (&p[PARAMS_ND + 1], p, (PARAMS_ND + 1) * sizeof (modq_t));
+
+    memset (d, 0, (PARAMS_ND + 1) * sizeof (modq_t));
+
+    for (i = 0; i < (PARAMS_H / 2); i++) {
+
+        // non-ternary distributions
+#ifdef PARAMS_H1
+        if (i == PARAMS_H1 / 2
+#ifdef PARAMS_H2
+            || i == (PARAMS_H1 + PARAMS_H2) / 2
+#endif
+        ) {
+            size_t j;
+            // get the next multiple of a
+            for (j = 0; j < PARAMS_ND; j++) {
+                p[j] += a[j];
+            }
+            // duplicate it
+            memcpy (&p[PARAMS_ND + 1], p, (PARAMS_ND + 1) * sizeof (modq_t));
+        }
+#endif /* PARAMS_H1 */
+
+        ringmul_acc16_avx2 (d, &p[idx[i][0]], &p[idx[i][1]], PARAMS_ND + 1);
+    }
+    t = d[PARAMS_ND]; // reduce mod Phi
+    for (i = 0; i < PARAMS_ND; i++) {
+        d[i] -= t;
+    }
+}
+
+// multiplication mod p, result length mu; same as ringmul_p_ref
+
+__attribute__ ((target ("avx2"))) void
+ringmul_p_avx2 (modp_t d[PARAMS_MU + PARAMS_MUL_PAD],
+                const modp_t a[PARAMS_ND],
+                const uint16_t idx[PARAMS_H / 2][2]) {
+    size_t i;
+    modp_t p[(PARAMS_ND + 1) + PARAMS_MU + PARAMS_MUL_PAD];
+
+    // duplicate a
+    memcpy (p, a, PARAMS_ND * sizeof (modp_t));
+    p[PARAMS_ND] = 0;
+    memcpy (&p[PARAMS_ND + 1], p, PARAMS_MU * sizeof (modp_t));
+
+    memset (d, 0, PARAMS_MU * sizeof (modp_t));
+
+    for (i = 0; i < PARAMS_H / 2; i++) {
+
+        // non-ternary distributions
+#ifdef PARAMS_H1
+        if (i == PARAMS_H1 / 2
+#ifdef PARAMS_H2
+            || i == (PARAMS_H1 + PARAMS_H2) / 2
+#endif
+        ) {
+            size_t j;
+            // get the next multiple of a
+            for (j = 0; j < PARAMS_ND; j++) {
+                p[j] += a[j];
+            }
+            // duplicate it
+            memcpy (&p[PARAMS_ND + 1], p, PARAMS_MU * sizeof (modp_t));
+        }
+#endif /* PARAMS_H1 */
+
+        ringmul_accp_avx2 (d, &p[idx[i][0]], &p[idx[i][1]], PARAMS_MU);
+    }
+}
+
+#undef ringmul_accp_avx2
+
+#endif /* __x86_64__ */
+
 #endif /* CM_CACHE */
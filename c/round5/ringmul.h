@@ -19,4 +19,20 @@ void ringmul_p (modp_t d[PARAMS_MU + PARAMS_MUL_PAD],
                 const modp_t a[PARAMS_ND],
                 const uint16_t idx[PARAMS_H / 2][2]);
 
+// backend kernels; ringmul_q and ringmul_p dispatch through pqgo_dispatch
+void ringmul_q_ref (modq_t d[PARAMS_ND + PARAMS_MUL_PAD],
+                    const modq_t a[PARAMS_ND],
+                    const uint16_t idx[PARAMS_H / 2][2]);
+void ringmul_p_ref (modp_t d[PARAMS_MU + PARAMS_MUL_PAD],
+                    const modp_t a[PARAMS_ND],
+                    const uint16_t idx[PARAMS_H / 2][2]);
+#if defined(__x86_64__) && !defined(CM_CACHE)
+void ringmul_q_avx2 (modq_t d[PARAMS_ND + PARAMS_MUL_PAD],
+                     const modq_t a[PARAMS_ND],
+                     const uint16_t idx[PARAMS_H / 2][2]);
+void ringmul_p_avx2 (modp_t d[PARAMS_MU + PARAMS_MUL_PAD],
+                     const modp_t a[PARAMS_ND],
+                     const uint16_t idx[PARAMS_H / 2][2]);
+#endif
+
 #endif /* _RINGMUL_H_ */
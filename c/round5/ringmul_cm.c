@@ -66,10 +66,7 @@ void create_spter_idx (uint16_t idx[PARAMS_H / 2][2], const uint8_t *seed, const
     for (i = 0; i < PARAMS_H; i++) {
         do {
             do {
-                XOF_squeeze (&xof, &x, 2);
-#if __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
-                x = ((x << 8) ^ (x >> 8)) & 0xFFFF;
-#endif
+                x = XOF_squeeze_u16 (&xof);
             } while (x >= PARAMS_RS_LIM);
             x /= PARAMS_RS_DIV;
         } while (probe_cm (v, x));
@@ -79,9 +76,9 @@ void create_spter_idx (uint16_t idx[PARAMS_H / 2][2], const uint8_t *seed, const
 
 // multiplication mod q, result length n
 
-void ringmul_q (modq_t d[PARAMS_ND + PARAMS_MUL_PAD],
-                const modq_t a[PARAMS_ND],
-                const uint16_t idx[PARAMS_H / 2][2]) {
+void ringmul_q_ref (modq_t d[PARAMS_ND + PARAMS_MUL_PAD],
+                    const modq_t a[PARAMS_ND],
+                    const uint16_t idx[PARAMS_H / 2][2]) {
     size_t i, j, k;
     modq_t t, p[PARAMS_ND + 1];
 
@@ -128,9 +125,9 @@ void ringmul_q (modq_t d[PARAMS_ND + PARAMS_MUL_PAD],
 
 // multiplication mod p, result length mu
 
-void ringmul_p (modp_t d[PARAMS_MU + PARAMS_MUL_PAD],
-                const modp_t a[PARAMS_ND],
-                const uint16_t idx[PARAMS_H / 2][2]) {
+void ringmul_p_ref (modp_t d[PARAMS_MU + PARAMS_MUL_PAD],
+                    const modp_t a[PARAMS_ND],
+                    const uint16_t idx[PARAMS_H / 2][2]) {
     size_t i, j, k;
     modp_t p[PARAMS_ND + 1], e[PARAMS_ND];
 
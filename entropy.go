@@ -0,0 +1,125 @@
+package pqgo
+
+import (
+	"crypto/rand"
+	"os"
+	"sync"
+	"sync/atomic"
+	"syscall"
+	"unsafe"
+)
+
+// entropyBufLen is the number of bytes read from crypto/rand per refill
+const entropyBufLen = 4096
+
+// madvWipeOnFork is MADV_WIPEONFORK (Linux 4.14+); other kernels reject it
+const madvWipeOnFork = 18
+
+// entropyShard is a buffer of fresh randomness; slices are handed out from
+// the front and never reused, so callers may keep them
+type entropyShard struct {
+	buf []byte
+	gen uint64
+	pid int
+}
+
+var (
+	// The shards live in a sync.Pool, whose per-P caches make Get/Put
+	// lock-free in the common case. Shards dropped by the GC are refilled.
+	entropyShards = sync.Pool{
+		New: func() interface{} { return new(entropyShard) },
+	}
+
+	// entropyGen is bumped when a fork is detected; shards filled under an
+	// older generation are discarded
+	entropyGen uint64
+
+	// forkMarker is a word on a page the kernel zeroes in a forked child,
+	// nil if MADV_WIPEONFORK is not available. It is only accessed
+	// atomically: forkLive in a process whose shards are its own,
+	// forkHandling while the goroutine that saw it cleared bumps entropyGen.
+	forkMarker *uint32
+)
+
+const (
+	forkLive     = 1
+	forkHandling = 2
+)
+
+func init() {
+	mem, err := syscall.Mmap(-1, 0, os.Getpagesize(),
+		syscall.PROT_READ|syscall.PROT_WRITE, syscall.MAP_PRIVATE|syscall.MAP_ANON)
+	if err != nil {
+		return
+	}
+	if syscall.Madvise(mem, madvWipeOnFork) != nil {
+		syscall.Munmap(mem)
+		return
+	}
+	forkMarker = (*uint32)(unsafe.Pointer(&mem[0]))
+	atomic.StoreUint32(forkMarker, forkLive)
+}
+
+// forked reports whether the shard may hold randomness also held by
+// another process: a cleared fork marker, or without one, a pid change.
+// Only the goroutine that claims a cleared marker bumps entropyGen, and it
+// marks the process live again after that, so a shard of the parent is
+// never seen as current; until then every draw refills.
+func (s *entropyShard) forked() bool {
+	if forkMarker != nil {
+		switch atomic.LoadUint32(forkMarker) {
+		case forkLive:
+		case 0:
+			if atomic.CompareAndSwapUint32(forkMarker, 0, forkHandling) {
+				atomic.AddUint64(&entropyGen, 1)
+				atomic.StoreUint32(forkMarker, forkLive)
+			}
+			return true
+		default:
+			return true
+		}
+		return s.gen != atomic.LoadUint64(&entropyGen)
+	}
+	return s.pid != os.Getpid()
+}
+
+// refill replaces the shard buffer with a fresh one from crypto/rand
+func (s *entropyShard) refill() {
+	s.buf = make([]byte, entropyBufLen)
+	if _, err := rand.Read(s.buf); err != nil {
+		panic("random read failed")
+	}
+	s.gen = atomic.LoadUint64(&entropyGen)
+	if forkMarker == nil {
+		s.pid = os.Getpid()
+	}
+}
+
+// entropy returns n bytes of fresh randomness for the *Random methods,
+// refilling the shard when it runs out or after a fork
+func entropy(n int) []byte {
+	if n > entropyBufLen {
+		ent := make([]byte, n)
+		if _, err := rand.Read(ent); err != nil {
+			panic("random read failed")
+		}
+		return ent
+	}
+
+	s := entropyShards.Get().(*entropyShard)
+	if len(s.buf) < n || s.forked() {
+		s.refill()
+	}
+	ent := s.buf[:n:n]
+	s.buf = s.buf[n:]
+	entropyShards.Put(s)
+
+	return ent
+}
+
+// wipe clears entropy once it has been consumed
+func wipe(b []byte) {
+	for i := range b {
+		b[i] = 0
+	}
+}
@@ -0,0 +1,13 @@
+/* Kyber1024: the sources of c/kyber that depend on KYBER_K, compiled with
+ * k = 4 as a translation unit of their own. Their external symbols get
+ * the prefix kyber1024_ (see KYBER_NAMESPACE in c/kyber/params.h); the
+ * sources shared by all sets are included in the preamble of pqgo.go. */
+
+#define KYBER_K 4
+
+#include "c/kyber/kyber_poly.c"
+#include "c/kyber/kyber_polyvec.c"
+#include "c/kyber/cbd.c"
+#include "c/kyber/indcpa.c"
+#include "c/kyber/kem.c"
+#include "c/kyber/kex.c"
@@ -1,9 +1,20 @@
 package pqgo
 
 /*
+#cgo LDFLAGS: -lpthread
+
 #include "c/fips202/fips202.c"
 #include "c/fips202/keccakf1600.c"
-
+#include "c/fips202/keccakf1600_opt.c"
+#include "c/fips202/fips202x4.c"
+#include "c/fips202/keccakf1600x4.c"
+#include "c/fips202/fips202x8.c"
+#include "c/fips202/keccakf1600x8.c"
+#include "c/fips202/mbhash.c"
+#include "c/fips202/parallelhash.c"
+#include "c/parallel/parallel.c"
+
+#include "c/randombytes/aes256.c"
 #include "c/randombytes/rng.c"
 #include "c/randombytes/xof_hash.c"
 
@@ -14,16 +25,12 @@ package pqgo
 #include "c/round5/xecc.c"
 
 #include "c/kyber/params.h"
-#include "c/kyber/kyber_poly.c"
-#include "c/kyber/kyber_polyvec.c"
 #include "c/kyber/kyber_reduce.c"
 #include "c/kyber/kyber_ntt.c"
-#include "c/kyber/cbd.c"
-#include "c/kyber/indcpa.c"
-#include "c/kyber/kem.c"
-#include "c/kyber/kex.c"
+#include "c/kyber/kyber_compress.c"
 #include "c/kyber/precomp.c"
 #include "c/kyber/verify.c"
+#include "c/kyber/kyber_sets.c"
 
 #include "c/dilithium/params.h"
 #include "c/dilithium/poly.c"
@@ -33,11 +40,16 @@ package pqgo
 #include "c/dilithium/polyvec.c"
 #include "c/dilithium/reduce.c"
 #include "c/dilithium/rounding.c"
+
+#include "c/bulk/keygen.c"
+
+#include "c/dispatch/dispatch.c"
 */
 import "C"
 import (
-	"crypto/rand"
 	"errors"
+	"runtime"
+	"time"
 	"unsafe"
 )
 
@@ -63,6 +75,87 @@ var (
 	ErrDecrypt = errors.New("decrypt returned non-zero")
 )
 
+func init() {
+	C.pqgo_dispatch_init()
+}
+
+// Backend returns the name of the kernel set selected for this CPU at
+// startup: "ref", "opt", "avx2" or "avx512". The PQGO_BACKEND environment
+// variable caps the selection.
+func Backend() string {
+	return C.GoString(C.pqgo_dispatch_backend())
+}
+
+// selectBackend switches the kernel set; it must not run concurrently with
+// any other call into the package
+func selectBackend(name string) bool {
+	levels := map[string]C.int{
+		"ref":    C.PQGO_BACKEND_REF,
+		"opt":    C.PQGO_BACKEND_OPT,
+		"avx2":   C.PQGO_BACKEND_AVX2,
+		"avx512": C.PQGO_BACKEND_AVX512,
+	}
+	level, ok := levels[name]
+	return ok && C.pqgo_dispatch_select(level) == 0
+}
+
+// HashBatchStats counts the work of the multi-buffer hash scheduler
+type HashBatchStats struct {
+	Jobs            uint64 // hashes submitted
+	Batches         uint64 // vector permutation runs
+	FullBatches     uint64 // batches run with all lanes filled
+	DeadlineBatches uint64 // batches flushed partially filled on deadline
+	SoloJobs        uint64 // hashes done directly, no free batch slot
+	LanesUsed       uint64 // lanes carrying a job, over all batches
+	LanesTotal      uint64 // lanes available, over all batches
+}
+
+// Occupancy returns the fraction of vector lanes that carried a job
+func (s HashBatchStats) Occupancy() float64 {
+	if s.LanesTotal == 0 {
+		return 0
+	}
+	return float64(s.LanesUsed) / float64(s.LanesTotal)
+}
+
+// EnableHashBatching makes concurrent calls share 4- or 8-way Keccak
+// permutations for their fixed-length hashes: H(pk) and H(c) in Kyber
+// Encap/Decap, and CRH(pk) in Dilithium Open. A hash waits at most deadline
+// (under one second) for its batch to fill, so this only pays off with
+// many concurrent callers.
+func EnableHashBatching(lanes int, deadline time.Duration) error {
+	if lanes != 4 && lanes != 8 {
+		return errors.New("invalid lane count")
+	}
+	if deadline < 0 || deadline >= time.Second {
+		return errors.New("invalid deadline")
+	}
+	if C.mbhash_enable(C.uint(lanes), C.long(deadline.Nanoseconds())) != 0 {
+		return errors.New("mbhash_enable returned non-zero")
+	}
+	return nil
+}
+
+// DisableHashBatching goes back to hashing every call directly
+func DisableHashBatching() {
+	C.mbhash_disable()
+}
+
+// GetHashBatchStats returns the scheduler counters since process start
+func GetHashBatchStats() HashBatchStats {
+	var st C.mbhash_stats
+	C.mbhash_global_stats(&st)
+	return HashBatchStats{
+		Jobs:            uint64(st.jobs),
+		Batches:         uint64(st.batches),
+		FullBatches:     uint64(st.full_batches),
+		DeadlineBatches: uint64(st.deadline_batches),
+		SoloJobs:        uint64(st.solo_jobs),
+		LanesUsed:       uint64(st.lanes_used),
+		LanesTotal:      uint64(st.lanes_total),
+	}
+}
+
 // KEM ...
 type KEM interface {
 	KeyGen(ent []byte) ([]byte, []byte, error)
@@ -83,20 +176,314 @@ type Signature interface {
 // Dilithium ...
 type Dilithium struct{}
 
-// Kyber ...
-type Kyber struct{}
+// DilithiumMode selects how a Dilithium signature binds the message
+type DilithiumMode int
+
+const (
+	// DilithiumPure hashes the message itself into the signature
+	DilithiumPure DilithiumMode = C.DILITHIUM_MODE_PURE
+	// DilithiumTreePrehash signs a ParallelHash256 digest of the message,
+	// computed on a thread pool; meant for very large messages. Signatures
+	// only verify under the mode they were made with.
+	DilithiumTreePrehash DilithiumMode = C.DILITHIUM_MODE_TREE_PREHASH
+)
+
+func (mode DilithiumMode) valid() bool {
+	return mode == DilithiumPure || mode == DilithiumTreePrehash
+}
+
+// SetThreads sets the number of threads used by tree hashing and bulk key
+// generation, 0 meaning one per online CPU
+func SetThreads(n int) {
+	if n < 0 {
+		n = 0
+	}
+	C.pqgo_parallel_set_threads(C.uint(n))
+}
+
+// SetHashThreads sets the number of threads used by tree hashing,
+// 0 meaning one per online CPU. The pool is shared with bulk key
+// generation, so this is the same as SetThreads.
+func SetHashThreads(n int) {
+	SetThreads(n)
+}
+
+// RNGBackend selects how a KEM expands its entropy into the random bytes
+// of key generation and encapsulation
+type RNGBackend int
+
+const (
+	// RNGShake256 expands entropy with SHAKE256 (the default)
+	RNGShake256 RNGBackend = C.RNG_SHAKE256
+	// RNGCTRDRBG expands entropy with the AES-256 CTR_DRBG of the NIST
+	// KAT generators, on AES-NI where available
+	RNGCTRDRBG RNGBackend = C.RNG_AES256_CTR_DRBG
+)
+
+// Kyber is Kyber768, the parameter set recommended by the Kyber authors
+type Kyber struct {
+	// RNG selects the generator used by KeyGen and Encap
+	RNG RNGBackend
+}
+
+// Kyber768 is Kyber, named after its parameter set
+type Kyber768 = Kyber
+
+// Kyber512 is the smallest and fastest parameter set, with keys and
+// ciphertexts of two polynomials instead of three
+type Kyber512 struct {
+	// RNG selects the generator used by KeyGen and Encap
+	RNG RNGBackend
+}
+
+// Kyber1024 is the most conservative parameter set, with keys and
+// ciphertexts of four polynomials instead of three
+type Kyber1024 struct {
+	// RNG selects the generator used by KeyGen and Encap
+	RNG RNGBackend
+}
 
 // Round5 ...
-type Round5 struct{}
+type Round5 struct {
+	// RNG selects the generator used by KeyGen and Encap
+	RNG RNGBackend
+}
 
-// KeyGenRandom ...
-func (d Dilithium) KeyGenRandom() (pk, sk []byte, err error) {
-	ent := make([]byte, DilithiumEntropyLen)
-	_, err = rand.Read(ent)
+// rngBytes expands 48 bytes of entropy into n bytes with the given backend
+func rngBytes(backend RNGBackend, ent []byte, n int) []byte {
+	var rng C.rng_ctx
+	out := make([]byte, n)
 
-	if err != nil {
-		panic("random read failed")
+	if C.rng_init(&rng, C.int(backend), (*C.uchar)(unsafe.Pointer(&ent[0])), nil) != 0 {
+		return nil
 	}
+	C.rng_bytes(&rng, (*C.uchar)(unsafe.Pointer(&out[0])), C.ulonglong(n))
+	return out
+}
+
+// BulkSeedLen is the byte length of the master seed of KeyGenBulk
+const BulkSeedLen = C.PQGO_KEYGEN_SEEDBYTES
+
+// key types of the bulk keygen tree
+const (
+	bulkDilithium = C.PQGO_KEYGEN_DILITHIUM
+	bulkKyber     = C.PQGO_KEYGEN_KYBER
+	bulkRound5    = C.PQGO_KEYGEN_ROUND5
+	bulkKyber512  = C.PQGO_KEYGEN_KYBER512
+	bulkKyber1024 = C.PQGO_KEYGEN_KYBER1024
+)
+
+// keyGenBulk fills the pks and sks slabs with the keys of alg numbered
+// first, first+1, ... derived from seed
+func keyGenBulk(alg int, backend RNGBackend, seed []byte, first uint64, pks, sks []byte, pkLen, skLen int) error {
+	if len(seed) != BulkSeedLen {
+		return errors.New("invalid seed size")
+	}
+	count := len(pks) / pkLen
+	if count == 0 || len(pks) != count*pkLen {
+		return errors.New("invalid public key slab size")
+	}
+	if len(sks) != count*skLen {
+		return errors.New("invalid secret key slab size")
+	}
+
+	ret := C.pqgo_keygen_bulk(C.int(alg), C.int(backend),
+		(*C.uchar)(unsafe.Pointer(&pks[0])), (*C.uchar)(unsafe.Pointer(&sks[0])),
+		(*C.uchar)(unsafe.Pointer(&seed[0])), C.ulonglong(first), C.size_t(count))
+
+	if ret != 0 {
+		return ErrKeypair
+	}
+	return nil
+}
+
+// bulkEntropy returns the KeyGen entropy of key index in the tree of seed
+func bulkEntropy(alg int, seed []byte, index uint64, n int) []byte {
+	ent := make([]byte, n)
+	C.pqgo_keygen_entropy((*C.uchar)(unsafe.Pointer(&ent[0])), C.size_t(n), C.int(alg),
+		(*C.uchar)(unsafe.Pointer(&seed[0])), C.ulonglong(index))
+	return ent
+}
+
+// cptr returns a C pointer to the bytes of b, nil when b is empty
+func cptr(b []byte) *C.uchar {
+	if len(b) == 0 {
+		return nil
+	}
+	return (*C.uchar)(unsafe.Pointer(&b[0]))
+}
+
+// parallelHash256 computes ParallelHash256 of in with leaves of blocklen
+// bytes and customization string cstm into out
+func parallelHash256(out, in []byte, blocklen int, cstm []byte) {
+	C.parallelhash256(cptr(out), C.ulonglong(len(out)), cptr(in), C.ulonglong(len(in)),
+		C.ulonglong(blocklen), cptr(cstm), C.ulonglong(len(cstm)))
+}
+
+// cshake256 computes cSHAKE256 of in with function name name and
+// customization string cstm into out
+func cshake256(out, in, name, cstm []byte) {
+	var state C.keccak_state
+
+	C.cshake256_inc_init(&state, cptr(name), C.ulonglong(len(name)), cptr(cstm), C.ulonglong(len(cstm)))
+	C.shake256_inc_absorb(&state, cptr(in), C.ulonglong(len(in)))
+	C.cshake256_inc_finalize(&state)
+	C.shake256_inc_squeeze(cptr(out), C.ulonglong(len(out)), &state)
+}
+
+// hashOneShot hashes in into out with "shake128", "shake256" (any output
+// length), "sha3-256" or "sha3-512"
+func hashOneShot(name string, out, in []byte) {
+	var inp *C.uchar
+	if len(in) > 0 {
+		inp = (*C.uchar)(unsafe.Pointer(&in[0]))
+	}
+	outp := (*C.uchar)(unsafe.Pointer(&out[0]))
+	n := C.ulonglong(len(in))
+
+	switch name {
+	case "shake128":
+		C.shake128(outp, C.ulonglong(len(out)), inp, n)
+	case "shake256":
+		C.shake256(outp, C.ulonglong(len(out)), inp, n)
+	case "sha3-256":
+		C.sha3_256(outp, inp, n)
+	case "sha3-512":
+		C.sha3_512(outp, inp, n)
+	}
+}
+
+// hashIncremental is hashOneShot through the incremental context, in
+// absorbed in the pieces between consecutive offsets of cuts
+func hashIncremental(name string, out, in []byte, cuts []int) {
+	var state C.keccak_state
+	outp := (*C.uchar)(unsafe.Pointer(&out[0]))
+
+	switch name {
+	case "shake128":
+		C.shake128_inc_init(&state)
+	case "shake256":
+		C.shake256_inc_init(&state)
+	case "sha3-256":
+		C.sha3_256_inc_init(&state)
+	case "sha3-512":
+		C.sha3_512_inc_init(&state)
+	}
+	prev := 0
+	for _, cut := range append(cuts, len(in)) {
+		var inp *C.uchar
+		if cut > prev {
+			inp = (*C.uchar)(unsafe.Pointer(&in[prev]))
+		}
+		n := C.ulonglong(cut - prev)
+		switch name {
+		case "shake128":
+			C.shake128_inc_absorb(&state, inp, n)
+		case "shake256":
+			C.shake256_inc_absorb(&state, inp, n)
+		case "sha3-256":
+			C.sha3_256_inc_absorb(&state, inp, n)
+		case "sha3-512":
+			C.sha3_512_inc_absorb(&state, inp, n)
+		}
+		prev = cut
+	}
+	switch name {
+	case "shake128":
+		C.shake128_inc_finalize(&state)
+		C.shake128_inc_squeeze(outp, C.ulonglong(len(out)), &state)
+	case "shake256":
+		C.shake256_inc_finalize(&state)
+		C.shake256_inc_squeeze(outp, C.ulonglong(len(out)), &state)
+	case "sha3-256":
+		C.sha3_256_inc_finalize(outp, &state)
+	case "sha3-512":
+		C.sha3_512_inc_finalize(outp, &state)
+	}
+}
+
+// keccakPermute applies Keccak-f[1600] to each state, with the one-lane
+// permutation when lanes is 1 and else with the 4- or 8-way one on groups
+// of lanes states
+func keccakPermute(states [][25]uint64, lanes int) {
+	if lanes == 1 {
+		for i := range states {
+			C.KeccakF1600_StatePermute((*C.uint64_t)(unsafe.Pointer(&states[i][0])))
+		}
+		return
+	}
+	s := make([]uint64, 25*lanes)
+	for g := 0; g+lanes <= len(states); g += lanes {
+		for j := 0; j < lanes; j++ {
+			for i := 0; i < 25; i++ {
+				s[lanes*i+j] = states[g+j][i]
+			}
+		}
+		if lanes == 4 {
+			C.KeccakF1600x4_StatePermute((*C.uint64_t)(unsafe.Pointer(&s[0])))
+		} else {
+			C.KeccakF1600x8_StatePermute((*C.uint64_t)(unsafe.Pointer(&s[0])))
+		}
+		for j := 0; j < lanes; j++ {
+			for i := 0; i < 25; i++ {
+				states[g+j][i] = s[lanes*i+j]
+			}
+		}
+	}
+}
+
+// shake hashes in into out with SHAKE128 or SHAKE256 (bits 128 or 256)
+func shake(bits int, out, in []byte) {
+	var inp *C.uchar
+	if len(in) > 0 {
+		inp = (*C.uchar)(unsafe.Pointer(&in[0]))
+	}
+	outp := (*C.uchar)(unsafe.Pointer(&out[0]))
+	if bits == 128 {
+		C.shake128(outp, C.ulonglong(len(out)), inp, C.ulonglong(len(in)))
+	} else {
+		C.shake256(outp, C.ulonglong(len(out)), inp, C.ulonglong(len(in)))
+	}
+}
+
+// shakeLanes hashes the 4 or 8 equal-length inputs in one call of the
+// multi-lane SHAKE128 or SHAKE256; all outputs have the length of out[0]
+func shakeLanes(bits int, out, in [][]byte) {
+	lanes, inlen, outlen := len(in), len(in[0]), len(out[0])
+
+	// the 8-way functions take arrays of pointers, which cannot point to
+	// Go memory, so every buffer is copied to C memory
+	ptrs := (*[16]*C.uchar)(C.malloc(C.size_t(16 * unsafe.Sizeof((*C.uchar)(nil)))))
+	defer C.free(unsafe.Pointer(ptrs))
+	buf := C.malloc(C.size_t(lanes*(inlen+outlen) + 1))
+	defer C.free(buf)
+	mem := (*[1 << 20]byte)(buf)[: lanes*(inlen+outlen)+1 : lanes*(inlen+outlen)+1]
+	for j := 0; j < lanes; j++ {
+		copy(mem[j*inlen:], in[j])
+		ptrs[j] = (*C.uchar)(unsafe.Pointer(&mem[j*inlen]))
+		ptrs[8+j] = (*C.uchar)(unsafe.Pointer(&mem[lanes*inlen+j*outlen]))
+	}
+	n, m := C.ulonglong(inlen), C.ulonglong(outlen)
+
+	switch {
+	case lanes == 4 && bits == 128:
+		C.shake128x4(ptrs[8], ptrs[9], ptrs[10], ptrs[11], m, ptrs[0], ptrs[1], ptrs[2], ptrs[3], n)
+	case lanes == 4:
+		C.shake256x4(ptrs[8], ptrs[9], ptrs[10], ptrs[11], m, ptrs[0], ptrs[1], ptrs[2], ptrs[3], n)
+	case bits == 128:
+		C.shake128x8(&ptrs[8], m, &ptrs[0], n)
+	default:
+		C.shake256x8(&ptrs[8], m, &ptrs[0], n)
+	}
+	for j := 0; j < lanes; j++ {
+		copy(out[j], mem[lanes*inlen+j*outlen:lanes*inlen+(j+1)*outlen])
+	}
+}
+
+// KeyGenRandom ...
+func (d Dilithium) KeyGenRandom() (pk, sk []byte, err error) {
+	ent := entropy(DilithiumEntropyLen)
+	defer wipe(ent)
 
 	return d.KeyGen(ent)
 }
@@ -125,9 +512,28 @@ func (Dilithium) KeyGen(ent []byte) (pk, sk []byte, err error) {
 	return pk, sk, nil
 }
 
+// KeyGenBulk generates one keypair per public key slot of the slab pks,
+// writing them back to back into pks and sks on the thread pool (see
+// SetThreads).
+// Key i is KeyGen of entropy derived from seed and index first+i by a
+// SHAKE256 tree, so the output does not depend on the number of threads
+// and any range of keys can be regenerated on its own.
+func (Dilithium) KeyGenBulk(seed []byte, first uint64, pks, sks []byte) error {
+	return keyGenBulk(bulkDilithium, RNGShake256, seed, first, pks, sks,
+		C.DILITHIUM_PUBLICKEYBYTES, C.DILITHIUM_SECRETKEYBYTES)
+}
+
 // Sign ...
-func (Dilithium) Sign(m, sk []byte) (sm []byte, err error) {
+func (d Dilithium) Sign(m, sk []byte) (sm []byte, err error) {
+	return d.SignWithMode(m, sk, DilithiumPure)
+}
+
+// SignWithMode signs m, binding it as selected by mode
+func (Dilithium) SignWithMode(m, sk []byte, mode DilithiumMode) (sm []byte, err error) {
 
+	if !mode.valid() {
+		return nil, errors.New("invalid mode")
+	}
 	if len(sk) != C.DILITHIUM_SECRETKEYBYTES {
 		return nil, errors.New("invalid secret key size")
 	}
@@ -137,9 +543,9 @@ func (Dilithium) Sign(m, sk []byte) (sm []byte, err error) {
 
 	skp := (*C.char)(unsafe.Pointer(&sk[0]))
 	smp := (*C.char)(unsafe.Pointer(&sm[0]))
-	mp := (*C.char)(unsafe.Pointer(&m[0]))
+	mp := (*C.char)(unsafe.Pointer(cptr(m)))
 
-	ret := C.dilithium_sign_cgo(smp, mp, mlen, skp)
+	ret := C.dilithium_sign_mode_cgo(smp, mp, mlen, skp, C.int(mode))
 
 	if ret != 0 {
 		return nil, ErrSign
@@ -151,8 +557,16 @@ func (Dilithium) Sign(m, sk []byte) (sm []byte, err error) {
 }
 
 // Open ...
-func (Dilithium) Open(sm, pk []byte) (m []byte, err error) {
+func (d Dilithium) Open(sm, pk []byte) (m []byte, err error) {
+	return d.OpenWithMode(sm, pk, DilithiumPure)
+}
 
+// OpenWithMode verifies sm made by SignWithMode with the same mode
+func (Dilithium) OpenWithMode(sm, pk []byte, mode DilithiumMode) (m []byte, err error) {
+
+	if !mode.valid() {
+		return nil, errors.New("invalid mode")
+	}
 	if len(pk) != C.DILITHIUM_PUBLICKEYBYTES {
 		return nil, errors.New("invalid public key size")
 	}
@@ -167,7 +581,7 @@ func (Dilithium) Open(sm, pk []byte) (m []byte, err error) {
 	smp := (*C.char)(unsafe.Pointer(&sm[0]))
 	mp := (*C.char)(unsafe.Pointer(&m[0]))
 
-	ret := C.dilithium_sign_open_cgo(mp, smp, smlen, pkp)
+	ret := C.dilithium_sign_open_mode_cgo(mp, smp, smlen, pkp, C.int(mode))
 
 	if ret != 0 {
 		return nil, ErrOpen
@@ -178,49 +592,78 @@ func (Dilithium) Open(sm, pk []byte) (m []byte, err error) {
 	return m, nil
 }
 
-// KeyGenRandom ...
-func (k Kyber) KeyGenRandom() (pk, sk []byte, err error) {
-	ent := make([]byte, KyberEntropyLen)
-	_, err = rand.Read(ent)
+// kyberK selects a set in the C set layer (c/kyber/kyber_sets.h): the
+// number of polynomials of its vectors. Only the constants below are
+// valid; the C wrappers fail on any other value.
+type kyberK C.int
 
-	if err != nil {
-		panic("random read failed")
-	}
+const (
+	kyberK512  kyberK = 2
+	kyberK768  kyberK = 3
+	kyberK1024 kyberK = 4
+)
 
-	return k.KeyGen(ent)
+// kyberSet is a Kyber parameter set of the C set layer
+type kyberSet struct {
+	k                   kyberK
+	bulk                int
+	pkLen, skLen, ctLen int
 }
 
-// KeyGen ...
-func (Kyber) KeyGen(ent []byte) (pk, sk []byte, err error) {
+// The only kyberSet values; the Go types of the sets and the prepared
+// keys point to them
+var (
+	kyber512Set = &kyberSet{kyberK512, bulkKyber512,
+		C.KYBER512_PUBLICKEYBYTES, C.KYBER512_SECRETKEYBYTES, C.KYBER512_CIPHERTEXTBYTES}
+	kyber768Set = &kyberSet{kyberK768, bulkKyber,
+		C.KYBER768_PUBLICKEYBYTES, C.KYBER768_SECRETKEYBYTES, C.KYBER768_CIPHERTEXTBYTES}
+	kyber1024Set = &kyberSet{kyberK1024, bulkKyber1024,
+		C.KYBER1024_PUBLICKEYBYTES, C.KYBER1024_SECRETKEYBYTES, C.KYBER1024_CIPHERTEXTBYTES}
+)
+
+func (s *kyberSet) keyGen(rng RNGBackend, ent []byte) (pk, sk []byte, err error) {
 	if len(ent) != KyberEntropyLen {
 		return nil, nil, errors.New("invalid entropy size")
 	}
-	pk = make([]byte, C.KYBER_PUBLICKEYBYTES)
-	sk = make([]byte, C.KYBER_SECRETKEYBYTES)
+	pk = make([]byte, s.pkLen)
+	sk = make([]byte, s.skLen)
 
 	pkp := (*C.char)(unsafe.Pointer(&pk[0]))
 	skp := (*C.char)(unsafe.Pointer(&sk[0]))
 	entp := (*C.char)(unsafe.Pointer(&ent[0]))
 
-	ret := C.kyber_kem_keypair_cgo(pkp, skp, entp)
+	ret := C.kyber_set_keypair_cgo(C.int(s.k), pkp, skp, entp, C.int(rng))
 
 	if ret != 0 {
 		return nil, nil, ErrKeypair
 	}
 
-	pk = []byte(C.GoStringN(pkp, C.KYBER_PUBLICKEYBYTES))
-	sk = []byte(C.GoStringN(skp, C.KYBER_SECRETKEYBYTES))
+	pk = []byte(C.GoStringN(pkp, C.int(s.pkLen)))
+	sk = []byte(C.GoStringN(skp, C.int(s.skLen)))
 
 	return pk, sk, nil
 }
 
-// Encap ...
-func (Kyber) Encap(ent []byte, pk []byte) (ct, ss []byte, err error) {
+func (s *kyberSet) keyGenRandom(rng RNGBackend) (pk, sk []byte, err error) {
+	ent := entropy(KyberEntropyLen)
+	defer wipe(ent)
 
-	if len(pk) != C.KYBER_PUBLICKEYBYTES {
+	return s.keyGen(rng, ent)
+}
+
+func (s *kyberSet) keyGenBulk(rng RNGBackend, seed []byte, first uint64, pks, sks []byte) error {
+	return keyGenBulk(s.bulk, rng, seed, first, pks, sks, s.pkLen, s.skLen)
+}
+
+func (s *kyberSet) encap(rng RNGBackend, ent []byte, pk []byte) (ct, ss []byte, err error) {
+
+	if len(ent) != KyberEntropyLen {
+		return nil, nil, errors.New("invalid entropy size")
+	}
+	if len(pk) != s.pkLen {
 		return nil, nil, errors.New("invalid public key size")
 	}
-	ct = make([]byte, C.KYBER_CIPHERTEXTBYTES)
+	ct = make([]byte, s.ctLen)
 	ss = make([]byte, C.KYBER_SYMBYTES)
 
 	pkp := (*C.char)(unsafe.Pointer(&pk[0]))
@@ -228,33 +671,31 @@ func (Kyber) Encap(ent []byte, pk []byte) (ct, ss []byte, err error) {
 	ssp := (*C.char)(unsafe.Pointer(&ss[0]))
 	entp := (*C.char)(unsafe.Pointer(&ent[0]))
 
-	C.kyber_kem_enc_cgo(ctp, ssp, pkp, entp)
+	ret := C.kyber_set_enc_cgo(C.int(s.k), ctp, ssp, pkp, entp, C.int(rng))
 
-	ct = []byte(C.GoStringN(ctp, C.KYBER_CIPHERTEXTBYTES))
+	if ret != 0 {
+		return nil, nil, ErrEncrypt
+	}
+
+	ct = []byte(C.GoStringN(ctp, C.int(s.ctLen)))
 	ss = []byte(C.GoStringN(ssp, C.KYBER_SYMBYTES))
 
 	return ct, ss, nil
 }
 
-// EncapRandom ...
-func (k Kyber) EncapRandom(pk []byte) (ct, ss []byte, err error) {
-	ent := make([]byte, KyberEntropyLen)
-
-	_, err = rand.Read(ent)
+func (s *kyberSet) encapRandom(rng RNGBackend, pk []byte) (ct, ss []byte, err error) {
+	ent := entropy(KyberEntropyLen)
+	defer wipe(ent)
 
-	if err != nil {
-		panic("random read failed")
-	}
-	return k.Encap(ent, pk)
+	return s.encap(rng, ent, pk)
 }
 
-// Decap ...
-func (Kyber) Decap(ct, sk []byte) (ss []byte, err error) {
+func (s *kyberSet) decap(ct, sk []byte) (ss []byte, err error) {
 
-	if len(sk) != C.KYBER_SECRETKEYBYTES {
+	if len(sk) != s.skLen {
 		return nil, errors.New("invalid secret key size")
 	}
-	if len(ct) != C.KYBER_CIPHERTEXTBYTES {
+	if len(ct) != s.ctLen {
 		return nil, errors.New("invalid ciphertext size")
 	}
 	ss = make([]byte, C.KYBER_SYMBYTES)
@@ -263,27 +704,685 @@ func (Kyber) Decap(ct, sk []byte) (ss []byte, err error) {
 	ctp := (*C.char)(unsafe.Pointer(&ct[0]))
 	ssp := (*C.char)(unsafe.Pointer(&ss[0]))
 
-	C.kyber_kem_dec_cgo(ssp, ctp, skp)
+	ret := C.kyber_set_dec_cgo(C.int(s.k), ssp, ctp, skp)
+
+	if ret != 0 {
+		return nil, ErrDecrypt
+	}
 
 	ss = []byte(C.GoStringN(ssp, C.KYBER_SYMBYTES))
 
 	return ss, nil
 }
 
+func (s *kyberSet) encapBatch(rng RNGBackend, ents, pks, cts, sss []byte) error {
+	n := len(ents) / KyberEntropyLen
+	if n == 0 || len(ents) != n*KyberEntropyLen {
+		return errors.New("invalid entropy slab size")
+	}
+	if len(pks) != n*s.pkLen {
+		return errors.New("invalid public key slab size")
+	}
+	if len(cts) != n*s.ctLen {
+		return errors.New("invalid ciphertext slab size")
+	}
+	if len(sss) != n*C.KYBER_SYMBYTES {
+		return errors.New("invalid shared secret slab size")
+	}
+
+	ret := C.kyber_set_enc_batch_cgo(C.int(s.k), (*C.char)(unsafe.Pointer(&cts[0])),
+		(*C.char)(unsafe.Pointer(&sss[0])), (*C.char)(unsafe.Pointer(&pks[0])),
+		(*C.char)(unsafe.Pointer(&ents[0])), C.size_t(n), C.int(rng))
+
+	if ret != 0 {
+		return ErrEncrypt
+	}
+	return nil
+}
+
+func (s *kyberSet) encapBatchRandom(rng RNGBackend, pks, cts, sss []byte) error {
+	ent := entropy(len(pks) / s.pkLen * KyberEntropyLen)
+	defer wipe(ent)
+
+	return s.encapBatch(rng, ent, pks, cts, sss)
+}
+
+func (s *kyberSet) decapBatch(cts, sk, sss []byte) error {
+	if len(sk) != s.skLen {
+		return errors.New("invalid secret key size")
+	}
+	n, err := s.decapBatchLen(cts, sss)
+	if err != nil {
+		return err
+	}
+
+	ret := C.kyber_set_dec_batch_cgo(C.int(s.k), (*C.char)(unsafe.Pointer(&sss[0])),
+		(*C.char)(unsafe.Pointer(&cts[0])), C.size_t(n), (*C.char)(unsafe.Pointer(&sk[0])))
+
+	if ret != 0 {
+		return ErrDecrypt
+	}
+	return nil
+}
+
+// decapBatchLen returns the number of ciphertexts of a batch
+func (s *kyberSet) decapBatchLen(cts, sss []byte) (int, error) {
+	n := len(cts) / s.ctLen
+	if n == 0 || len(cts) != n*s.ctLen {
+		return 0, errors.New("invalid ciphertext slab size")
+	}
+	if len(sss) != n*C.KYBER_SYMBYTES {
+		return 0, errors.New("invalid shared secret slab size")
+	}
+	return n, nil
+}
+
+func (s *kyberSet) preparePublicKey(rng RNGBackend, pk []byte) (*PreparedPublicKey, error) {
+	if len(pk) != s.pkLen {
+		return nil, errors.New("invalid public key size")
+	}
+	p := C.kyber_set_prepare_pk_cgo(C.int(s.k), (*C.char)(unsafe.Pointer(&pk[0])))
+	if p == nil {
+		return nil, errors.New("out of memory")
+	}
+	ppk := &PreparedPublicKey{p: p, set: s, rng: rng}
+	runtime.SetFinalizer(ppk, func(ppk *PreparedPublicKey) {
+		C.kyber_set_prepared_pk_free_cgo(C.int(ppk.set.k), ppk.p)
+	})
+	return ppk, nil
+}
+
+func (s *kyberSet) prepareSecretKey(sk []byte) (*PreparedSecretKey, error) {
+	if len(sk) != s.skLen {
+		return nil, errors.New("invalid secret key size")
+	}
+	p := C.kyber_set_prepare_sk_cgo(C.int(s.k), (*C.char)(unsafe.Pointer(&sk[0])))
+	if p == nil {
+		return nil, errors.New("out of memory")
+	}
+	psk := &PreparedSecretKey{p: p, set: s}
+	runtime.SetFinalizer(psk, func(psk *PreparedSecretKey) {
+		C.kyber_set_prepared_sk_free_cgo(C.int(psk.set.k), psk.p)
+	})
+	return psk, nil
+}
+
 // KeyGenRandom ...
-func (r Round5) KeyGenRandom() (pk, sk []byte, err error) {
-	ent := make([]byte, Round5EntropyLen)
-	_, err = rand.Read(ent)
+func (k Kyber) KeyGenRandom() (pk, sk []byte, err error) {
+	return kyber768Set.keyGenRandom(k.RNG)
+}
+
+// KeyGen ...
+func (k Kyber) KeyGen(ent []byte) (pk, sk []byte, err error) {
+	return kyber768Set.keyGen(k.RNG, ent)
+}
+
+// KeyGenBulk fills the slabs pks and sks with keypairs as
+// Dilithium.KeyGenBulk does; the entropy of each key is expanded with k.RNG
+func (k Kyber) KeyGenBulk(seed []byte, first uint64, pks, sks []byte) error {
+	return kyber768Set.keyGenBulk(k.RNG, seed, first, pks, sks)
+}
+
+// Encap ...
+func (k Kyber) Encap(ent []byte, pk []byte) (ct, ss []byte, err error) {
+	return kyber768Set.encap(k.RNG, ent, pk)
+}
+
+// EncapRandom ...
+func (k Kyber) EncapRandom(pk []byte) (ct, ss []byte, err error) {
+	return kyber768Set.encapRandom(k.RNG, pk)
+}
+
+// Decap ...
+func (Kyber) Decap(ct, sk []byte) (ss []byte, err error) {
+	return kyber768Set.decap(ct, sk)
+}
+
+// EncapBatch encapsulates to each public key of the slab pks with the
+// matching entropy of the slab ents in one call, writing the ciphertexts
+// and shared secrets to the slabs cts and sss. Entry i gives the same
+// output as k.Encap on entropy i and key i; keys repeated in the batch are
+// prepared once, and the hashing of four entries runs in parallel.
+func (k Kyber) EncapBatch(ents, pks, cts, sss []byte) error {
+	return kyber768Set.encapBatch(k.RNG, ents, pks, cts, sss)
+}
+
+// EncapBatchRandom ...
+func (k Kyber) EncapBatchRandom(pks, cts, sss []byte) error {
+	return kyber768Set.encapBatchRandom(k.RNG, pks, cts, sss)
+}
+
+// DecapBatch decapsulates each ciphertext of the slab cts with sk in one
+// call, writing the shared secrets to the slab sss; the secret key is
+// unpacked and prepared once for the whole batch
+func (Kyber) DecapBatch(cts, sk, sss []byte) error {
+	return kyber768Set.decapBatch(cts, sk, sss)
+}
+
+// PreparePublicKey prepares pk for repeated encapsulation; Encap on the
+// result uses the RNG of k and gives the same output as k.Encap
+func (k Kyber) PreparePublicKey(pk []byte) (*PreparedPublicKey, error) {
+	return kyber768Set.preparePublicKey(k.RNG, pk)
+}
+
+// PrepareSecretKey prepares sk for repeated decapsulation; Decap on the
+// result gives the same output as k.Decap
+func (Kyber) PrepareSecretKey(sk []byte) (*PreparedSecretKey, error) {
+	return kyber768Set.prepareSecretKey(sk)
+}
+
+// KeyGenRandom ...
+func (k Kyber512) KeyGenRandom() (pk, sk []byte, err error) {
+	return kyber512Set.keyGenRandom(k.RNG)
+}
+
+// KeyGen ...
+func (k Kyber512) KeyGen(ent []byte) (pk, sk []byte, err error) {
+	return kyber512Set.keyGen(k.RNG, ent)
+}
+
+// KeyGenBulk ...
+func (k Kyber512) KeyGenBulk(seed []byte, first uint64, pks, sks []byte) error {
+	return kyber512Set.keyGenBulk(k.RNG, seed, first, pks, sks)
+}
 
+// Encap ...
+func (k Kyber512) Encap(ent []byte, pk []byte) (ct, ss []byte, err error) {
+	return kyber512Set.encap(k.RNG, ent, pk)
+}
+
+// EncapRandom ...
+func (k Kyber512) EncapRandom(pk []byte) (ct, ss []byte, err error) {
+	return kyber512Set.encapRandom(k.RNG, pk)
+}
+
+// Decap ...
+func (Kyber512) Decap(ct, sk []byte) (ss []byte, err error) {
+	return kyber512Set.decap(ct, sk)
+}
+
+// EncapBatch ...
+func (k Kyber512) EncapBatch(ents, pks, cts, sss []byte) error {
+	return kyber512Set.encapBatch(k.RNG, ents, pks, cts, sss)
+}
+
+// EncapBatchRandom ...
+func (k Kyber512) EncapBatchRandom(pks, cts, sss []byte) error {
+	return kyber512Set.encapBatchRandom(k.RNG, pks, cts, sss)
+}
+
+// DecapBatch ...
+func (Kyber512) DecapBatch(cts, sk, sss []byte) error {
+	return kyber512Set.decapBatch(cts, sk, sss)
+}
+
+// PreparePublicKey ...
+func (k Kyber512) PreparePublicKey(pk []byte) (*PreparedPublicKey, error) {
+	return kyber512Set.preparePublicKey(k.RNG, pk)
+}
+
+// PrepareSecretKey ...
+func (Kyber512) PrepareSecretKey(sk []byte) (*PreparedSecretKey, error) {
+	return kyber512Set.prepareSecretKey(sk)
+}
+
+// KeyGenRandom ...
+func (k Kyber1024) KeyGenRandom() (pk, sk []byte, err error) {
+	return kyber1024Set.keyGenRandom(k.RNG)
+}
+
+// KeyGen ...
+func (k Kyber1024) KeyGen(ent []byte) (pk, sk []byte, err error) {
+	return kyber1024Set.keyGen(k.RNG, ent)
+}
+
+// KeyGenBulk ...
+func (k Kyber1024) KeyGenBulk(seed []byte, first uint64, pks, sks []byte) error {
+	return kyber1024Set.keyGenBulk(k.RNG, seed, first, pks, sks)
+}
+
+// Encap ...
+func (k Kyber1024) Encap(ent []byte, pk []byte) (ct, ss []byte, err error) {
+	return kyber1024Set.encap(k.RNG, ent, pk)
+}
+
+// EncapRandom ...
+func (k Kyber1024) EncapRandom(pk []byte) (ct, ss []byte, err error) {
+	return kyber1024Set.encapRandom(k.RNG, pk)
+}
+
+// Decap ...
+func (Kyber1024) Decap(ct, sk []byte) (ss []byte, err error) {
+	return kyber1024Set.decap(ct, sk)
+}
+
+// EncapBatch ...
+func (k Kyber1024) EncapBatch(ents, pks, cts, sss []byte) error {
+	return kyber1024Set.encapBatch(k.RNG, ents, pks, cts, sss)
+}
+
+// EncapBatchRandom ...
+func (k Kyber1024) EncapBatchRandom(pks, cts, sss []byte) error {
+	return kyber1024Set.encapBatchRandom(k.RNG, pks, cts, sss)
+}
+
+// DecapBatch ...
+func (Kyber1024) DecapBatch(cts, sk, sss []byte) error {
+	return kyber1024Set.decapBatch(cts, sk, sss)
+}
+
+// PreparePublicKey ...
+func (k Kyber1024) PreparePublicKey(pk []byte) (*PreparedPublicKey, error) {
+	return kyber1024Set.preparePublicKey(k.RNG, pk)
+}
+
+// PrepareSecretKey ...
+func (Kyber1024) PrepareSecretKey(sk []byte) (*PreparedSecretKey, error) {
+	return kyber1024Set.prepareSecretKey(sk)
+}
+
+// PreparedPublicKey is a Kyber public key with the work of Encap that only
+// depends on the key done once: the NTT of the public vector, the matrix
+// A^T and the hash H(pk). It lives in C memory until it is garbage
+// collected, and is safe for concurrent use.
+type PreparedPublicKey struct {
+	p   unsafe.Pointer
+	set *kyberSet
+	rng RNGBackend
+}
+
+// Encap ...
+func (ppk *PreparedPublicKey) Encap(ent []byte) (ct, ss []byte, err error) {
+	if len(ent) != KyberEntropyLen {
+		return nil, nil, errors.New("invalid entropy size")
+	}
+	ct = make([]byte, ppk.set.ctLen)
+	ss = make([]byte, C.KYBER_SYMBYTES)
+
+	ctp := (*C.char)(unsafe.Pointer(&ct[0]))
+	ssp := (*C.char)(unsafe.Pointer(&ss[0]))
+	entp := (*C.char)(unsafe.Pointer(&ent[0]))
+
+	ret := C.kyber_set_enc_prepared_cgo(C.int(ppk.set.k), ctp, ssp, ppk.p, entp, C.int(ppk.rng))
+	runtime.KeepAlive(ppk)
+
+	if ret != 0 {
+		return nil, nil, ErrEncrypt
+	}
+	return ct, ss, nil
+}
+
+// EncapRandom ...
+func (ppk *PreparedPublicKey) EncapRandom() (ct, ss []byte, err error) {
+	ent := entropy(KyberEntropyLen)
+	defer wipe(ent)
+
+	return ppk.Encap(ent)
+}
+
+// PreparedSecretKey is a Kyber secret key with the work of Decap that only
+// depends on the key done once: the NTT of the secret vector, and for the
+// re-encryption check that of the public key it embeds. It lives in C
+// memory, which is cleared when it is garbage collected, and is safe for
+// concurrent use.
+type PreparedSecretKey struct {
+	p   unsafe.Pointer
+	set *kyberSet
+}
+
+// Decap ...
+func (psk *PreparedSecretKey) Decap(ct []byte) (ss []byte, err error) {
+	if len(ct) != psk.set.ctLen {
+		return nil, errors.New("invalid ciphertext size")
+	}
+	ss = make([]byte, C.KYBER_SYMBYTES)
+
+	ctp := (*C.char)(unsafe.Pointer(&ct[0]))
+	ssp := (*C.char)(unsafe.Pointer(&ss[0]))
+
+	ret := C.kyber_set_dec_prepared_cgo(C.int(psk.set.k), ssp, ctp, psk.p)
+	runtime.KeepAlive(psk)
+
+	if ret != 0 {
+		return nil, ErrDecrypt
+	}
+	return ss, nil
+}
+
+// DecapBatch decapsulates the ciphertexts of the slab cts as
+// Kyber.DecapBatch does
+func (psk *PreparedSecretKey) DecapBatch(cts, sss []byte) error {
+	n, err := psk.set.decapBatchLen(cts, sss)
 	if err != nil {
-		panic("random read failed")
+		return err
+	}
+
+	ret := C.kyber_set_dec_batch_prepared_cgo(C.int(psk.set.k), (*C.char)(unsafe.Pointer(&sss[0])),
+		(*C.char)(unsafe.Pointer(&cts[0])), C.size_t(n), psk.p)
+	runtime.KeepAlive(psk)
+
+	if ret != 0 {
+		return ErrDecrypt
+	}
+	return nil
+}
+
+// KyberKexKeyLen is the byte length of the key agreed by the Kyber
+// handshakes
+const KyberKexKeyLen = C.KYBER_SYMBYTES
+
+// kex is what the Kyber handshake objects share. They run the key
+// exchanges of c/kyber/kex.c with a single C call per step, writing to
+// buffers of the caller, and each step that needs randomness expands its
+// own entropy with the RNG of the set.
+type kex struct {
+	set *kyberSet
+	rng RNGBackend
+}
+
+// MsgALen is the byte length of the message of the initiator A
+func (x kex) MsgALen() int {
+	return x.set.pkLen + x.set.ctLen
+}
+
+// start runs the first step of A, which is the same in both handshakes:
+// an ephemeral keypair and an encapsulation to pkb. state gets tk and the
+// ephemeral secret key.
+func (x kex) start(state, ent, pkb, msgA []byte) error {
+	if len(ent) != KyberEntropyLen {
+		return errors.New("invalid entropy size")
+	}
+	if len(pkb) != x.set.pkLen {
+		return errors.New("invalid public key size")
+	}
+	if len(msgA) != x.MsgALen() {
+		return errors.New("invalid message size")
+	}
+
+	ret := C.kyber_set_kex_initA_cgo(C.int(x.set.k), (*C.char)(unsafe.Pointer(&msgA[0])),
+		(*C.char)(unsafe.Pointer(&state[0])), (*C.char)(unsafe.Pointer(&pkb[0])),
+		(*C.char)(unsafe.Pointer(&ent[0])), C.int(x.rng))
+
+	if ret != 0 {
+		return ErrEncrypt
+	}
+	return nil
+}
+
+// UAKEInitiator is side A of the unilaterally authenticated key exchange,
+// in which A authenticates B by its static key: Start gives the message
+// to B, whose UAKEResponder answers, and Finish derives the key from the
+// answer. It can run one handshake at a time.
+type UAKEInitiator struct {
+	kex
+	state   []byte // tk || ephemeral secret key, from Start to Finish
+	started bool
+}
+
+// UAKEResponder is side B of the unilaterally authenticated key exchange,
+// holding its static secret key. It is safe for concurrent use.
+type UAKEResponder struct {
+	kex
+	skb []byte
+}
+
+// AKEInitiator is side A of the mutually authenticated key exchange, in
+// which each side also proves ownership of its static key: Start gives
+// the message to B, whose AKEResponder answers, and Finish derives the key
+// from the answer. It can run one handshake at a time.
+type AKEInitiator struct {
+	kex
+	ska     []byte
+	state   []byte // tk || ephemeral secret key, from Start to Finish
+	started bool
+}
+
+// AKEResponder is side B of the mutually authenticated key exchange,
+// holding its static secret key. It is safe for concurrent use.
+type AKEResponder struct {
+	kex
+	skb []byte
+}
+
+func (s *kyberSet) newUAKEInitiator(rng RNGBackend) *UAKEInitiator {
+	return &UAKEInitiator{kex: kex{s, rng}, state: make([]byte, C.KYBER_SYMBYTES+s.skLen)}
+}
+
+func (s *kyberSet) newUAKEResponder(rng RNGBackend, skb []byte) (*UAKEResponder, error) {
+	if len(skb) != s.skLen {
+		return nil, errors.New("invalid secret key size")
+	}
+	return &UAKEResponder{kex: kex{s, rng}, skb: append([]byte(nil), skb...)}, nil
+}
+
+func (s *kyberSet) newAKEInitiator(rng RNGBackend, ska []byte) (*AKEInitiator, error) {
+	if len(ska) != s.skLen {
+		return nil, errors.New("invalid secret key size")
+	}
+	return &AKEInitiator{kex: kex{s, rng}, ska: append([]byte(nil), ska...),
+		state: make([]byte, C.KYBER_SYMBYTES+s.skLen)}, nil
+}
+
+func (s *kyberSet) newAKEResponder(rng RNGBackend, skb []byte) (*AKEResponder, error) {
+	if len(skb) != s.skLen {
+		return nil, errors.New("invalid secret key size")
+	}
+	return &AKEResponder{kex: kex{s, rng}, skb: append([]byte(nil), skb...)}, nil
+}
+
+// MsgBLen is the byte length of the answer of B
+func (a *UAKEInitiator) MsgBLen() int {
+	return a.set.ctLen
+}
+
+// Start writes to msgA the message opening a handshake with the owner of
+// the static public key pkb
+func (a *UAKEInitiator) Start(ent, pkb, msgA []byte) error {
+	if err := a.start(a.state, ent, pkb, msgA); err != nil {
+		return err
+	}
+	a.started = true
+	return nil
+}
+
+// Finish writes to key the key agreed with B from its answer msgB, and
+// clears the state of the handshake
+func (a *UAKEInitiator) Finish(msgB, key []byte) error {
+	if !a.started {
+		return errors.New("handshake not started")
+	}
+	if len(msgB) != a.MsgBLen() {
+		return errors.New("invalid message size")
+	}
+	if len(key) != KyberKexKeyLen {
+		return errors.New("invalid key size")
 	}
 
+	ret := C.kyber_set_uake_sharedA_cgo(C.int(a.set.k), (*C.char)(unsafe.Pointer(&key[0])),
+		(*C.char)(unsafe.Pointer(&msgB[0])), (*C.char)(unsafe.Pointer(&a.state[0])))
+
+	wipe(a.state)
+	a.started = false
+	if ret != 0 {
+		return ErrDecrypt
+	}
+	return nil
+}
+
+// MsgBLen is the byte length of the answer of B
+func (b *UAKEResponder) MsgBLen() int {
+	return b.set.ctLen
+}
+
+// Respond writes to msgB the answer to the message msgA of A, and to key
+// the key agreed with A
+func (b *UAKEResponder) Respond(ent, msgA, msgB, key []byte) error {
+	if len(ent) != KyberEntropyLen {
+		return errors.New("invalid entropy size")
+	}
+	if len(msgA) != b.MsgALen() || len(msgB) != b.MsgBLen() {
+		return errors.New("invalid message size")
+	}
+	if len(key) != KyberKexKeyLen {
+		return errors.New("invalid key size")
+	}
+
+	ret := C.kyber_set_uake_sharedB_cgo(C.int(b.set.k), (*C.char)(unsafe.Pointer(&msgB[0])),
+		(*C.char)(unsafe.Pointer(&key[0])), (*C.char)(unsafe.Pointer(&msgA[0])),
+		(*C.char)(unsafe.Pointer(&b.skb[0])), (*C.char)(unsafe.Pointer(&ent[0])), C.int(b.rng))
+
+	if ret != 0 {
+		return ErrEncrypt
+	}
+	return nil
+}
+
+// MsgBLen is the byte length of the answer of B
+func (a *AKEInitiator) MsgBLen() int {
+	return 2 * a.set.ctLen
+}
+
+// Start writes to msgA the message opening a handshake with the owner of
+// the static public key pkb
+func (a *AKEInitiator) Start(ent, pkb, msgA []byte) error {
+	if err := a.start(a.state, ent, pkb, msgA); err != nil {
+		return err
+	}
+	a.started = true
+	return nil
+}
+
+// Finish writes to key the key agreed with B from its answer msgB, and
+// clears the state of the handshake
+func (a *AKEInitiator) Finish(msgB, key []byte) error {
+	if !a.started {
+		return errors.New("handshake not started")
+	}
+	if len(msgB) != a.MsgBLen() {
+		return errors.New("invalid message size")
+	}
+	if len(key) != KyberKexKeyLen {
+		return errors.New("invalid key size")
+	}
+
+	ret := C.kyber_set_ake_sharedA_cgo(C.int(a.set.k), (*C.char)(unsafe.Pointer(&key[0])),
+		(*C.char)(unsafe.Pointer(&msgB[0])), (*C.char)(unsafe.Pointer(&a.state[0])),
+		(*C.char)(unsafe.Pointer(&a.ska[0])))
+
+	wipe(a.state)
+	a.started = false
+	if ret != 0 {
+		return ErrDecrypt
+	}
+	return nil
+}
+
+// MsgBLen is the byte length of the answer of B
+func (b *AKEResponder) MsgBLen() int {
+	return 2 * b.set.ctLen
+}
+
+// Respond writes to msgB the answer to the message msgA of the owner of
+// the static public key pka, and to key the key agreed with it
+func (b *AKEResponder) Respond(ent, msgA, pka, msgB, key []byte) error {
+	if len(ent) != KyberEntropyLen {
+		return errors.New("invalid entropy size")
+	}
+	if len(pka) != b.set.pkLen {
+		return errors.New("invalid public key size")
+	}
+	if len(msgA) != b.MsgALen() || len(msgB) != b.MsgBLen() {
+		return errors.New("invalid message size")
+	}
+	if len(key) != KyberKexKeyLen {
+		return errors.New("invalid key size")
+	}
+
+	ret := C.kyber_set_ake_sharedB_cgo(C.int(b.set.k), (*C.char)(unsafe.Pointer(&msgB[0])),
+		(*C.char)(unsafe.Pointer(&key[0])), (*C.char)(unsafe.Pointer(&msgA[0])),
+		(*C.char)(unsafe.Pointer(&b.skb[0])), (*C.char)(unsafe.Pointer(&pka[0])),
+		(*C.char)(unsafe.Pointer(&ent[0])), C.int(b.rng))
+
+	if ret != 0 {
+		return ErrEncrypt
+	}
+	return nil
+}
+
+// NewUAKEInitiator returns side A of a unilaterally authenticated key
+// exchange, which draws its ephemeral keys with k.RNG
+func (k Kyber) NewUAKEInitiator() *UAKEInitiator {
+	return kyber768Set.newUAKEInitiator(k.RNG)
+}
+
+// NewUAKEResponder returns side B of a unilaterally authenticated key
+// exchange with static secret key skb
+func (k Kyber) NewUAKEResponder(skb []byte) (*UAKEResponder, error) {
+	return kyber768Set.newUAKEResponder(k.RNG, skb)
+}
+
+// NewAKEInitiator returns side A of a mutually authenticated key exchange
+// with static secret key ska
+func (k Kyber) NewAKEInitiator(ska []byte) (*AKEInitiator, error) {
+	return kyber768Set.newAKEInitiator(k.RNG, ska)
+}
+
+// NewAKEResponder returns side B of a mutually authenticated key exchange
+// with static secret key skb
+func (k Kyber) NewAKEResponder(skb []byte) (*AKEResponder, error) {
+	return kyber768Set.newAKEResponder(k.RNG, skb)
+}
+
+// NewUAKEInitiator ...
+func (k Kyber512) NewUAKEInitiator() *UAKEInitiator {
+	return kyber512Set.newUAKEInitiator(k.RNG)
+}
+
+// NewUAKEResponder ...
+func (k Kyber512) NewUAKEResponder(skb []byte) (*UAKEResponder, error) {
+	return kyber512Set.newUAKEResponder(k.RNG, skb)
+}
+
+// NewAKEInitiator ...
+func (k Kyber512) NewAKEInitiator(ska []byte) (*AKEInitiator, error) {
+	return kyber512Set.newAKEInitiator(k.RNG, ska)
+}
+
+// NewAKEResponder ...
+func (k Kyber512) NewAKEResponder(skb []byte) (*AKEResponder, error) {
+	return kyber512Set.newAKEResponder(k.RNG, skb)
+}
+
+// NewUAKEInitiator ...
+func (k Kyber1024) NewUAKEInitiator() *UAKEInitiator {
+	return kyber1024Set.newUAKEInitiator(k.RNG)
+}
+
+// NewUAKEResponder ...
+func (k Kyber1024) NewUAKEResponder(skb []byte) (*UAKEResponder, error) {
+	return kyber1024Set.newUAKEResponder(k.RNG, skb)
+}
+
+// NewAKEInitiator ...
+func (k Kyber1024) NewAKEInitiator(ska []byte) (*AKEInitiator, error) {
+	return kyber1024Set.newAKEInitiator(k.RNG, ska)
+}
+
+// NewAKEResponder ...
+func (k Kyber1024) NewAKEResponder(skb []byte) (*AKEResponder, error) {
+	return kyber1024Set.newAKEResponder(k.RNG, skb)
+}
+
+// KeyGenRandom ...
+func (r Round5) KeyGenRandom() (pk, sk []byte, err error) {
+	ent := entropy(Round5EntropyLen)
+	defer wipe(ent)
+
 	return r.KeyGen(ent)
 }
 
 // KeyGen ...
-func (Round5) KeyGen(ent []byte) (pk, sk []byte, err error) {
+func (r Round5) KeyGen(ent []byte) (pk, sk []byte, err error) {
 	if len(ent) != Round5EntropyLen {
 		return nil, nil, errors.New("invalid entropy size")
 	}
@@ -294,7 +1393,7 @@ func (Round5) KeyGen(ent []byte) (pk, sk []byte, err error) {
 	skp := (*C.char)(unsafe.Pointer(&sk[0]))
 	entp := (*C.char)(unsafe.Pointer(&ent[0]))
 
-	ret := C.round5_kem_keypair_cgo(pkp, skp, entp)
+	ret := C.round5_kem_keypair_cgo(pkp, skp, entp, C.int(r.RNG))
 
 	if ret != 0 {
 		return nil, nil, ErrKeypair
@@ -306,8 +1405,15 @@ func (Round5) KeyGen(ent []byte) (pk, sk []byte, err error) {
 	return pk, sk, nil
 }
 
+// KeyGenBulk fills the slabs pks and sks with keypairs as
+// Dilithium.KeyGenBulk does; the entropy of each key is expanded with r.RNG
+func (r Round5) KeyGenBulk(seed []byte, first uint64, pks, sks []byte) error {
+	return keyGenBulk(bulkRound5, r.RNG, seed, first, pks, sks,
+		C.ROUND5_PUBLICKEYBYTES, C.ROUND5_SECRETKEYBYTES)
+}
+
 // Encap ...
-func (Round5) Encap(ent []byte, pk []byte) (ct, ss []byte, err error) {
+func (r Round5) Encap(ent []byte, pk []byte) (ct, ss []byte, err error) {
 
 	if len(pk) != C.ROUND5_PUBLICKEYBYTES {
 		return nil, nil, errors.New("invalid public key size")
@@ -320,7 +1426,11 @@ func (Round5) Encap(ent []byte, pk []byte) (ct, ss []byte, err error) {
 	ssp := (*C.char)(unsafe.Pointer(&ss[0]))
 	entp := (*C.char)(unsafe.Pointer(&ent[0]))
 
-	C.round5_kem_enc_cgo(ctp, ssp, pkp, entp)
+	ret := C.round5_kem_enc_cgo(ctp, ssp, pkp, entp, C.int(r.RNG))
+
+	if ret != 0 {
+		return nil, nil, ErrEncrypt
+	}
 
 	ct = []byte(C.GoStringN(ctp, C.ROUND5_CIPHERTEXTBYTES))
 	ss = []byte(C.GoStringN(ssp, C.PARAMS_SS_SIZE))
@@ -330,13 +1440,8 @@ func (Round5) Encap(ent []byte, pk []byte) (ct, ss []byte, err error) {
 
 // EncapRandom ...
 func (r Round5) EncapRandom(pk []byte) (ct, ss []byte, err error) {
-	ent := make([]byte, Round5EntropyLen)
-
-	_, err = rand.Read(ent)
-
-	if err != nil {
-		panic("random read failed")
-	}
+	ent := entropy(Round5EntropyLen)
+	defer wipe(ent)
 
 	return r.Encap(ent, pk)
 }
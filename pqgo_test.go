@@ -2,10 +2,14 @@ package pqgo
 
 import (
 	"bytes"
+	"crypto/rand"
 	"encoding/hex"
 	"flag"
 	"io/ioutil"
+	"sync"
+	"sync/atomic"
 	"testing"
+	"time"
 )
 
 // to show logs:
@@ -50,6 +54,16 @@ func BenchmarkKyberKeyGen(b *testing.B) {
 	k := Kyber{}
 	benchKeyGen(k.KeyGenRandom, b)
 }
+
+func BenchmarkKyber512KeyGen(b *testing.B) {
+	k := Kyber512{}
+	benchKeyGen(k.KeyGenRandom, b)
+}
+
+func BenchmarkKyber1024KeyGen(b *testing.B) {
+	k := Kyber1024{}
+	benchKeyGen(k.KeyGenRandom, b)
+}
 func BenchmarkRound5KeyGen(b *testing.B) {
 	r := Round5{}
 	benchKeyGen(r.KeyGenRandom, b)
@@ -118,6 +132,105 @@ func BenchmarkDilithiumOpen(b *testing.B) {
 	benchOpen(d, b)
 }
 
+func benchEncap(encap func() ([]byte, []byte, error), b *testing.B) {
+	var ct []byte
+	var err error
+	for n := 0; n < b.N; n++ {
+		ct, _, err = encap()
+		if err != nil {
+			b.Fatalf(err.Error())
+		}
+	}
+
+	mg = ct
+}
+
+func BenchmarkKyberEncap(b *testing.B) {
+	k := Kyber{}
+	pk, _, _ := k.KeyGenRandom()
+	benchEncap(func() ([]byte, []byte, error) { return k.EncapRandom(pk) }, b)
+}
+
+func BenchmarkKyberEncapPrepared(b *testing.B) {
+	k := Kyber{}
+	pk, _, _ := k.KeyGenRandom()
+	ppk, _ := k.PreparePublicKey(pk)
+	benchEncap(ppk.EncapRandom, b)
+}
+
+// benchmarks 16 encapsulations to distinct keys per iteration
+func BenchmarkKyberEncapBatch(b *testing.B) {
+	const n = 16
+	k := Kyber{}
+	var pks, cts, sss []byte
+	for i := 0; i < n; i++ {
+		pk, _, _ := k.KeyGenRandom()
+		ct, ss, _ := k.EncapRandom(pk)
+		pks = append(pks, pk...)
+		cts = append(cts, ct...)
+		sss = append(sss, ss...)
+	}
+	ents := make([]byte, n*KyberEntropyLen)
+	rand.Read(ents)
+
+	for i := 0; i < b.N; i++ {
+		if err := k.EncapBatch(ents, pks, cts, sss); err != nil {
+			b.Fatalf(err.Error())
+		}
+	}
+
+	mg = cts
+}
+
+func benchDecap(decap func() ([]byte, error), b *testing.B) {
+	var ss []byte
+	var err error
+	for n := 0; n < b.N; n++ {
+		ss, err = decap()
+		if err != nil {
+			b.Fatalf(err.Error())
+		}
+	}
+
+	mg = ss
+}
+
+func BenchmarkKyberDecap(b *testing.B) {
+	k := Kyber{}
+	pk, sk, _ := k.KeyGenRandom()
+	ct, _, _ := k.EncapRandom(pk)
+	benchDecap(func() ([]byte, error) { return k.Decap(ct, sk) }, b)
+}
+
+func BenchmarkKyberDecapPrepared(b *testing.B) {
+	k := Kyber{}
+	pk, sk, _ := k.KeyGenRandom()
+	ct, _, _ := k.EncapRandom(pk)
+	psk, _ := k.PrepareSecretKey(sk)
+	benchDecap(func() ([]byte, error) { return psk.Decap(ct) }, b)
+}
+
+// benchmarks 16 decapsulations per iteration
+func BenchmarkKyberDecapBatch(b *testing.B) {
+	const n = 16
+	k := Kyber{}
+	pk, sk, _ := k.KeyGenRandom()
+	var cts []byte
+	for i := 0; i < n; i++ {
+		ct, _, _ := k.EncapRandom(pk)
+		cts = append(cts, ct...)
+	}
+	sss := make([]byte, n*32)
+
+	for i := 0; i < b.N; i++ {
+		if err := k.DecapBatch(cts, sk, sss); err != nil {
+			b.Fatalf(err.Error())
+		}
+	}
+
+	mg = sss
+}
+
 // assumes deterministic signatures
 func testSignatureGolden(s Signature, entropyLen int, name string, t *testing.T) {
 	ent := make([]byte, entropyLen)
@@ -262,6 +375,14 @@ func TestKyberGolden(t *testing.T) {
 	k := Kyber{}
 	testKEMGolden(k, KyberEntropyLen, "kyber", t)
 }
+func TestKyber512Golden(t *testing.T) {
+	k := Kyber512{}
+	testKEMGolden(k, KyberEntropyLen, "kyber512", t)
+}
+func TestKyber1024Golden(t *testing.T) {
+	k := Kyber1024{}
+	testKEMGolden(k, KyberEntropyLen, "kyber1024", t)
+}
 func TestRound5Golden(t *testing.T) {
 	r := Round5{}
 	testKEMGolden(r, Round5EntropyLen, "round5", t)
@@ -313,3 +434,916 @@ func TestKyber(t *testing.T) {
 	k := Kyber{}
 	testKEM(k, t)
 }
+
+func TestRNGBackends(t *testing.T) {
+	// seed of count = 0 in the NIST KAT files, drawn from the CTR_DRBG
+	// initialized with entropy 00 01 .. 2f
+	ent := make([]byte, 48)
+	for i := range ent {
+		ent[i] = byte(i)
+	}
+	kat := "061550234d158c5ec95595fe04ef7a25767f2e24cc2bc479d09d86dc9abcfde7056a8c266f9ef97ed08541dbd2e1ffa1"
+	if hex.EncodeToString(rngBytes(RNGCTRDRBG, ent, 48)) != kat {
+		t.Fatal("CTR_DRBG output doesnt match KAT seed")
+	}
+
+	testKEM(Kyber{RNG: RNGCTRDRBG}, t)
+	testKEM(Round5{RNG: RNGCTRDRBG}, t)
+
+	pk0, _, _ := Kyber{}.KeyGen(ent)
+	pk1, _, _ := Kyber{RNG: RNGCTRDRBG}.KeyGen(ent)
+	if bytes.Equal(pk0, pk1) {
+		t.Fatal("RNG backend ignored")
+	}
+	if _, _, err := (Kyber{RNG: 2}).KeyGen(ent); err == nil {
+		t.Fatal("invalid RNG backend accepted")
+	}
+}
+
+func TestBackends(t *testing.T) {
+	best := Backend()
+	defer selectBackend(best)
+
+	t.Log("selected backend: " + best)
+
+	for _, name := range []string{"ref", "opt", "avx2", "avx512"} {
+		if !selectBackend(name) {
+			t.Log(name + " not supported, skipped")
+			continue
+		}
+		if Backend() != name {
+			t.Fatalf("backend is %s, expected %s", Backend(), name)
+		}
+		TestDilithiumGolden(t)
+		TestKyberGolden(t)
+		TestRound5Golden(t)
+		TestDilithium(t)
+		TestRound5(t)
+		TestRNGBackends(t)
+	}
+}
+
+func TestHashIncremental(t *testing.T) {
+	// three SHAKE128 blocks and a bit, so cuts land on and around the
+	// rates of all four functions (168, 136, 136 and 72)
+	in := make([]byte, 3*168+7)
+	rand.Read(in)
+
+	for _, h := range []struct {
+		name   string
+		outlen int
+	}{{"shake128", 337}, {"shake256", 273}, {"sha3-256", 32}, {"sha3-512", 64}} {
+		ref := make([]byte, h.outlen)
+		out := make([]byte, h.outlen)
+		hashOneShot(h.name, ref, in)
+
+		// one cut at every offset
+		for cut := 0; cut <= len(in); cut++ {
+			hashIncremental(h.name, out, in, []int{cut})
+			if !bytes.Equal(out, ref) {
+				t.Fatalf("%s: absorbed in two at %d doesnt match one-shot", h.name, cut)
+			}
+		}
+
+		// pieces of a fixed size, empty pieces included
+		for _, step := range []int{1, 7, 71, 72, 73, 135, 136, 137, 167, 168, 169} {
+			var cuts []int
+			for cut := 0; cut < len(in); cut += step {
+				cuts = append(cuts, cut, cut)
+			}
+			hashIncremental(h.name, out, in, cuts)
+			if !bytes.Equal(out, ref) {
+				t.Fatalf("%s: absorbed in pieces of %d doesnt match one-shot", h.name, step)
+			}
+		}
+	}
+}
+
+// parallelHash256Ref is ParallelHash256 as written in SP 800-185, one leaf
+// after the other, for comparison with the threaded code
+func parallelHash256Ref(outlen int, in []byte, blocklen int, cstm []byte) []byte {
+	encode := func(x uint64, right bool) []byte {
+		n := 1
+		for n < 8 && x>>(8*uint(n)) != 0 {
+			n++
+		}
+		b := make([]byte, n)
+		for i := range b {
+			b[i] = byte(x >> (8 * uint(n-1-i)))
+		}
+		if right {
+			return append(b, byte(n))
+		}
+		return append([]byte{byte(n)}, b...)
+	}
+
+	root := encode(uint64(blocklen), false)
+	leaves := 0
+	for i := 0; i < len(in); i += blocklen {
+		end := i + blocklen
+		if end > len(in) {
+			end = len(in)
+		}
+		z := make([]byte, 64)
+		shake(256, z, in[i:end])
+		root = append(root, z...)
+		leaves++
+	}
+	root = append(root, encode(uint64(leaves), true)...)
+	root = append(root, encode(uint64(8*outlen), true)...)
+
+	out := make([]byte, outlen)
+	cshake256(out, root, []byte("ParallelHash"), cstm)
+	return out
+}
+
+func TestParallelHash256(t *testing.T) {
+	defer SetHashThreads(0)
+
+	// samples #4 and #5 of the NIST SP 800-185 examples
+	x := make([]byte, 24)
+	for i := range x {
+		x[i] = byte(i/8<<4 | i%8)
+	}
+	for _, v := range []struct {
+		cstm string
+		out  string
+	}{
+		{"", "bc1ef124da34495e948ead207dd9842235da432d2bbc54b4c110e64c451105531b7f2a3e0ce055c02805e7c2de1fb746af97a1dd01f43b824e31b87612410429"},
+		{"Parallel Data", "cdf15289b54f6212b4bc270528b49526006dd9b54e2b6add1ef6900dda3963bb33a72491f236969ca8afaea29c682d47a393c065b38e29fae651a2091c833110"},
+	} {
+		out := make([]byte, 64)
+		parallelHash256(out, x, 8, []byte(v.cstm))
+		if hex.EncodeToString(out) != v.out {
+			t.Fatalf("ParallelHash256 sample with S=%q doesnt match", v.cstm)
+		}
+		if !bytes.Equal(out, parallelHash256Ref(64, x, 8, []byte(v.cstm))) {
+			t.Fatalf("ParallelHash256 reference with S=%q doesnt match", v.cstm)
+		}
+	}
+
+	// several windows of leaves, a partial group of four and a short last
+	// leaf; the pool only grows, so each thread count is checked against
+	// the one-leaf-at-a-time reference
+	m := make([]byte, 2500*8+5)
+	rand.Read(m)
+	for _, blocklen := range []int{8, 1000} {
+		ref := parallelHash256Ref(48, m, blocklen, []byte("PQGo"))
+		for _, threads := range []int{1, 4, 0} {
+			SetHashThreads(threads)
+			out := make([]byte, 48)
+			parallelHash256(out, m, blocklen, []byte("PQGo"))
+			if !bytes.Equal(out, ref) {
+				t.Fatalf("ParallelHash256 with B=%d and %d threads doesnt match", blocklen, threads)
+			}
+		}
+	}
+}
+
+func TestKeccakLanes(t *testing.T) {
+	best := Backend()
+	defer selectBackend(best)
+
+	for _, name := range []string{"ref", "opt", "avx2", "avx512"} {
+		if !selectBackend(name) {
+			continue
+		}
+
+		// every lane starts from its own state
+		states := make([][25]uint64, 8)
+		for j := range states {
+			for i := range states[j] {
+				states[j][i] = uint64(j+1)*0x9e3779b97f4a7c15 ^ uint64(i)<<32 ^ uint64(i)
+			}
+		}
+		for _, lanes := range []int{4, 8} {
+			ref := append([][25]uint64{}, states[:lanes]...)
+			got := append([][25]uint64{}, states[:lanes]...)
+			keccakPermute(ref, 1)
+			keccakPermute(got, lanes)
+			for j := range ref {
+				if ref[j] != got[j] {
+					t.Fatalf("%s: lane %d of the %d-way permutation doesnt match", name, j, lanes)
+				}
+			}
+		}
+
+		// lengths around the SHAKE256 (136) and SHAKE128 (168) rates
+		for _, inlen := range []int{0, 1, 135, 136, 137, 167, 168, 169, 500} {
+			for _, outlen := range []int{1, 136, 168, 337} {
+				for _, lanes := range []int{4, 8} {
+					for _, bits := range []int{128, 256} {
+						in := make([][]byte, lanes)
+						out := make([][]byte, lanes)
+						for j := range in {
+							in[j] = make([]byte, inlen)
+							rand.Read(in[j])
+							out[j] = make([]byte, outlen)
+						}
+						shakeLanes(bits, out, in)
+						for j := range in {
+							ref := make([]byte, outlen)
+							shake(bits, ref, in[j])
+							if !bytes.Equal(out[j], ref) {
+								t.Fatalf("%s: lane %d of shake%dx%d doesnt match shake%d (in %d, out %d)",
+									name, j, bits, lanes, bits, inlen, outlen)
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+func TestHashBatching(t *testing.T) {
+	k := Kyber{}
+	d := Dilithium{}
+
+	kpk, ksk, _ := k.KeyGenRandom()
+	ct, ss, _ := k.EncapRandom(kpk)
+	dpk, dsk, _ := d.KeyGenRandom()
+	m := make([]byte, 200)
+	sm, _ := d.Sign(m, dsk)
+
+	for _, lanes := range []int{4, 8} {
+		before := GetHashBatchStats()
+		if err := EnableHashBatching(lanes, time.Millisecond); err != nil {
+			t.Fatal(err)
+		}
+
+		var wg sync.WaitGroup
+		errs := make(chan string, 64)
+		for g := 0; g < 32; g++ {
+			wg.Add(1)
+			go func() {
+				defer wg.Done()
+				for i := 0; i < 10; i++ {
+					sss, err := k.Decap(ct, ksk)
+					if err != nil || !bytes.Equal(ss, sss) {
+						errs <- "shared secret does not match"
+						return
+					}
+					mm, err := d.Open(sm, dpk)
+					if err != nil || !bytes.Equal(m, mm) {
+						errs <- "opened message doesnt match signed message"
+						return
+					}
+				}
+			}()
+		}
+		wg.Wait()
+		DisableHashBatching()
+		close(errs)
+		for e := range errs {
+			t.Fatal(e)
+		}
+
+		after := GetHashBatchStats()
+		if after.Jobs-before.Jobs != 32*10*2 {
+			t.Fatalf("%d hashes went through the scheduler, expected %d", after.Jobs-before.Jobs, 32*10*2)
+		}
+		t.Logf("lanes %d: %d batches, occupancy %.2f", lanes, after.Batches-before.Batches, after.Occupancy())
+	}
+
+	if EnableHashBatching(3, time.Millisecond) == nil {
+		t.Fatal("invalid lane count accepted")
+	}
+}
+
+func TestDilithiumTreePrehash(t *testing.T) {
+	d := Dilithium{}
+	pk, sk, _ := d.KeyGenRandom()
+
+	// odd length so the last ParallelHash block is partial
+	m := make([]byte, 1<<20+123)
+	rand.Read(m)
+
+	for _, threads := range []int{1, 4, 0} {
+		SetHashThreads(threads)
+		sm, err := d.SignWithMode(m, sk, DilithiumTreePrehash)
+		if err != nil {
+			t.Fatal(err)
+		}
+		mm, err := d.OpenWithMode(sm, pk, DilithiumTreePrehash)
+		if err != nil {
+			t.Fatal(err)
+		}
+		if !bytes.Equal(m, mm) {
+			t.Fatal("opened message doesnt match signed message")
+		}
+		if _, err := d.Open(sm, pk); err == nil {
+			t.Fatal("tree prehash signature opened in pure mode")
+		}
+		sm[len(sm)-1] ^= 1
+		if _, err := d.OpenWithMode(sm, pk, DilithiumTreePrehash); err == nil {
+			t.Fatal("modified message accepted")
+		}
+	}
+	SetHashThreads(0)
+
+	for _, mode := range []DilithiumMode{DilithiumPure, DilithiumTreePrehash} {
+		sm, err := d.SignWithMode(nil, sk, mode)
+		if err != nil {
+			t.Fatal(err)
+		}
+		if mm, err := d.OpenWithMode(sm, pk, mode); err != nil || len(mm) != 0 {
+			t.Fatal("empty message doesnt open")
+		}
+	}
+
+	if _, err := d.SignWithMode(m, sk, DilithiumMode(2)); err == nil {
+		t.Fatal("invalid mode accepted")
+	}
+}
+
+func TestKyberParameterSets(t *testing.T) {
+	type kyberSetKEM interface {
+		KEM
+		EncapBatch(ents, pks, cts, sss []byte) error
+		DecapBatch(cts, sk, sss []byte) error
+		PreparePublicKey(pk []byte) (*PreparedPublicKey, error)
+		PrepareSecretKey(sk []byte) (*PreparedSecretKey, error)
+	}
+	const n = 5
+	ent := make([]byte, KyberEntropyLen)
+	var other []byte
+
+	for i, k := range []kyberSetKEM{Kyber512{}, Kyber768{}, Kyber1024{}} {
+		polys := i + 2
+		pk, sk, err := k.KeyGen(ent)
+		if err != nil {
+			t.Fatal(err)
+		}
+		if len(pk) != polys*352+32 || len(sk) != polys*416+len(pk)+64 {
+			t.Fatalf("k=%d: unexpected key sizes %d, %d", polys, len(pk), len(sk))
+		}
+		if bytes.Equal(pk[:64], other) {
+			t.Fatalf("k=%d: same key as the previous set", polys)
+		}
+		other = pk[:64]
+		testKEM(k, t)
+
+		// the prepared keys and the batches of the set match Encap and Decap
+		ppk, err := k.PreparePublicKey(pk)
+		if err != nil {
+			t.Fatal(err)
+		}
+		psk, err := k.PrepareSecretKey(sk)
+		if err != nil {
+			t.Fatal(err)
+		}
+		ct, ss, _ := k.Encap(ent, pk)
+		if len(ct) != polys*352+96 {
+			t.Fatalf("k=%d: unexpected ciphertext size %d", polys, len(ct))
+		}
+		if _, _, err := k.Encap(ent[1:], pk); err == nil {
+			t.Fatalf("k=%d: invalid entropy size accepted", polys)
+		}
+		if _, _, err := k.Encap(nil, pk); err == nil {
+			t.Fatalf("k=%d: empty entropy accepted", polys)
+		}
+		ct1, ss1, _ := ppk.Encap(ent)
+		ss2, _ := psk.Decap(ct)
+		if !bytes.Equal(ct, ct1) || !bytes.Equal(ss, ss1) || !bytes.Equal(ss, ss2) {
+			t.Fatalf("k=%d: prepared keys dont match", polys)
+		}
+
+		ents := bytes.Repeat(ent, n)
+		pks := bytes.Repeat(pk, n)
+		cts := make([]byte, n*len(ct))
+		sss := make([]byte, n*len(ss))
+		if err := k.EncapBatch(ents, pks, cts, sss); err != nil {
+			t.Fatal(err)
+		}
+		if !bytes.Equal(cts, bytes.Repeat(ct, n)) || !bytes.Equal(sss, bytes.Repeat(ss, n)) {
+			t.Fatalf("k=%d: EncapBatch doesnt match Encap", polys)
+		}
+		sss = make([]byte, n*len(ss))
+		if err := k.DecapBatch(cts, sk, sss); err != nil {
+			t.Fatal(err)
+		}
+		if !bytes.Equal(sss, bytes.Repeat(ss, n)) {
+			t.Fatalf("k=%d: DecapBatch doesnt match Decap", polys)
+		}
+	}
+
+	// keys of one set are rejected by the others
+	pk, sk, _ := Kyber512{}.KeyGen(ent)
+	if _, _, err := (Kyber1024{}).Encap(ent, pk); err == nil {
+		t.Fatal("Kyber512 public key accepted by Kyber1024")
+	}
+	if _, err := (Kyber{}).PrepareSecretKey(sk); err == nil {
+		t.Fatal("Kyber512 secret key accepted by Kyber768")
+	}
+
+	// the C layer refuses a set selector out of range
+	bad := *kyber512Set
+	bad.k = 5
+	if _, _, err := bad.keyGen(RNGShake256, ent); err == nil {
+		t.Fatal("invalid parameter set accepted")
+	}
+	if _, err := bad.decap(make([]byte, bad.ctLen), sk); err == nil {
+		t.Fatal("invalid parameter set accepted")
+	}
+}
+
+func TestKeyGenBulk(t *testing.T) {
+	type bulk struct {
+		name       string
+		alg        int
+		keyGen     func(ent []byte) ([]byte, []byte, error)
+		keyGenBulk func(seed []byte, first uint64, pks, sks []byte) error
+		entropyLen int
+	}
+	seed := make([]byte, BulkSeedLen)
+	rand.Read(seed)
+	const count, first = 13, 1000
+
+	for _, b := range []bulk{
+		{"dilithium", bulkDilithium, Dilithium{}.KeyGen, Dilithium{}.KeyGenBulk, DilithiumEntropyLen},
+		{"kyber", bulkKyber, Kyber{}.KeyGen, Kyber{}.KeyGenBulk, KyberEntropyLen},
+		{"kyber512", bulkKyber512, Kyber512{}.KeyGen, Kyber512{}.KeyGenBulk, KyberEntropyLen},
+		{"kyber1024", bulkKyber1024, Kyber1024{}.KeyGen, Kyber1024{}.KeyGenBulk, KyberEntropyLen},
+		{"round5", bulkRound5, Round5{}.KeyGen, Round5{}.KeyGenBulk, Round5EntropyLen},
+	} {
+		pk, sk, err := b.keyGen(make([]byte, b.entropyLen))
+		if err != nil {
+			t.Fatal(err)
+		}
+		pkLen, skLen := len(pk), len(sk)
+
+		// single-threaded reference: one KeyGen per key, no pool involved
+		refPks := make([]byte, count*pkLen)
+		refSks := make([]byte, count*skLen)
+		for i := 0; i < count; i++ {
+			pk, sk, err := b.keyGen(bulkEntropy(b.alg, seed, first+uint64(i), b.entropyLen))
+			if err != nil {
+				t.Fatal(err)
+			}
+			copy(refPks[i*pkLen:], pk)
+			copy(refSks[i*skLen:], sk)
+		}
+
+		// the pool only grows, so each size is checked against the
+		// reference rather than against the previous run
+		for _, threads := range []int{1, 4, 0} {
+			SetThreads(threads)
+			pks := make([]byte, count*pkLen)
+			sks := make([]byte, count*skLen)
+			if err := b.keyGenBulk(seed, first, pks, sks); err != nil {
+				t.Fatal(err)
+			}
+			for i := 0; i < count; i++ {
+				if !bytes.Equal(pks[i*pkLen:(i+1)*pkLen], refPks[i*pkLen:(i+1)*pkLen]) ||
+					!bytes.Equal(sks[i*skLen:(i+1)*skLen], refSks[i*skLen:(i+1)*skLen]) {
+					t.Fatalf("%s: bulk key %d doesnt match KeyGen with %d threads", b.name, i, threads)
+				}
+			}
+		}
+		SetThreads(0)
+
+		// a sub-range regenerates the same keys
+		pks := make([]byte, 2*pkLen)
+		sks := make([]byte, 2*skLen)
+		if err := b.keyGenBulk(seed, first+3, pks, sks); err != nil {
+			t.Fatal(err)
+		}
+		if !bytes.Equal(pks, refPks[3*pkLen:5*pkLen]) || !bytes.Equal(sks, refSks[3*skLen:5*skLen]) {
+			t.Fatalf("%s: bulk sub-range doesnt match", b.name)
+		}
+
+		if b.keyGenBulk(seed, 0, pks[1:], sks) == nil {
+			t.Fatalf("%s: invalid slab size accepted", b.name)
+		}
+		if b.keyGenBulk(seed[1:], 0, pks, sks) == nil {
+			t.Fatalf("%s: invalid seed size accepted", b.name)
+		}
+	}
+}
+
+func TestKyberPreparedPublicKey(t *testing.T) {
+	for _, k := range []Kyber{{}, {RNG: RNGCTRDRBG}} {
+		pk, sk, _ := k.KeyGenRandom()
+		ppk, err := k.PreparePublicKey(pk)
+		if err != nil {
+			t.Fatal(err)
+		}
+
+		ent := make([]byte, KyberEntropyLen)
+		for i := 0; i < 10; i++ {
+			rand.Read(ent)
+			ct, ss, err := k.Encap(ent, pk)
+			if err != nil {
+				t.Fatal(err)
+			}
+			pct, pss, err := ppk.Encap(ent)
+			if err != nil {
+				t.Fatal(err)
+			}
+			if !bytes.Equal(ct, pct) || !bytes.Equal(ss, pss) {
+				t.Fatal("prepared Encap doesnt match Encap")
+			}
+		}
+
+		ct, ss, _ := ppk.EncapRandom()
+		ss2, _ := k.Decap(ct, sk)
+		if !bytes.Equal(ss, ss2) {
+			t.Fatal("shared secrets dont match")
+		}
+	}
+
+	if _, err := (Kyber{}).PreparePublicKey(make([]byte, 10)); err == nil {
+		t.Fatal("invalid public key size accepted")
+	}
+}
+
+func TestKyberEncapBatch(t *testing.T) {
+	const n, keys = 19, 6
+	for _, k := range []Kyber{{}, {RNG: RNGCTRDRBG}} {
+		var pkList, skList [keys][]byte
+		for i := range pkList {
+			pkList[i], skList[i], _ = k.KeyGenRandom()
+		}
+		pkLen, ctLen, ssLen := len(pkList[0]), 0, 0
+
+		// groups of four share and mix keys; with more keys than the four
+		// slots of a batch, later groups evict slots, skipping the ones
+		// pinned by a hit earlier in the same group
+		pks := make([]byte, 0, n*pkLen)
+		order := []int{0, 0, 1, 2, 1, 1, 0, 2, 3, 4, 5, 0, 4, 1, 2, 3, 2, 5, 0}
+		for _, j := range order {
+			pks = append(pks, pkList[j]...)
+		}
+		ents := make([]byte, n*KyberEntropyLen)
+		rand.Read(ents)
+
+		var refCts, refSss []byte
+		for i := 0; i < n; i++ {
+			ct, ss, err := k.Encap(ents[i*KyberEntropyLen:(i+1)*KyberEntropyLen], pkList[order[i]])
+			if err != nil {
+				t.Fatal(err)
+			}
+			ctLen, ssLen = len(ct), len(ss)
+			refCts = append(refCts, ct...)
+			refSss = append(refSss, ss...)
+		}
+
+		cts := make([]byte, n*ctLen)
+		sss := make([]byte, n*ssLen)
+		if err := k.EncapBatch(ents, pks, cts, sss); err != nil {
+			t.Fatal(err)
+		}
+		if !bytes.Equal(cts, refCts) || !bytes.Equal(sss, refSss) {
+			t.Fatal("EncapBatch doesnt match Encap")
+		}
+
+		if err := k.EncapBatchRandom(pks, cts, sss); err != nil {
+			t.Fatal(err)
+		}
+		for i := 0; i < n; i++ {
+			ss, _ := k.Decap(cts[i*ctLen:(i+1)*ctLen], skList[order[i]])
+			if !bytes.Equal(ss, sss[i*ssLen:(i+1)*ssLen]) {
+				t.Fatal("shared secrets dont match")
+			}
+		}
+
+		if k.EncapBatch(ents[1:], pks, cts, sss) == nil ||
+			k.EncapBatch(ents, pks[pkLen:], cts, sss) == nil ||
+			k.EncapBatch(ents, pks, cts[1:], sss) == nil ||
+			k.EncapBatch(ents, pks, cts, sss[1:]) == nil ||
+			k.EncapBatch(nil, nil, nil, nil) == nil {
+			t.Fatal("invalid slab size accepted")
+		}
+	}
+}
+
+func TestKyberDecapBatch(t *testing.T) {
+	const n = 7
+	k := Kyber{}
+	pk, sk, _ := k.KeyGenRandom()
+	psk, _ := k.PrepareSecretKey(sk)
+
+	var cts, refSss []byte
+	for i := 0; i < n; i++ {
+		ct, _, _ := k.EncapRandom(pk)
+		if i == 2 || i == 5 {
+			ct[len(ct)-1] ^= 1 // rejected ciphertexts in both groups of four
+		}
+		ss, _ := k.Decap(ct, sk)
+		cts = append(cts, ct...)
+		refSss = append(refSss, ss...)
+	}
+	ssLen := len(refSss) / n
+
+	sss := make([]byte, n*ssLen)
+	if err := k.DecapBatch(cts, sk, sss); err != nil {
+		t.Fatal(err)
+	}
+	if !bytes.Equal(sss, refSss) {
+		t.Fatal("DecapBatch doesnt match Decap")
+	}
+	sss = make([]byte, n*ssLen)
+	if err := psk.DecapBatch(cts, sss); err != nil {
+		t.Fatal(err)
+	}
+	if !bytes.Equal(sss, refSss) {
+		t.Fatal("prepared DecapBatch doesnt match Decap")
+	}
+
+	if k.DecapBatch(cts, sk[1:], sss) == nil ||
+		k.DecapBatch(cts[1:], sk, sss) == nil ||
+		k.DecapBatch(cts, sk, sss[1:]) == nil ||
+		psk.DecapBatch(nil, nil) == nil {
+		t.Fatal("invalid slab size accepted")
+	}
+}
+
+func TestKyberPreparedSecretKey(t *testing.T) {
+	k := Kyber{}
+	pk, sk, _ := k.KeyGenRandom()
+	psk, err := k.PrepareSecretKey(sk)
+	if err != nil {
+		t.Fatal(err)
+	}
+
+	for i := 0; i < 10; i++ {
+		ct, ss, _ := k.EncapRandom(pk)
+		if i%2 == 1 {
+			ct[i] ^= 1 // implicit rejection must match too
+		}
+		ss1, err := k.Decap(ct, sk)
+		if err != nil {
+			t.Fatal(err)
+		}
+		ss2, err := psk.Decap(ct)
+		if err != nil {
+			t.Fatal(err)
+		}
+		if !bytes.Equal(ss1, ss2) {
+			t.Fatal("prepared Decap doesnt match Decap")
+		}
+		if bytes.Equal(ss, ss2) != (i%2 == 0) {
+			t.Fatal("unexpected shared secret")
+		}
+	}
+
+	if _, err := k.PrepareSecretKey(make([]byte, 10)); err == nil {
+		t.Fatal("invalid secret key size accepted")
+	}
+	if _, err := psk.Decap(make([]byte, 10)); err == nil {
+		t.Fatal("invalid ciphertext size accepted")
+	}
+}
+
+func TestKyberKex(t *testing.T) {
+	type kexKEM interface {
+		KEM
+		NewUAKEInitiator() *UAKEInitiator
+		NewUAKEResponder(skb []byte) (*UAKEResponder, error)
+		NewAKEInitiator(ska []byte) (*AKEInitiator, error)
+		NewAKEResponder(skb []byte) (*AKEResponder, error)
+	}
+	entA := make([]byte, KyberEntropyLen)
+	entB := make([]byte, KyberEntropyLen)
+	rand.Read(entA)
+	rand.Read(entB)
+
+	for _, k := range []kexKEM{Kyber512{}, Kyber{}, Kyber1024{}, Kyber{RNG: RNGCTRDRBG}} {
+		pka, ska, _ := k.KeyGenRandom()
+		pkb, skb, _ := k.KeyGenRandom()
+		keyA := make([]byte, KyberKexKeyLen)
+		keyB := make([]byte, KyberKexKeyLen)
+
+		ua := k.NewUAKEInitiator()
+		ub, err := k.NewUAKEResponder(skb)
+		if err != nil {
+			t.Fatal(err)
+		}
+		msgA := make([]byte, ua.MsgALen())
+		msgB := make([]byte, ua.MsgBLen())
+		for i := 0; i < 2; i++ { // the initiator can be reused
+			if err := ua.Start(entA, pkb, msgA); err != nil {
+				t.Fatal(err)
+			}
+			if err := ub.Respond(entB, msgA, msgB, keyB); err != nil {
+				t.Fatal(err)
+			}
+			if err := ua.Finish(msgB, keyA); err != nil {
+				t.Fatal(err)
+			}
+			if !bytes.Equal(keyA, keyB) {
+				t.Fatal("UAKE keys dont match")
+			}
+		}
+		// the ephemeral key of A is KeyGen on the same entropy
+		epk, _, _ := k.KeyGen(entA)
+		if !bytes.Equal(msgA[:len(epk)], epk) {
+			t.Fatal("UAKE ephemeral key doesnt match KeyGen")
+		}
+		if ua.Finish(msgB, keyA) == nil {
+			t.Fatal("Finish accepted without Start")
+		}
+
+		aa, err := k.NewAKEInitiator(ska)
+		if err != nil {
+			t.Fatal(err)
+		}
+		ab, err := k.NewAKEResponder(skb)
+		if err != nil {
+			t.Fatal(err)
+		}
+		msgB = make([]byte, aa.MsgBLen())
+		if err := aa.Start(entA, pkb, msgA); err != nil {
+			t.Fatal(err)
+		}
+		if err := ab.Respond(entB, msgA, pka, msgB, keyB); err != nil {
+			t.Fatal(err)
+		}
+		if err := aa.Finish(msgB, keyA); err != nil {
+			t.Fatal(err)
+		}
+		if !bytes.Equal(keyA, keyB) {
+			t.Fatal("AKE keys dont match")
+		}
+
+		// B answering for another static key of A gives another key
+		pkc, _, _ := k.KeyGenRandom()
+		if err := aa.Start(entA, pkb, msgA); err != nil {
+			t.Fatal(err)
+		}
+		if err := ab.Respond(entB, msgA, pkc, msgB, keyB); err != nil {
+			t.Fatal(err)
+		}
+		if err := aa.Finish(msgB, keyA); err != nil {
+			t.Fatal(err)
+		}
+		if bytes.Equal(keyA, keyB) {
+			t.Fatal("AKE keys match with the wrong static key")
+		}
+
+		if ua.Start(entA, pka[1:], msgA) == nil ||
+			ua.Start(entA, pkb, msgA[1:]) == nil ||
+			ab.Respond(entB, msgA, pka, msgB[1:], keyB) == nil ||
+			ab.Respond(entB, msgA, pka, msgB, keyB[1:]) == nil {
+			t.Fatal("invalid size accepted")
+		}
+		if _, err := k.NewAKEInitiator(ska[1:]); err == nil {
+			t.Fatal("invalid secret key size accepted")
+		}
+	}
+}
+
+func BenchmarkKyberUAKE(b *testing.B) {
+	k := Kyber{}
+	pkb, skb, _ := k.KeyGenRandom()
+	ua := k.NewUAKEInitiator()
+	ub, _ := k.NewUAKEResponder(skb)
+	ent := make([]byte, KyberEntropyLen)
+	msgA := make([]byte, ua.MsgALen())
+	msgB := make([]byte, ua.MsgBLen())
+	key := make([]byte, KyberKexKeyLen)
+	b.ResetTimer()
+	for n := 0; n < b.N; n++ {
+		if err := ua.Start(ent, pkb, msgA); err != nil {
+			b.Fatalf(err.Error())
+		}
+		if err := ub.Respond(ent, msgA, msgB, key); err != nil {
+			b.Fatalf(err.Error())
+		}
+		if err := ua.Finish(msgB, key); err != nil {
+			b.Fatalf(err.Error())
+		}
+	}
+	mg = key
+}
+
+func testKEMConcurrent(k KEM, entropyLen int, t *testing.T) {
+	const n = 16
+	ents := make([][]byte, n)
+	pks := make([][]byte, n)
+	cts := make([][]byte, n)
+	for i := range ents {
+		ents[i] = make([]byte, entropyLen)
+		rand.Read(ents[i])
+		pks[i], _, _ = k.KeyGen(ents[i])
+		cts[i], _, _ = k.Encap(ents[i], pks[i])
+	}
+
+	// every call seeds its own RNG context, so results must not depend
+	// on what runs concurrently
+	var wg sync.WaitGroup
+	errs := make(chan string, n)
+	for g := 0; g < n; g++ {
+		wg.Add(1)
+		go func(g int) {
+			defer wg.Done()
+			for r := 0; r < 20; r++ {
+				i := (g + r) % n
+				pk, _, _ := k.KeyGen(ents[i])
+				ct, _, _ := k.Encap(ents[i], pks[i])
+				if !bytes.Equal(pk, pks[i]) || !bytes.Equal(ct, cts[i]) {
+					errs <- "concurrent calls gave different results"
+					return
+				}
+			}
+		}(g)
+	}
+	wg.Wait()
+	close(errs)
+	for e := range errs {
+		t.Fatal(e)
+	}
+}
+
+func TestKEMConcurrent(t *testing.T) {
+	testKEMConcurrent(Kyber{}, KyberEntropyLen, t)
+	testKEMConcurrent(Round5{}, Round5EntropyLen, t)
+}
+
+func TestEntropy(t *testing.T) {
+	const n = 8
+	seen := make(map[string]bool)
+	var mu sync.Mutex
+	var wg sync.WaitGroup
+	for g := 0; g < n; g++ {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			for i := 0; i < 1000; i++ {
+				ent := string(entropy(KyberEntropyLen))
+				mu.Lock()
+				if seen[ent] {
+					t.Error("entropy handed out twice")
+				}
+				seen[ent] = true
+				mu.Unlock()
+			}
+		}()
+	}
+	wg.Wait()
+}
+
+func TestEntropyFork(t *testing.T) {
+	if forkMarker == nil {
+		t.Skip("MADV_WIPEONFORK not available")
+	}
+	const n = 8
+
+	// shards filled before the fork, then a fork simulated by clearing
+	// the marker as the kernel does in the child
+	shards := make([]*entropyShard, n)
+	for i := range shards {
+		shards[i] = new(entropyShard)
+		shards[i].refill()
+	}
+	gen := atomic.LoadUint64(&entropyGen)
+	atomic.StoreUint32(forkMarker, 0)
+
+	// every goroutine must see its shard as stale, whichever one handles
+	// the fork
+	var stale int32
+	var wg sync.WaitGroup
+	for _, s := range shards {
+		wg.Add(1)
+		go func(s *entropyShard) {
+			defer wg.Done()
+			if s.forked() {
+				atomic.AddInt32(&stale, 1)
+			}
+		}(s)
+	}
+	wg.Wait()
+
+	if stale != n {
+		t.Fatalf("%d of %d parent shards reused after fork", n-stale, n)
+	}
+	if atomic.LoadUint64(&entropyGen) != gen+1 || atomic.LoadUint32(forkMarker) != forkLive {
+		t.Fatal("fork not handled exactly once")
+	}
+	for _, s := range shards {
+		if !s.forked() {
+			t.Fatal("parent shard reused after fork")
+		}
+		s.refill()
+		if s.forked() {
+			t.Fatal("refilled shard seen as stale")
+		}
+	}
+}
+
+func BenchmarkEntropy(b *testing.B) {
+	for n := 0; n < b.N; n++ {
+		mg = entropy(KyberEntropyLen)
+	}
+}
+
+func BenchmarkEntropyRead(b *testing.B) {
+	for n := 0; n < b.N; n++ {
+		ent := make([]byte, KyberEntropyLen)
+		if _, err := rand.Read(ent); err != nil {
+			b.Fatalf(err.Error())
+		}
+		mg = ent
+	}
+}